@@ -0,0 +1,1725 @@
+/*****************************************************************//**
+ * \file   armazem.c
+ * \brief  Armazém colunar de antenas partilhado pela lista de antenas e pelo grafo.
+ *
+ * As antenas ficam em colunas contíguas (freq, x, y) indexadas por slot,
+ * com uma tabela de dispersão coordenada -> slot para detetar duplicados e
+ * procurar antenas em O(1). O grafo é um índice sobre o armazém e apenas as
+ * adjacências são guardadas.
+ *
+ * As coordenadas usam CoordAntena (16 bits por omissão) e cada slot tem ainda
+ * um byte de geração, pelo que cada antena ocupa 6 bytes nas colunas. Os slots
+ * removidos formam uma lista de livres, encadeada através das próprias colunas
+ * x/y, e são reutilizados nas inserções.
+ *
+ * O ID de um vértice junta o slot e a geração do slot
+ * ((geracao << VERTICE_BITS_SLOT) | (slot + 1)); sem reutilizações é slot + 1.
+ * Libertar um slot incrementa a geração, pelo que um ID antigo deixa de ser
+ * aceite (RemoverVerticeArmazem e as procuras devolvem erro) em vez de
+ * designar a antena que reutilizou o slot. Um slot libertado VERTICE_GERACOES
+ * vezes é retirado da lista de livres, e os grafos só aceitam armazéns com
+ * até VERTICE_MAX_SLOTS slots.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#define TABELA_VAZIA -1
+#define TABELA_REMOVIDA -2
+
+#pragma region Tabela de dispersão
+/**
+ * \brief Calcula a dispersão de uma coordenada.
+ */
+static uint32_t DispersaoCoordenada(int x, int y) {
+    uint64_t h = ((uint64_t)(uint32_t)y << 32) | (uint32_t)x;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+/**
+ * \brief Reconstrói a tabela de dispersão com um novo tamanho.
+ *
+ * \return true se a tabela foi reconstruída, false se faltar memória.
+ */
+static bool ReconstruirTabela(ArmazemAntenas* a, int novoTam) {
+    int* tabela = (int*)malloc(novoTam * sizeof(int));
+    if (tabela == NULL) {
+        return false;
+    }
+    ESTAT_SOMAR(alocacoes, 1);
+    for (int i = 0; i < novoTam; i++) tabela[i] = TABELA_VAZIA;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        uint32_t h = DispersaoCoordenada(a->x[s], a->y[s]) & (novoTam - 1);
+        while (tabela[h] != TABELA_VAZIA) h = (h + 1) & (novoTam - 1);
+        tabela[h] = s;
+    }
+    free(a->tabela);
+    a->tabela = tabela;
+    a->tamTabela = novoTam;
+    a->ocupadosTabela = a->numAntenas;
+    return true;
+}
+
+/**
+ * \brief Garante que as colunas e a tabela têm espaço para mais extra antenas.
+ *
+ * \return true se há espaço, false se faltar memória.
+ */
+static bool GarantirEspaco(ArmazemAntenas* a, int extra) {
+    if (a->numSlots + extra > a->capacidade) {
+        int novaCap = a->capacidade < 16 ? 16 : a->capacidade * 2;
+        if (novaCap < a->numSlots + extra) novaCap = a->numSlots + extra;
+        char* f = (char*)realloc(a->freq, novaCap);
+        if (f == NULL) return false;
+        a->freq = f;
+        CoordAntena* nx = (CoordAntena*)realloc(a->x, novaCap * sizeof(CoordAntena));
+        if (nx == NULL) return false;
+        a->x = nx;
+        CoordAntena* ny = (CoordAntena*)realloc(a->y, novaCap * sizeof(CoordAntena));
+        if (ny == NULL) return false;
+        a->y = ny;
+        uint8_t* ng = (uint8_t*)realloc(a->geracao, novaCap);
+        if (ng == NULL) return false;
+        a->geracao = ng;
+        a->capacidade = novaCap;
+        ESTAT_SOMAR(alocacoes, 4);
+    }
+    if ((a->ocupadosTabela + extra) * 2 > a->tamTabela) { // Mantém a ocupação abaixo de 50%
+        int novoTam = a->tamTabela < 16 ? 16 : a->tamTabela;
+        while ((a->numAntenas + extra) * 2 > novoTam / 2) novoTam *= 2;
+        return ReconstruirTabela(a, novoTam);
+    }
+    return true;
+}
+
+/**
+ * \brief Lê o slot seguinte na lista de livres, guardado nas colunas x/y de um slot livre.
+ */
+static int ProximoLivre(const ArmazemAntenas* a, int s) {
+#if COORD_ANTENA_MAX == 65535
+    return (int)((uint32_t)a->x[s] | ((uint32_t)a->y[s] << 16)) - 1;
+#else
+    return (int)a->x[s] - 1;
+#endif
+}
+
+/**
+ * \brief Coloca um slot no início da lista de livres e avança a sua geração.
+ *
+ * Um slot que esgotou as gerações fica livre mas fora da lista, para que
+ * nenhum ID antigo volte a ser válido.
+ */
+static void LibertarSlot(ArmazemAntenas* a, int s) {
+    a->freq[s] = '\0';
+    if (++a->geracao[s] >= VERTICE_GERACOES) {
+        return;
+    }
+    uint32_t prox = (uint32_t)(a->livre + 1); // 0 representa o fim da lista
+#if COORD_ANTENA_MAX == 65535
+    a->x[s] = (CoordAntena)(prox & 0xFFFF);
+    a->y[s] = (CoordAntena)(prox >> 16);
+#else
+    a->x[s] = (CoordAntena)prox;
+#endif
+    a->livre = s;
+    a->numLivres++;
+}
+
+/**
+ * \brief Obtém um slot para uma nova antena, reutilizando os livres primeiro.
+ *
+ * O espaço nas colunas deve ter sido garantido antes (GarantirEspaco).
+ */
+static int ObterSlot(ArmazemAntenas* a) {
+    if (a->livre >= 0) {
+        int s = a->livre;
+        a->livre = ProximoLivre(a, s);
+        a->numLivres--;
+        return s;
+    }
+    a->geracao[a->numSlots] = 0;
+    return a->numSlots++;
+}
+
+/**
+ * \brief Coloca um slot já preenchido na tabela de dispersão.
+ */
+static void IndexarSlot(ArmazemAntenas* a, int s) {
+    uint32_t h = DispersaoCoordenada(a->x[s], a->y[s]) & (a->tamTabela - 1);
+    while (a->tabela[h] >= 0) h = (h + 1) & (a->tamTabela - 1);
+    if (a->tabela[h] == TABELA_VAZIA) a->ocupadosTabela++;
+    a->tabela[h] = s;
+}
+
+/**
+ * \brief Dá um id denso ao rótulo de uma frequência na sua primeira inserção.
+ *
+ * Os ids seguem a ordem de aparecimento e não são reutilizados quando a última
+ * antena da frequência é removida, pelo que os baldes e as camadas indexados
+ * por id se mantêm válidos.
+ */
+static void InternarFrequencia(ArmazemAntenas* a, char freq) {
+    unsigned char f = (unsigned char)freq;
+    if (a->idDaFreq[f] == 0) {
+        a->freqDoId[a->numFreqs] = freq;
+        a->idDaFreq[f] = (uint8_t)++a->numFreqs;
+    }
+}
+#pragma endregion
+
+#pragma region Armazém
+/**
+ * \brief Cria um armazém de antenas vazio.
+ *
+ * \param largura Largura do grid.
+ * \param altura Altura do grid.
+ * \return Ponteiro para o armazém criado ou NULL se faltar memória.
+ */
+ArmazemAntenas* CriarArmazem(int largura, int altura) {
+    if (largura <= 0 || altura <= 0 || largura - 1 > COORD_ANTENA_MAX || altura - 1 > COORD_ANTENA_MAX) {
+        return NULL; // As coordenadas não cabem em CoordAntena
+    }
+    ArmazemAntenas* a = (ArmazemAntenas*)calloc(1, sizeof(ArmazemAntenas));
+    if (a != NULL) {
+        a->largura = largura;
+        a->altura = altura;
+        a->livre = -1;
+    }
+    return a;
+}
+
+/**
+ * \brief Devolve o id denso de uma frequência no armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param freq Frequência.
+ * \return Id (0..NumeroFrequencias - 1) ou -1 se a frequência nunca foi inserida.
+ */
+int IdFrequencia(const ArmazemAntenas* a, char freq) {
+    return a != NULL ? ID_FREQ(a, freq) : -1;
+}
+
+/**
+ * \brief Devolve o número de frequências internadas no armazém (ids 0..n-1).
+ */
+int NumeroFrequencias(const ArmazemAntenas* a) {
+    return a != NULL ? a->numFreqs : 0;
+}
+
+/**
+ * \brief Procura a antena numa coordenada.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param x Coordenada x.
+ * \param y Coordenada y.
+ * \return Slot da antena ou -1 se não existir.
+ */
+int ProcurarAntenaArmazem(const ArmazemAntenas* a, int x, int y) {
+    if (a == NULL || a->tamTabela == 0) {
+        return -1;
+    }
+    uint32_t h = DispersaoCoordenada(x, y) & (a->tamTabela - 1);
+    while (a->tabela[h] != TABELA_VAZIA) {
+        int s = a->tabela[h];
+        if (s >= 0 && a->x[s] == x && a->y[s] == y) {
+            return s;
+        }
+        h = (h + 1) & (a->tamTabela - 1);
+    }
+    return -1;
+}
+
+/**
+ * \brief Insere uma antena no armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param freq Frequência da antena.
+ * \param x Coordenada x da antena.
+ * \param y Coordenada y da antena.
+ * \return Slot da nova antena, ARMAZEM_FORA_GRID, ARMAZEM_DUPLICADA ou ARMAZEM_SEM_MEMORIA.
+ */
+int InserirAntenaArmazem(ArmazemAntenas* a, char freq, int x, int y) {
+    if (a == NULL) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    if (x < 0 || x >= a->largura || y < 0 || y >= a->altura || freq == '\0') {
+        return ARMAZEM_FORA_GRID;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    if (ProcurarAntenaArmazem(a, x, y) >= 0) {
+        return ARMAZEM_DUPLICADA;
+    }
+    if (!GarantirEspaco(a, 1)) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    int s = ObterSlot(a);
+    InternarFrequencia(a, freq);
+    a->freq[s] = freq;
+    a->x[s] = (CoordAntena)x;
+    a->y[s] = (CoordAntena)y;
+    a->numAntenas++;
+    a->versao++;
+    IndexarSlot(a, s);
+    InserirNoBalde(a, s);
+    RegioesAntenaInserida(a, s);
+    return s;
+}
+
+/**
+ * \brief Ordena índices por chave (radix LSD estável, dígitos de 11 bits).
+ *
+ * Só são feitas as passagens necessárias para os bits usados pelas chaves.
+ */
+static bool OrdenarPorChave(uint64_t* chaves, int* idx, int n, uint64_t chaveMax) {
+    uint64_t* chavesAux = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    int* idxAux = (int*)malloc((n + 1) * sizeof(int));
+    if (chavesAux == NULL || idxAux == NULL) {
+        free(chavesAux);
+        free(idxAux);
+        return false;
+    }
+    for (int desloc = 0; desloc < 64 && (chaveMax >> desloc) != 0; desloc += 11) {
+        int contagem[2049] = { 0 };
+        for (int i = 0; i < n; i++) contagem[((chaves[i] >> desloc) & 2047) + 1]++;
+        for (int d = 0; d < 2048; d++) contagem[d + 1] += contagem[d];
+        for (int i = 0; i < n; i++) {
+            int pos = contagem[(chaves[i] >> desloc) & 2047]++;
+            chavesAux[pos] = chaves[i];
+            idxAux[pos] = idx[i];
+        }
+        memcpy(chaves, chavesAux, n * sizeof(uint64_t));
+        memcpy(idx, idxAux, n * sizeof(int));
+    }
+    free(chavesAux);
+    free(idxAux);
+    return true;
+}
+
+/**
+ * \brief Insere várias antenas de uma só vez.
+ *
+ * As entradas são validadas, ordenadas pela coordenada compactada (y * largura + x)
+ * e deduplicadas (fica a primeira ocorrência); as aceites são acrescentadas ao
+ * armazém por essa ordem com uma única reserva de memória.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param freq Frequências das antenas.
+ * \param x Coordenadas x das antenas.
+ * \param y Coordenadas y das antenas.
+ * \param n Número de antenas.
+ * \param estado Vetor opcional (pode ser NULL) que recebe, por entrada, 0 se foi
+ *               inserida ou o código ARMAZEM_* que levou à rejeição.
+ * \return Número de antenas inseridas ou ARMAZEM_SEM_MEMORIA.
+ */
+int InserirAntenasEmLote(ArmazemAntenas* a, const char* freq, const int* x, const int* y, int n, signed char* estado) {
+    if (a == NULL || n < 0) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    uint64_t* chaves = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    int* idx = (int*)malloc((n + 1) * sizeof(int));
+    signed char* est = estado != NULL ? estado : (signed char*)malloc(n + 1);
+    if (chaves == NULL || idx == NULL || est == NULL) {
+        free(chaves);
+        free(idx);
+        if (est != estado) free(est);
+        return ARMAZEM_SEM_MEMORIA;
+    }
+
+    // Validação sem saltos (o compilador consegue vetorizar este ciclo)
+    unsigned largura = (unsigned)a->largura;
+    unsigned altura = (unsigned)a->altura;
+    for (int i = 0; i < n; i++) {
+        int valida = ((unsigned)x[i] < largura) & ((unsigned)y[i] < altura) & (freq[i] != '\0');
+        est[i] = (signed char)(valida ? 0 : ARMAZEM_FORA_GRID);
+    }
+    int numValidas = 0;
+    for (int i = 0; i < n; i++) {
+        if (est[i] != 0) continue;
+        chaves[numValidas] = (uint64_t)y[i] * largura + (uint64_t)x[i];
+        idx[numValidas] = i;
+        numValidas++;
+    }
+    if (!OrdenarPorChave(chaves, idx, numValidas, (uint64_t)largura * altura)) {
+        free(chaves);
+        free(idx);
+        if (est != estado) free(est);
+        return ARMAZEM_SEM_MEMORIA;
+    }
+
+    // Deduplicação: dentro do lote (chaves adjacentes) e contra o armazém
+    int aceites = 0;
+    for (int k = 0; k < numValidas; k++) {
+        int i = idx[k];
+        if (k > 0 && chaves[k] == chaves[k - 1]) {
+            est[i] = ARMAZEM_DUPLICADA;
+        }
+        else if (ProcurarAntenaArmazem(a, x[i], y[i]) >= 0) {
+            est[i] = ARMAZEM_DUPLICADA;
+        }
+        else {
+            idx[aceites++] = i;
+        }
+    }
+
+    if (!GarantirEspaco(a, aceites)) {
+        for (int k = 0; k < aceites; k++) est[idx[k]] = ARMAZEM_SEM_MEMORIA;
+        free(chaves);
+        free(idx);
+        if (est != estado) free(est);
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    for (int k = 0; k < aceites; k++) { // Acrescenta as antenas aceites, por ordem de coordenada
+        int i = idx[k];
+        int s = ObterSlot(a);
+        InternarFrequencia(a, freq[i]);
+        a->freq[s] = freq[i];
+        a->x[s] = (CoordAntena)x[i];
+        a->y[s] = (CoordAntena)y[i];
+        IndexarSlot(a, s);
+        if (aceites <= 64) {
+            InserirNoBalde(a, s);
+            RegioesAntenaInserida(a, s);
+        }
+    }
+    a->numAntenas += aceites;
+    if (aceites > 0) a->versao++;
+    if (aceites > 64 && a->ordemMorton) {
+        ReconstruirBaldes(a); // Mais barato do que deslocar os baldes entrada a entrada
+    }
+    if (aceites > 64) {
+        ReconstruirIndiceRegioes(a);
+    }
+
+    free(chaves);
+    free(idx);
+    if (est != estado) free(est);
+    return aceites;
+}
+
+/**
+ * \brief Remove a antena de um slot. O slot passa para a lista de livres.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da antena.
+ * \return true se a antena foi removida, false se o slot não tinha antena.
+ */
+bool RemoverAntenaArmazem(ArmazemAntenas* a, int slot) {
+    if (a == NULL || slot < 0 || slot >= a->numSlots || a->freq[slot] == '\0') {
+        return false;
+    }
+    uint32_t h = DispersaoCoordenada(a->x[slot], a->y[slot]) & (a->tamTabela - 1);
+    while (a->tabela[h] != slot) h = (h + 1) & (a->tamTabela - 1);
+    a->tabela[h] = TABELA_REMOVIDA;
+    ESTAT_SOMAR(operacoes, 1);
+    RegioesAntenaRemovida(a, slot);
+    RemoverDoBalde(a, slot);
+    LibertarSlot(a, slot);
+    a->numAntenas--;
+    a->versao++;
+    return true;
+}
+
+/**
+ * \brief Constrói o grid de símbolos com as antenas (as posições vazias ficam com '.').
+ *
+ * \return Vetor largura * altura alocado ou NULL se faltar memória.
+ */
+static char* ConstruirGrid(const ArmazemAntenas* a) {
+    size_t tam = (size_t)a->largura * a->altura;
+    char* grid = (char*)malloc(tam + 1);
+    if (grid == NULL) {
+        return NULL;
+    }
+    memset(grid, '.', tam);
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') grid[(size_t)a->y[s] * a->largura + a->x[s]] = a->freq[s];
+    }
+    return grid;
+}
+
+/**
+ * \brief Escreve o grid linha a linha, no formato dos ficheiros de texto.
+ */
+static void EscreverGrid(FILE* destino, const char* grid, int largura, int altura) {
+    char* linha = (char*)malloc((size_t)largura * 2 + 2);
+    if (linha == NULL) {
+        return;
+    }
+    for (int i = 0; i < altura; i++) {
+        for (int j = 0; j < largura; j++) {
+            linha[2 * j] = grid[(size_t)i * largura + j];
+            linha[2 * j + 1] = ' ';
+        }
+        linha[2 * largura] = '\n';
+        linha[2 * largura + 1] = '\0';
+        fputs(linha, destino);
+    }
+    free(linha);
+}
+
+/**
+ * \brief Lista as antenas do armazém e os efeitos nefastos no modo indicado.
+ *
+ * Os efeitos vêm da cache do armazém (EfeitosEmCache), pelo que listar de
+ * novo um armazém sem alterações não recalcula nada. Com MOTOR_BITBOARD o
+ * grid é escrito a partir das bitboards (ListarBitboard).
+ *
+ * \param a Ponteiro para o armazém.
+ * \param modo EFEITOS_PONTOS ou EFEITOS_HARMONICOS.
+ * \return true se o grid foi mostrado, false caso contrário.
+ */
+bool ListarAntenasArmazemModo(ArmazemAntenas* a, int modo) {
+    if (a == NULL) {
+        return false;
+    }
+    const ConjuntoEfeitos* c = EfeitosEmCache(a, modo);
+#if MOTOR_BITBOARD
+    MotorBitboard* m = c != NULL ? CriarMotorBitboard(a) : NULL;
+    bool listado = m != NULL && ListarBitboard(m, c);
+    DestruirMotorBitboard(m);
+    if (listado) {
+        return true;
+    }
+#endif
+    char* grid = c != NULL ? ConstruirGrid(a) : NULL;
+    if (grid == NULL) {
+        return false;
+    }
+    for (int y = 0; y < a->altura; y++) {
+        for (int x = 0; x < a->largura; x++) {
+            char* celula = &grid[(size_t)y * a->largura + x];
+            if (*celula == '.' && TemEfeito(c, x, y)) *celula = '#'; // As antenas sobrepõem-se aos efeitos
+        }
+    }
+    EscreverGrid(stdout, grid, a->largura, a->altura);
+    free(grid);
+    return true;
+}
+
+/**
+ * \brief Indica se algum bit de um retângulo do conjunto de efeitos está ativo.
+ */
+static bool BlocoComEfeito(const ConjuntoEfeitos* c, int x0, int y0, int x1, int y1) {
+    int p0 = x0 / 64, p1 = x1 / 64;
+    uint64_t mascara0 = ~0ull << (x0 % 64);
+    uint64_t mascara1 = ~0ull >> (63 - x1 % 64);
+    for (int y = y0; y <= y1; y++) {
+        const uint64_t* linha = c->bits + (size_t)y * c->palavrasLinha;
+        for (int p = p0; p <= p1; p++) {
+            uint64_t m = ~0ull;
+            if (p == p0) m &= mascara0;
+            if (p == p1) m &= mascara1;
+            if (linha[p] & m) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Mostra uma janela do grid, opcionalmente reduzida.
+ *
+ * Cada carácter cobre fator x fator células a partir de (x0, y0). Só são
+ * consultadas as antenas da janela (ConsultarRetangulo, com a ordem de Morton
+ * ativa) e os efeitos dos blocos sem antenas: pelo índice de regiões, se
+ * estiver ativo e o modo for EFEITOS_PONTOS, ou pela cache de efeitos.
+ *
+ * Com fator 1 o formato é o de ListarAntenasArmazemModo. Com fator > 1 um
+ * bloco com uma antena mostra a sua frequência, um bloco com várias mostra
+ * um símbolo de JANELA_DENSIDADE (2-3, 4-7, 8-15, ... antenas), um bloco só
+ * com efeitos mostra '#' e um bloco vazio '.'.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param destino Ficheiro onde a janela é escrita.
+ * \param x0 Coordenada x do canto superior esquerdo.
+ * \param y0 Coordenada y do canto superior esquerdo.
+ * \param largura Largura da janela em caracteres.
+ * \param altura Altura da janela em caracteres.
+ * \param fator Células por carácter em cada direção (1 para não reduzir).
+ * \param modo EFEITOS_PONTOS ou EFEITOS_HARMONICOS.
+ * \return true se a janela foi mostrada, false caso contrário.
+ */
+bool MostrarJanelaArmazem(ArmazemAntenas* a, FILE* destino, int x0, int y0, int largura, int altura, int fator, int modo) {
+    if (a == NULL || destino == NULL || largura <= 0 || altura <= 0) {
+        return false;
+    }
+    if (fator < 1) fator = 1;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x0 >= a->largura || y0 >= a->altura) {
+        return false;
+    }
+    // A janela é cortada no limite do grid
+    long long fimX = (long long)x0 + (long long)largura * fator - 1;
+    long long fimY = (long long)y0 + (long long)altura * fator - 1;
+    int x1 = fimX < a->largura ? (int)fimX : a->largura - 1;
+    int y1 = fimY < a->altura ? (int)fimY : a->altura - 1;
+    largura = (x1 - x0) / fator + 1;
+    altura = (y1 - y0) / fator + 1;
+    bool usarIndice = a->regioes != NULL && modo != EFEITOS_HARMONICOS;
+    const ConjuntoEfeitos* c = usarIndice ? NULL : EfeitosEmCache(a, modo);
+    size_t numBlocos = (size_t)largura * altura;
+    char* grid = (char*)malloc(numBlocos + 1);
+    int* contagem = (int*)calloc(numBlocos, sizeof(int));
+    int n = ConsultarRetangulo(a, x0, y0, x1, y1, NULL, 0);
+    int* slots = n > 0 ? (int*)malloc((size_t)n * sizeof(int)) : NULL;
+    if ((!usarIndice && c == NULL) || grid == NULL || contagem == NULL || (n > 0 && slots == NULL)) {
+        free(grid);
+        free(contagem);
+        free(slots);
+        return false;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    memset(grid, '.', numBlocos);
+
+    // Antenas da janela: pelos baldes de Morton ou, sem eles, percorrendo os slots
+    if (n >= 0) {
+        n = ConsultarRetangulo(a, x0, y0, x1, y1, slots, n);
+    }
+    int limite = n >= 0 ? n : a->numSlots;
+    for (int i = 0; i < limite; i++) {
+        int s = n >= 0 ? slots[i] : i;
+        if (a->freq[s] == '\0' || a->x[s] < x0 || a->x[s] > x1 || a->y[s] < y0 || a->y[s] > y1) continue;
+        size_t b = (size_t)((a->y[s] - y0) / fator) * largura + (a->x[s] - x0) / fator;
+        contagem[b]++;
+        grid[b] = a->freq[s];
+    }
+
+    // Símbolos: frequência, densidade ou efeito (as antenas sobrepõem-se aos efeitos)
+    static const char densidade[] = JANELA_DENSIDADE;
+    for (int by = 0; by < altura; by++) {
+        for (int bx = 0; bx < largura; bx++) {
+            size_t b = (size_t)by * largura + bx;
+            if (contagem[b] > 1) {
+                int nivel = 0;
+                for (int k = contagem[b] >> 2; k > 0 && nivel < (int)sizeof(densidade) - 2; k >>= 1) nivel++;
+                grid[b] = densidade[nivel];
+                continue;
+            }
+            if (contagem[b] == 1) continue;
+            int cx0 = x0 + bx * fator, cy0 = y0 + by * fator;
+            int cx1 = cx0 + fator - 1 < x1 ? cx0 + fator - 1 : x1;
+            int cy1 = cy0 + fator - 1 < y1 ? cy0 + fator - 1 : y1;
+            bool efeito;
+            if (usarIndice) efeito = fator == 1 ? CelulaComEfeito(a, cx0, cy0) : ContarEfeitosRegiao(a, cx0, cy0, cx1, cy1) > 0;
+            else efeito = BlocoComEfeito(c, cx0, cy0, cx1, cy1);
+            if (efeito) grid[b] = '#';
+        }
+    }
+    EscreverGrid(destino, grid, largura, altura);
+    free(grid);
+    free(contagem);
+    free(slots);
+    return true;
+}
+
+/**
+ * \brief Salva as antenas do armazém em um ficheiro de texto.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param nomeFicheiro Nome do ficheiro onde as antenas serão salvas.
+ * \return true se o salvamento foi bem-sucedido, false caso contrário.
+ */
+bool SalvarArmazemEmTxt(const ArmazemAntenas* a, const char* nomeFicheiro) {
+    if (a == NULL) {
+        return false;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    char* grid = ConstruirGrid(a);
+    FILE* ficheiro = grid != NULL ? fopen(nomeFicheiro, "w") : NULL;
+    if (ficheiro == NULL) {
+        free(grid);
+        return false;
+    }
+    EscreverGrid(ficheiro, grid, a->largura, a->altura);
+    ESTAT_FICHEIRO(ficheiro);
+    fclose(ficheiro);
+    free(grid);
+    ESTAT_FIM(nsSalvar, inicio);
+    return true;
+}
+
+/**
+ * \brief Cor de uma frequência nas imagens: tons espaçados pela razão áurea.
+ */
+static void CorFrequencia(char freq, uint8_t* rgb) {
+    uint32_t h = ((unsigned char)freq * 40503u & 0xFFFFu) * 6u; // 40503 / 65536 = 0.618...
+    int setor = (int)(h >> 16);
+    double f = (h & 0xFFFFu) / 65536.0;
+    double v = 0.95, p = v * 0.25, q = v * (1.0 - 0.75 * f), t = v * (1.0 - 0.75 * (1.0 - f));
+    double r, g, b;
+    switch (setor) {
+    case 0: r = v; g = t; b = p; break;
+    case 1: r = q; g = v; b = p; break;
+    case 2: r = p; g = v; b = t; break;
+    case 3: r = p; g = q; b = v; break;
+    case 4: r = t; g = p; b = v; break;
+    default: r = v; g = p; b = q; break;
+    }
+    rgb[0] = (uint8_t)(r * 255);
+    rgb[1] = (uint8_t)(g * 255);
+    rgb[2] = (uint8_t)(b * 255);
+}
+
+/**
+ * \brief Exporta as antenas e os efeitos para uma imagem PGM ou PPM binária.
+ *
+ * A imagem é escrita linha a linha: as antenas são lidas por faixas de linhas
+ * dos baldes de Morton (ConsultarRetangulo) e os efeitos do conjunto em cache,
+ * pelo que além do conjunto de efeitos só é usada memória para uma linha da
+ * imagem e para as antenas de uma faixa. Cada pixel cobre fator x fator
+ * células; um pixel com antenas tem a cor da frequência de uma delas (PPM) ou
+ * branco (PGM), um pixel só com efeitos é destacado e os restantes são pretos.
+ *
+ * \param a Ponteiro para o armazém (a ordem de Morton é ativada se preciso).
+ * \param nomeFicheiro Nome do ficheiro da imagem.
+ * \param formato IMAGEM_PGM ou IMAGEM_PPM.
+ * \param fator Células por pixel em cada direção (1 para não reduzir).
+ * \param modo EFEITOS_PONTOS ou EFEITOS_HARMONICOS.
+ * \return true se a imagem foi escrita, false caso contrário.
+ */
+bool ExportarImagemArmazem(ArmazemAntenas* a, const char* nomeFicheiro, int formato, int fator, int modo) {
+    if (a == NULL || (formato != IMAGEM_PGM && formato != IMAGEM_PPM)) {
+        return false;
+    }
+    if (fator < 1) fator = 1;
+    if (!a->ordemMorton && !AtivarOrdemMorton(a)) {
+        return false;
+    }
+    const ConjuntoEfeitos* c = EfeitosEmCache(a, modo);
+    if (c == NULL) {
+        return false;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    int largura = (a->largura + fator - 1) / fator;
+    int altura = (a->altura + fator - 1) / fator;
+    int canais = formato == IMAGEM_PPM ? 3 : 1;
+    int linhasFaixa = IMAGEM_FAIXA / fator > 0 ? IMAGEM_FAIXA / fator : 1; // Linhas da imagem por faixa
+    uint8_t* linha = (uint8_t*)malloc((size_t)largura * canais);
+    int* inicioLinha = (int*)malloc(((size_t)linhasFaixa + 1) * sizeof(int));
+    int* slots = NULL;
+    int* ordenados = NULL;
+    int capacidade = 0;
+    FILE* ficheiro = linha != NULL && inicioLinha != NULL ? fopen(nomeFicheiro, "wb") : NULL;
+    if (ficheiro == NULL) {
+        free(linha);
+        free(inicioLinha);
+        return false;
+    }
+    fprintf(ficheiro, "P%d\n%d %d\n255\n", formato == IMAGEM_PPM ? 6 : 5, largura, altura);
+    uint8_t cores[FREQ_IDS][3]; // Cor de cada id (a cor depende só do rótulo)
+    for (int f = 0; f < a->numFreqs; f++) CorFrequencia(a->freqDoId[f], cores[f]);
+    static const uint8_t corEfeito[3] = { 255, 255, 255 };
+    bool ok = true;
+    for (int faixa = 0; ok && faixa < altura; faixa += linhasFaixa) {
+        // Antenas da faixa, ordenadas pela linha da imagem (contagem)
+        int fimFaixa = faixa + linhasFaixa < altura ? faixa + linhasFaixa : altura;
+        int y0 = faixa * fator;
+        int y1 = fimFaixa * fator - 1 < a->altura ? fimFaixa * fator - 1 : a->altura - 1;
+        int n = ConsultarRetangulo(a, 0, y0, a->largura - 1, y1, NULL, 0);
+        if (n > capacidade) {
+            free(slots);
+            free(ordenados);
+            capacidade = n;
+            slots = (int*)malloc((size_t)n * sizeof(int));
+            ordenados = (int*)malloc((size_t)n * sizeof(int));
+            if (slots == NULL || ordenados == NULL) {
+                ok = false;
+                break;
+            }
+        }
+        n = ConsultarRetangulo(a, 0, y0, a->largura - 1, y1, slots, n);
+        memset(inicioLinha, 0, ((size_t)linhasFaixa + 1) * sizeof(int));
+        for (int i = 0; i < n; i++) inicioLinha[(a->y[slots[i]] - y0) / fator + 1]++;
+        for (int r = 0; r < linhasFaixa; r++) inicioLinha[r + 1] += inicioLinha[r];
+        for (int i = 0; i < n; i++) ordenados[inicioLinha[(a->y[slots[i]] - y0) / fator]++] = slots[i];
+        for (int r = linhasFaixa; r > 0; r--) inicioLinha[r] = inicioLinha[r - 1];
+        inicioLinha[0] = 0;
+
+        for (int r = faixa; ok && r < fimFaixa; r++) {
+            // Efeitos primeiro: as antenas sobrepõem-se
+            int cy0 = r * fator;
+            int cy1 = cy0 + fator - 1 < a->altura ? cy0 + fator - 1 : a->altura - 1;
+            memset(linha, 0, (size_t)largura * canais);
+            for (int px = 0; px < largura; px++) {
+                int cx0 = px * fator;
+                int cx1 = cx0 + fator - 1 < a->largura ? cx0 + fator - 1 : a->largura - 1;
+                if (fator == 1 ? !TemEfeito(c, cx0, cy0) : !BlocoComEfeito(c, cx0, cy0, cx1, cy1)) continue;
+                if (canais == 3) memcpy(linha + 3 * (size_t)px, corEfeito, 3);
+                else linha[px] = 96;
+            }
+            for (int i = inicioLinha[r - faixa]; i < inicioLinha[r - faixa + 1]; i++) {
+                int s = ordenados[i];
+                int px = a->x[s] / fator;
+                if (canais == 3) memcpy(linha + 3 * (size_t)px, cores[ID_FREQ(a, a->freq[s])], 3);
+                else linha[px] = 255;
+            }
+            ok = fwrite(linha, (size_t)canais, (size_t)largura, ficheiro) == (size_t)largura;
+        }
+    }
+    ESTAT_FICHEIRO(ficheiro);
+    ok = fclose(ficheiro) == 0 && ok;
+    free(linha);
+    free(inicioLinha);
+    free(slots);
+    free(ordenados);
+    ESTAT_FIM(nsSalvar, inicio);
+    return ok;
+}
+
+/**
+ * \brief Salva as antenas do armazém em um ficheiro binário (formato de antenas.bin).
+ *
+ * \param a Ponteiro para o armazém.
+ * \param nomeFicheiro Nome do ficheiro onde as antenas serão salvas.
+ * \return true se o salvamento foi bem-sucedido, false caso contrário.
+ */
+bool SalvarArmazemEmBin(const ArmazemAntenas* a, const char* nomeFicheiro) {
+    if (a == NULL) {
+        return false;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    size_t tamRegisto = sizeof(char) + 2 * sizeof(int);
+    char* buf = (char*)malloc((size_t)a->numAntenas * tamRegisto + 1);
+    if (buf == NULL) {
+        return false;
+    }
+    size_t tam = 0;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        int x = a->x[s];
+        int y = a->y[s];
+        buf[tam] = a->freq[s];
+        memcpy(buf + tam + 1, &x, sizeof(int));
+        memcpy(buf + tam + 1 + sizeof(int), &y, sizeof(int));
+        tam += tamRegisto;
+    }
+    FILE* ficheiro = fopen(nomeFicheiro, "wb");
+    if (ficheiro == NULL) {
+        free(buf);
+        return false;
+    }
+    bool ok = fwrite(buf, 1, tam, ficheiro) == tam;
+    ESTAT_FICHEIRO(ficheiro);
+    fclose(ficheiro);
+    free(buf);
+    ESTAT_FIM(nsSalvar, inicio);
+    return ok;
+}
+
+/**
+ * \brief Salva as antenas do armazém num snapshot comprimido.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param nomeFicheiro Nome do ficheiro onde as antenas serão salvas.
+ * \return true se o salvamento foi bem-sucedido, false caso contrário.
+ */
+bool SalvarArmazemComprimido(const ArmazemAntenas* a, const char* nomeFicheiro) {
+    if (a == NULL) {
+        return false;
+    }
+    return SalvarColunasComprimidas(nomeFicheiro, a->freq, a->x, a->y, a->numSlots);
+}
+
+/**
+ * \brief Salva o armazém nos três formatos com o prefixo indicado (prefixo.bin, .txt e .zbin).
+ *
+ * \param a Ponteiro para o armazém.
+ * \param prefixo Caminho dos ficheiros sem a extensão (por exemplo "antenas").
+ * \return true se os três ficheiros foram gravados, false caso contrário.
+ */
+bool SalvarArmazemComPrefixo(const ArmazemAntenas* a, const char* prefixo) {
+    char nome[512];
+    snprintf(nome, sizeof(nome), "%s.bin", prefixo);
+    bool ok = SalvarArmazemEmBin(a, nome);
+    snprintf(nome, sizeof(nome), "%s.txt", prefixo);
+    ok = SalvarArmazemEmTxt(a, nome) && ok;
+    snprintf(nome, sizeof(nome), "%s.zbin", prefixo);
+    return SalvarArmazemComprimido(a, nome) && ok;
+}
+
+/**
+ * \brief Cria um armazém com as antenas de um lote.
+ *
+ * \param lote Ponteiro para o lote (pode ser NULL).
+ * \return Ponteiro para o armazém ou NULL se o lote for NULL ou faltar memória.
+ */
+ArmazemAntenas* CriarArmazemDeLote(LoteAntenas* lote) {
+    if (lote == NULL) {
+        return NULL;
+    }
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    if (a != NULL && InserirAntenasEmLote(a, lote->freq, lote->x, lote->y, lote->numAntenas, NULL) < 0) {
+        DestruirArmazem(a);
+        return NULL;
+    }
+    return a;
+}
+
+/**
+ * \brief Carrega as antenas de um ficheiro de texto para um armazém.
+ *
+ * \param nomeFicheiro Nome do ficheiro de texto a ser carregado.
+ * \return Ponteiro para o armazém ou NULL se ocorrer um erro.
+ */
+ArmazemAntenas* CarregarArmazemDeTxt(const char* nomeFicheiro) {
+    LoteAntenas* lote = CarregarLoteParalelo(nomeFicheiro, false, 0);
+    ArmazemAntenas* a = CriarArmazemDeLote(lote);
+    DestruirLote(lote);
+    return a;
+}
+
+/**
+ * \brief Carrega as antenas de um ficheiro binário para um armazém.
+ *
+ * \param nomeFicheiro Nome do ficheiro binário a ser carregado.
+ * \return Ponteiro para o armazém ou NULL se ocorrer um erro.
+ */
+ArmazemAntenas* CarregarArmazemDeBin(const char* nomeFicheiro) {
+    LoteAntenas* lote = CarregarLoteParalelo(nomeFicheiro, true, 0);
+    ArmazemAntenas* a = CriarArmazemDeLote(lote);
+    DestruirLote(lote);
+    return a;
+}
+
+/**
+ * \brief Carrega as antenas de um snapshot comprimido para um armazém.
+ *
+ * \param nomeFicheiro Nome do ficheiro a ser carregado.
+ * \return Ponteiro para o armazém ou NULL se ocorrer um erro.
+ */
+ArmazemAntenas* CarregarArmazemComprimido(const char* nomeFicheiro) {
+    LoteAntenas* lote = CarregarLoteComprimido(nomeFicheiro);
+    ArmazemAntenas* a = CriarArmazemDeLote(lote);
+    DestruirLote(lote);
+    return a;
+}
+
+/**
+ * \brief Calcula a memória ocupada pelo armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return Número de bytes alocados (colunas, tabela e a própria estrutura).
+ */
+size_t MemoriaArmazem(const ArmazemAntenas* a) {
+    if (a == NULL) {
+        return 0;
+    }
+    return sizeof(ArmazemAntenas) + (size_t)a->capacidade * (sizeof(char) + 2 * sizeof(CoordAntena) + sizeof(uint8_t)) +
+        (size_t)a->tamTabela * sizeof(int);
+}
+
+/**
+ * \brief Copia as colunas e a tabela de dispersão de um armazém.
+ *
+ * A cópia não tem baldes de Morton, índice de regiões nem efeitos em cache:
+ * serve as consultas que só leem as colunas (efeitos, procuras no grafo,
+ * ProcurarAntenaArmazem), como nas versões publicadas para leitores concorrentes.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return Ponteiro para a cópia ou NULL se faltar memória.
+ */
+ArmazemAntenas* CopiarArmazem(const ArmazemAntenas* a) {
+    if (a == NULL) {
+        return NULL;
+    }
+    ArmazemAntenas* c = CriarArmazem(a->largura, a->altura);
+    if (c == NULL) {
+        return NULL;
+    }
+    int cap = a->numSlots > 0 ? a->numSlots : 1;
+    int tamTabela = a->tamTabela > 0 ? a->tamTabela : 1;
+    c->freq = (char*)malloc(cap);
+    c->x = (CoordAntena*)malloc(cap * sizeof(CoordAntena));
+    c->y = (CoordAntena*)malloc(cap * sizeof(CoordAntena));
+    c->geracao = (uint8_t*)malloc(cap);
+    c->tabela = (int*)malloc(tamTabela * sizeof(int));
+    if (c->freq == NULL || c->x == NULL || c->y == NULL || c->geracao == NULL || c->tabela == NULL) {
+        DestruirArmazem(c);
+        return NULL;
+    }
+    ESTAT_SOMAR(alocacoes, 6);
+    if (a->numSlots > 0) {
+        memcpy(c->freq, a->freq, a->numSlots);
+        memcpy(c->x, a->x, a->numSlots * sizeof(CoordAntena));
+        memcpy(c->y, a->y, a->numSlots * sizeof(CoordAntena));
+        memcpy(c->geracao, a->geracao, a->numSlots);
+    }
+    if (a->tamTabela > 0) {
+        memcpy(c->tabela, a->tabela, a->tamTabela * sizeof(int));
+    }
+    c->numAntenas = a->numAntenas;
+    c->numSlots = a->numSlots;
+    c->capacidade = cap;
+    c->livre = a->livre;
+    c->numLivres = a->numLivres;
+    c->tamTabela = a->tamTabela;
+    c->ocupadosTabela = a->ocupadosTabela;
+    c->numFreqs = a->numFreqs;
+    memcpy(c->freqDoId, a->freqDoId, sizeof(c->freqDoId));
+    memcpy(c->idDaFreq, a->idDaFreq, sizeof(c->idDaFreq));
+    c->versao = a->versao;
+    return c;
+}
+
+/**
+ * \brief Destrói o armazém, liberando a memória alocada.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return true se o armazém foi destruído, false se era NULL.
+ */
+bool DestruirArmazem(ArmazemAntenas* a) {
+    if (a == NULL) {
+        return false;
+    }
+    free(a->freq);
+    free(a->x);
+    free(a->y);
+    free(a->geracao);
+    free(a->tabela);
+    DestruirBaldes(a);
+    DestruirIndiceRegioes(a);
+    LimparCacheEfeitos(a);
+    free(a);
+    return true;
+}
+#pragma endregion
+
+#pragma region Grafo sobre o armazém
+/**
+ * \brief Devolve o ID do vértice que corresponde a um slot ocupado do armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da antena.
+ * \return ID do vértice (válido até o slot ser libertado).
+ */
+int IdVertice(const ArmazemAntenas* a, int slot) {
+    return ((int)a->geracao[slot] << VERTICE_BITS_SLOT) | (slot + 1);
+}
+
+/**
+ * \brief Devolve o slot designado por um ID de vértice.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param id ID do vértice.
+ * \return Slot da antena ou -1 se o ID for inválido ou antigo (o slot foi libertado depois).
+ */
+int SlotDoVertice(const ArmazemAntenas* a, int id) {
+    if (a == NULL || id <= 0) {
+        return -1;
+    }
+    int s = (id & VERTICE_MAX_SLOTS) - 1;
+    if (s < 0 || s >= a->numSlots || a->freq[s] == '\0' || a->geracao[s] != (id >> VERTICE_BITS_SLOT)) {
+        return -1;
+    }
+    return s;
+}
+
+/**
+ * \brief Garante que o vetor de adjacências cobre todos os slots do armazém.
+ *
+ * \return true se há espaço, false se faltar memória ou se o armazém tiver
+ * mais slots do que os IDs dos vértices conseguem representar.
+ */
+static bool GarantirAdjacencias(GR* g) {
+    if (g->armazem->numSlots > VERTICE_MAX_SLOTS) {
+        return false;
+    }
+    int necessario = g->armazem->capacidade;
+    if (necessario <= g->capacidadeAdj) {
+        return true;
+    }
+    Aresta** adj = (Aresta**)realloc(g->adjacentes, necessario * sizeof(Aresta*));
+    if (adj == NULL) {
+        return false;
+    }
+    memset(adj + g->capacidadeAdj, 0, (size_t)(necessario - g->capacidadeAdj) * sizeof(Aresta*));
+    g->adjacentes = adj;
+    if (g->anteriorFreq != NULL) {
+        int* ant = (int*)realloc(g->anteriorFreq, necessario * sizeof(int));
+        if (ant == NULL) {
+            return false;
+        }
+        g->anteriorFreq = ant;
+        int* seg = (int*)realloc(g->seguinteFreq, necessario * sizeof(int));
+        if (seg == NULL) {
+            return false;
+        }
+        g->seguinteFreq = seg;
+    }
+    g->capacidadeAdj = necessario;
+    return true;
+}
+
+/**
+ * \brief Acrescenta um slot ao fim da cadeia da sua frequência (ordem de inserção).
+ *
+ * \return Slot inserido antes com a mesma frequência ou -1 se não houver.
+ */
+static int EncadearFreq(GR* g, int s) {
+    int f = ID_FREQ(g->armazem, g->armazem->freq[s]);
+    int anterior = g->ultimoFreq[f];
+    g->anteriorFreq[s] = anterior;
+    g->seguinteFreq[s] = -1;
+    if (anterior >= 0) g->seguinteFreq[anterior] = s;
+    g->ultimoFreq[f] = s;
+    return anterior;
+}
+
+/**
+ * \brief Retira um slot da cadeia da sua frequência.
+ */
+static void DesencadearFreq(GR* g, int s) {
+    int anterior = g->anteriorFreq[s];
+    int seguinte = g->seguinteFreq[s];
+    if (anterior >= 0) g->seguinteFreq[anterior] = seguinte;
+    if (seguinte >= 0) g->anteriorFreq[seguinte] = anterior;
+    else g->ultimoFreq[ID_FREQ(g->armazem, g->armazem->freq[s])] = anterior;
+}
+
+/**
+ * \brief Liga dois slots nos dois sentidos.
+ */
+static void LigarSlots(GR* g, int s1, int s2) {
+    Aresta* a1 = CriarAresta(s2 + 1);
+    if (a1 != NULL) {
+        a1->prox = g->adjacentes[s1];
+        g->adjacentes[s1] = a1;
+    }
+    Aresta* a2 = CriarAresta(s1 + 1);
+    if (a2 != NULL) {
+        a2->prox = g->adjacentes[s2];
+        g->adjacentes[s2] = a2;
+    }
+}
+
+/**
+ * \brief Liga o slot s às antenas da mesma frequência a distância <= g->raio.
+ *
+ * Os vizinhos vêm da consulta de retângulo sobre os baldes de Morton (ou de uma
+ * passagem pelo armazém, se a ordem não estiver ativa). Para não duplicar
+ * arestas, só são ligados os vizinhos q < s e os vizinhos antigos
+ * (q < numAntigos e antigo[q], ou todos os q < numAntigos se antigo for NULL).
+ *
+ * \return true se as ligações foram criadas, false se faltar memória.
+ */
+static bool LigarVizinhosRaio(GR* g, int s, const bool* antigo, int numAntigos) {
+    const ArmazemAntenas* a = g->armazem;
+    int r = g->raio;
+    int xs = a->x[s], ys = a->y[s];
+    int* vizinhos = NULL;
+    int n = 0;
+    if (a->ordemMorton) {
+        n = ConsultarRetanguloFreq(a, a->freq[s], xs - r, ys - r, xs + r, ys + r, NULL, 0);
+        vizinhos = (int*)malloc((n + 1) * sizeof(int));
+        if (vizinhos == NULL) {
+            return false;
+        }
+        n = ConsultarRetanguloFreq(a, a->freq[s], xs - r, ys - r, xs + r, ys + r, vizinhos, n);
+    }
+    else {
+        vizinhos = (int*)malloc((a->numSlots + 1) * sizeof(int));
+        if (vizinhos == NULL) {
+            return false;
+        }
+        for (int q = 0; q < a->numSlots; q++) {
+            if (a->freq[q] == a->freq[s]) vizinhos[n++] = q;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        int q = vizinhos[i];
+        if (q == s || !(q < s || (q < numAntigos && (antigo == NULL || antigo[q])))) continue;
+        long long dx = a->x[q] - xs, dy = a->y[q] - ys;
+        if (dx * dx + dy * dy <= (long long)r * r) LigarSlots(g, s, q);
+    }
+    free(vizinhos);
+    return true;
+}
+
+/**
+ * \brief Cria um grafo como índice sobre um armazém de antenas.
+ *
+ * Cada antena é ligada à antena anterior (por slot) com a mesma frequência,
+ * o mesmo resultado de inserir os vértices um a um. Essa ordem inicia as
+ * cadeias por frequência que as inserções seguintes usam para ligar cada
+ * vértice ao último inserido em O(1).
+ *
+ * \param a Ponteiro para o armazém (não passa a pertencer ao grafo).
+ * \return Ponteiro para o grafo criado ou NULL se faltar memória.
+ */
+GR* CriarGrafoSobreArmazem(ArmazemAntenas* a) {
+    GR* g = CriarGrafo();
+    if (g == NULL || a == NULL) {
+        return g;
+    }
+    g->armazem = a;
+    g->anteriorFreq = (int*)malloc(sizeof(int));
+    g->seguinteFreq = (int*)malloc(sizeof(int));
+    if (g->anteriorFreq == NULL || g->seguinteFreq == NULL || !GarantirAdjacencias(g)) {
+        DestruirGrafo(g);
+        return NULL;
+    }
+    for (int f = 0; f < FREQ_IDS; f++) g->ultimoFreq[f] = -1;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        int anterior = EncadearFreq(g, s);
+        if (anterior >= 0) LigarSlots(g, s, anterior);
+    }
+    g->numVertices = a->numAntenas;
+    return g;
+}
+
+/**
+ * \brief Copia um grafo sobre o armazém para um grafo sobre a cópia do armazém.
+ *
+ * As listas de adjacência mantêm a ordem, pelo que as procuras na cópia
+ * visitam os vértices pela mesma ordem que no original.
+ *
+ * \param g Ponteiro para o grafo (sobre o armazém original).
+ * \param copia Cópia do armazém (CopiarArmazem), que passa a ser o armazém do novo grafo.
+ * \return Ponteiro para o novo grafo ou NULL se faltar memória.
+ */
+GR* CopiarGrafoArmazem(const GR* g, ArmazemAntenas* copia) {
+    if (g == NULL || g->armazem == NULL || copia == NULL) {
+        return NULL;
+    }
+    GR* c = CriarGrafo();
+    if (c == NULL) {
+        return NULL;
+    }
+    c->armazem = copia;
+    if (g->anteriorFreq != NULL) {
+        c->anteriorFreq = (int*)malloc(sizeof(int));
+        c->seguinteFreq = (int*)malloc(sizeof(int));
+        if (c->anteriorFreq == NULL || c->seguinteFreq == NULL) {
+            DestruirGrafo(c);
+            return NULL;
+        }
+        memcpy(c->ultimoFreq, g->ultimoFreq, sizeof(c->ultimoFreq));
+    }
+    if (!GarantirAdjacencias(c)) {
+        DestruirGrafo(c);
+        return NULL;
+    }
+    int limite = g->capacidadeAdj < copia->numSlots ? g->capacidadeAdj : copia->numSlots;
+    if (g->anteriorFreq != NULL && limite > 0) {
+        memcpy(c->anteriorFreq, g->anteriorFreq, limite * sizeof(int));
+        memcpy(c->seguinteFreq, g->seguinteFreq, limite * sizeof(int));
+    }
+    for (int s = 0; s < limite; s++) {
+        Aresta** fim = &c->adjacentes[s];
+        for (Aresta* a = g->adjacentes[s]; a != NULL; a = a->prox) {
+            Aresta* nova = CriarAresta(a->destino);
+            if (nova == NULL) {
+                DestruirGrafo(c);
+                return NULL;
+            }
+            *fim = nova;
+            fim = &nova->prox;
+        }
+    }
+    c->numVertices = g->numVertices;
+    c->raio = g->raio;
+    c->interferencia = g->interferencia;
+    c->versao = g->versao;
+    return c;
+}
+
+/**
+ * \brief Insere um vértice (e a respetiva antena no armazém) e cria a ligação automática.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param freq Frequência da antena.
+ * \param x Coordenada x da antena.
+ * \param y Coordenada y da antena.
+ * \return ID do novo vértice ou um código de erro ARMAZEM_* (negativo).
+ */
+int InserirVerticeArmazem(GR* g, char freq, int x, int y) {
+    if (g == NULL || g->armazem == NULL) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    int s = InserirAntenaArmazem(g->armazem, freq, x, y);
+    if (s < 0) {
+        return s;
+    }
+    if (!GarantirAdjacencias(g)) {
+        RemoverAntenaArmazem(g->armazem, s);
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    g->versao++;
+    if (g->interferencia) {
+        LigarInterferencias(g, s);
+        g->numVertices++;
+        return IdVertice(g->armazem, s);
+    }
+    if (g->raio > 0) {
+        LigarVizinhosRaio(g, s, NULL, g->armazem->numSlots);
+        g->numVertices++;
+        return IdVertice(g->armazem, s);
+    }
+    // Liga ao último vértice inserido com a mesma frequência
+    int anterior = EncadearFreq(g, s);
+    if (anterior >= 0) LigarSlots(g, s, anterior);
+    g->numVertices++;
+    return IdVertice(g->armazem, s);
+}
+
+/**
+ * \brief Cria um grafo sobre o armazém em que as arestas ligam antenas da mesma
+ * frequência a distância (euclidiana) menor ou igual a raio.
+ *
+ * Ativa a ordem de Morton do armazém e usa os baldes como índice espacial:
+ * cada antena só é comparada com as do quadrado de lado 2 * raio + 1 à sua
+ * volta, em O(V * vizinhos) em vez de O(V^2). As inserções seguintes no grafo
+ * (InserirVerticeArmazem) seguem a mesma regra.
+ *
+ * \param a Ponteiro para o armazém (não passa a pertencer ao grafo).
+ * \param raio Distância máxima entre vértices ligados (> 0).
+ * \return Ponteiro para o grafo criado ou NULL em caso de erro.
+ */
+GR* CriarGrafoRaio(ArmazemAntenas* a, int raio) {
+    if (a == NULL || raio <= 0) {
+        return NULL;
+    }
+    GR* g = CriarGrafo();
+    if (g == NULL) {
+        return NULL;
+    }
+    g->armazem = a;
+    g->raio = raio;
+    if (!GarantirAdjacencias(g) || (!a->ordemMorton && !AtivarOrdemMorton(a))) {
+        DestruirGrafo(g);
+        return NULL;
+    }
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0' && !LigarVizinhosRaio(g, s, NULL, 0)) {
+            DestruirGrafo(g);
+            return NULL;
+        }
+    }
+    g->numVertices = a->numAntenas;
+    return g;
+}
+
+/**
+ * \brief Remove as arestas de um slot que apontam para o destino indicado (slot + 1).
+ */
+static void RemoverArestasPara(GR* g, int slot, int id) {
+    Aresta* a = g->adjacentes[slot];
+    Aresta* ant = NULL;
+    while (a != NULL) {
+        if (a->destino == id) {
+            Aresta* temp = a;
+            a = a->prox;
+            if (ant != NULL) ant->prox = a;
+            else g->adjacentes[slot] = a;
+            free(temp);
+        }
+        else {
+            ant = a;
+            a = a->prox;
+        }
+    }
+}
+
+/**
+ * \brief Remove um vértice, as suas arestas e a antena correspondente do armazém.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param id ID do vértice a remover.
+ * \return true se o vértice foi removido, false caso contrário.
+ */
+bool RemoverVerticeArmazem(GR* g, int id) {
+    if (g == NULL || g->armazem == NULL) {
+        return false;
+    }
+    int s = SlotDoVertice(g->armazem, id);
+    if (s < 0) {
+        return false;
+    }
+    if (g->interferencia) {
+        DesligarInterferencias(g, s);
+    }
+    Aresta* a = g->adjacentes[s];
+    while (a != NULL) {
+        RemoverArestasPara(g, a->destino - 1, s + 1);
+        Aresta* temp = a;
+        a = a->prox;
+        free(temp);
+    }
+    g->adjacentes[s] = NULL;
+    if (g->anteriorFreq != NULL) {
+        DesencadearFreq(g, s);
+    }
+    RemoverAntenaArmazem(g->armazem, s);
+    g->numVertices--;
+    g->versao++;
+    return true;
+}
+
+/**
+ * \brief Mostra os vértices de um grafo sobre o armazém.
+ *
+ * \param g Ponteiro para o grafo.
+ */
+void MostrarVerticesArmazem(GR* g) {
+    ArmazemAntenas* arm = g->armazem;
+    if (arm->numAntenas == 0) {
+        printf("Grafo vazio.\n");
+        return;
+    }
+    for (int s = 0; s < arm->numSlots; s++) {
+        if (arm->freq[s] == '\0') continue;
+        printf("Vertice %d (Antena %c em [%d,%d]) -> Adjacentes:", IdVertice(arm, s), arm->freq[s], arm->x[s], arm->y[s]);
+        for (Aresta* a = g->adjacentes[s]; a != NULL; a = a->prox) {
+            printf(" %d", IdVertice(arm, a->destino - 1));
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * \brief Indica se o slot tem uma antena (e portanto um vértice).
+ */
+static bool SlotOcupado(const GR* g, int s) {
+    return s >= 0 && s < g->armazem->numSlots && g->armazem->freq[s] != '\0';
+}
+
+/**
+ * \brief Percorre em profundidade um grafo sobre o armazém, sem escrever no ecrã.
+ *
+ * Usa uma pilha explícita que guarda a próxima aresta de cada vértice,
+ * visitando os vértices pela mesma ordem que DFS_Recursivo.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param idOrigem ID do vértice de origem.
+ * \param ordem Recebe os IDs pela ordem da visita (espaço para numSlots do armazém).
+ * \return Número de vértices visitados ou -1 se a origem não existir ou faltar memória.
+ */
+int PercorrerProfundidadeArmazem(const GR* g, int idOrigem, int* ordem) {
+    const ArmazemAntenas* arm = g->armazem;
+    int origem = SlotDoVertice(arm, idOrigem);
+    if (origem < 0) {
+        return -1;
+    }
+    bool* visitado = (bool*)calloc(arm->numSlots + 1, sizeof(bool));
+    Aresta** pilha = (Aresta**)malloc((arm->numSlots + 1) * sizeof(Aresta*));
+    if (visitado == NULL || pilha == NULL) {
+        free(visitado);
+        free(pilha);
+        return -1;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_SOMAR(procurasGrafo, 1);
+    ESTAT_INICIO(inicio);
+    int n = 0;
+    int topo = 0;
+    visitado[origem] = true;
+    ordem[n++] = idOrigem;
+    pilha[topo++] = g->adjacentes[origem];
+    ESTAT_SOMAR(verticesVisitados, 1);
+    while (topo > 0) {
+        Aresta* a = pilha[topo - 1];
+        if (a == NULL) {
+            topo--;
+            continue;
+        }
+        pilha[topo - 1] = a->prox;
+        int d = a->destino - 1;
+        if (SlotOcupado(g, d) && !visitado[d]) {
+            visitado[d] = true;
+            ordem[n++] = IdVertice(arm, d);
+            pilha[topo++] = g->adjacentes[d];
+            ESTAT_SOMAR(verticesVisitados, 1);
+            ESTAT_MAXIMO(fronteiraMaxDFS, topo);
+        }
+    }
+    free(pilha);
+    free(visitado);
+    ESTAT_FIM(nsProcuras, inicio);
+    return n;
+}
+
+/**
+ * \brief Percorre em largura um grafo sobre o armazém, sem escrever no ecrã.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param idOrigem ID do vértice de origem.
+ * \param ordem Recebe os IDs pela ordem da visita (espaço para numSlots do armazém).
+ * \return Número de vértices visitados ou -1 se a origem não existir ou faltar memória.
+ */
+int PercorrerLarguraArmazem(const GR* g, int idOrigem, int* ordem) {
+    const ArmazemAntenas* arm = g->armazem;
+    int origem = SlotDoVertice(arm, idOrigem);
+    if (origem < 0) {
+        return -1;
+    }
+    bool* visitado = (bool*)calloc(arm->numSlots + 1, sizeof(bool));
+    if (visitado == NULL) {
+        return -1;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_SOMAR(procurasGrafo, 1);
+    ESTAT_INICIO(inicioTempo);
+    // A própria ordem de visita serve de fila (com slots, convertidos em IDs no fim)
+    int inicio = 0;
+    int fim = 0;
+    ordem[fim++] = origem;
+    visitado[origem] = true;
+    while (inicio < fim) {
+        int atual = ordem[inicio++];
+        ESTAT_SOMAR(verticesVisitados, 1);
+        for (Aresta* a = g->adjacentes[atual]; a != NULL; a = a->prox) {
+            int d = a->destino - 1;
+            if (SlotOcupado(g, d) && !visitado[d]) {
+                ordem[fim++] = d;
+                visitado[d] = true;
+                ESTAT_MAXIMO(fronteiraMaxBFS, fim - inicio);
+            }
+        }
+    }
+    for (int i = 0; i < fim; i++) ordem[i] = IdVertice(arm, ordem[i]);
+    free(visitado);
+    ESTAT_FIM(nsProcuras, inicioTempo);
+    return fim;
+}
+
+/**
+ * \brief Mostra os vértices visitados por uma procura a partir de uma origem.
+ */
+static void MostrarProcuraArmazem(GR* g, int idOrigem, bool largura) {
+    ArmazemAntenas* arm = g->armazem;
+    int origem = SlotDoVertice(arm, idOrigem);
+    if (origem < 0) {
+        printf("Antena de origem não encontrada.\n");
+        return;
+    }
+    int* ordem = (int*)malloc((arm->numSlots + 1) * sizeof(int));
+    if (ordem == NULL) {
+        return;
+    }
+    int n = largura ? PercorrerLarguraArmazem(g, idOrigem, ordem) : PercorrerProfundidadeArmazem(g, idOrigem, ordem);
+    if (n > 0) {
+        printf("%s a partir da antena [%d,%d]:\n", largura ? "BFS" : "DFS", arm->x[origem], arm->y[origem]);
+    }
+    for (int i = 0; i < n; i++) {
+        printf("Antena ID %d\n", ordem[i]);
+    }
+    free(ordem);
+}
+
+/**
+ * \brief Busca em profundidade num grafo sobre o armazém.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param idOrigem ID do vértice de origem.
+ */
+void ProcuraProfundidadeArmazem(GR* g, int idOrigem) {
+    MostrarProcuraArmazem(g, idOrigem, false);
+}
+
+/**
+ * \brief Busca em largura num grafo sobre o armazém.
+ *
+ * \param g Ponteiro para o grafo.
+ * \param idOrigem ID do vértice de origem.
+ */
+void ProcuraLarguraArmazem(GR* g, int idOrigem) {
+    MostrarProcuraArmazem(g, idOrigem, true);
+}
+#pragma endregion
+
+#pragma region Grafo de interferência
+/**
+ * \brief Acrescenta uma aresta dirigida origem -> destino (slots).
+ */
+static void AcrescentarAresta(GR* g, int origem, int destino) {
+    Aresta* a = CriarAresta(destino + 1);
+    if (a != NULL) {
+        a->prox = g->adjacentes[origem];
+        g->adjacentes[origem] = a;
+    }
+}
+
+/**
+ * \brief Remove uma única aresta dirigida origem -> destino (slots).
+ */
+static void RemoverUmaAresta(GR* g, int origem, int destino) {
+    Aresta** ant = &g->adjacentes[origem];
+    while (*ant != NULL && (*ant)->destino != destino + 1) ant = &(*ant)->prox;
+    if (*ant != NULL) {
+        Aresta* temp = *ant;
+        *ant = temp->prox;
+        free(temp);
+    }
+}
+
+/**
+ * \brief Liga (ou desliga) os membros do par (p, q) às antenas atingidas pelos seus dois efeitos.
+ */
+static void AplicarParInterferencia(GR* g, int p, int q, bool ligar) {
+    const ArmazemAntenas* a = g->armazem;
+    int efeitos[2][2] = {
+        { 2 * a->x[p] - a->x[q], 2 * a->y[p] - a->y[q] },
+        { 2 * a->x[q] - a->x[p], 2 * a->y[q] - a->y[p] }
+    };
+    for (int e = 0; e < 2; e++) {
+        int v = ProcurarAntenaArmazem(a, efeitos[e][0], efeitos[e][1]);
+        if (v < 0) continue;
+        if (ligar) {
+            AcrescentarAresta(g, p, v);
+            AcrescentarAresta(g, q, v);
+        }
+        else {
+            RemoverUmaAresta(g, p, v);
+            RemoverUmaAresta(g, q, v);
+        }
+    }
+}
+
+/**
+ * \brief Aplica AplicarParInterferencia a todos os pares do slot s com as antenas da sua frequência.
+ */
+static void AplicarParesDoSlot(GR* g, int s, bool ligar) {
+    const ArmazemAntenas* a = g->armazem;
+    const BaldeMorton* b = a->ordemMorton ? a->baldes[ID_FREQ(a, a->freq[s])] : NULL;
+    int n = b != NULL ? b->numAntenas : a->numSlots;
+    for (int i = 0; i < n; i++) {
+        int q = b != NULL ? b->slot[i] : i;
+        if (q != s && a->freq[q] == a->freq[s]) AplicarParInterferencia(g, s, q, ligar);
+    }
+}
+
+/**
+ * \brief Cria as arestas de interferência de uma antena acabada de inserir.
+ *
+ * A antena passa a ser alvo dos pares cujo efeito cai na sua célula (CausasEfeito)
+ * e origem de arestas para as antenas atingidas pelos pares que forma com as
+ * antenas da sua frequência. Custo O(k_f) sondagens à tabela de dispersão.
+ *
+ * \param g Ponteiro para o grafo de interferência.
+ * \param slot Slot da antena.
+ * \return true se as arestas foram criadas, false se faltar memória.
+ */
+bool LigarInterferencias(GR* g, int slot) {
+    const ArmazemAntenas* a = g->armazem;
+    int n = CausasEfeito(a, a->x[slot], a->y[slot], NULL, NULL, 0);
+    if (n > 0) {
+        int* proximas = (int*)malloc(n * sizeof(int));
+        int* distantes = (int*)malloc(n * sizeof(int));
+        if (proximas == NULL || distantes == NULL) {
+            free(proximas);
+            free(distantes);
+            return false;
+        }
+        CausasEfeito(a, a->x[slot], a->y[slot], proximas, distantes, n);
+        for (int i = 0; i < n; i++) {
+            AcrescentarAresta(g, proximas[i], slot);
+            AcrescentarAresta(g, distantes[i], slot);
+        }
+        free(proximas);
+        free(distantes);
+    }
+    AplicarParesDoSlot(g, slot, true);
+    return true;
+}
+
+/**
+ * \brief Retira as arestas de interferência que dependem de uma antena (antes de a remover).
+ *
+ * Remove as arestas que apontam para ela e, para cada par que ela forma, uma
+ * aresta do outro membro para cada antena atingida. As suas próprias arestas
+ * de saída ficam para RemoverVerticeArmazem.
+ *
+ * \param g Ponteiro para o grafo de interferência.
+ * \param slot Slot da antena.
+ */
+void DesligarInterferencias(GR* g, int slot) {
+    const ArmazemAntenas* a = g->armazem;
+    int n = CausasEfeito(a, a->x[slot], a->y[slot], NULL, NULL, 0);
+    int* membros = n > 0 ? (int*)malloc(2 * n * sizeof(int)) : NULL;
+    if (membros != NULL) {
+        CausasEfeito(a, a->x[slot], a->y[slot], membros, membros + n, n);
+        for (int i = 0; i < 2 * n; i++) RemoverArestasPara(g, membros[i], slot + 1);
+        free(membros);
+    }
+    else {
+        for (int s = 0; n > 0 && s < a->numSlots; s++) RemoverArestasPara(g, s, slot + 1);
+    }
+    AplicarParesDoSlot(g, slot, false);
+}
+
+/**
+ * \brief Recalcula todas as arestas de um grafo de interferência.
+ *
+ * \param g Ponteiro para o grafo de interferência.
+ * \return true se as arestas foram recalculadas, false em caso de erro.
+ */
+bool ReconstruirInterferencias(GR* g) {
+    if (g == NULL || g->armazem == NULL || !GarantirAdjacencias(g)) {
+        return false;
+    }
+    const ArmazemAntenas* a = g->armazem;
+    for (int s = 0; s < g->capacidadeAdj; s++) {
+        while (g->adjacentes[s] != NULL) {
+            Aresta* temp = g->adjacentes[s];
+            g->adjacentes[s] = temp->prox;
+            free(temp);
+        }
+    }
+    // Cada par (p, q) é tratado uma vez, a partir do membro com slot maior
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        const BaldeMorton* b = a->ordemMorton ? a->baldes[ID_FREQ(a, a->freq[s])] : NULL;
+        int n = b != NULL ? b->numAntenas : s;
+        for (int i = 0; i < n; i++) {
+            int q = b != NULL ? b->slot[i] : i;
+            if (q < s && a->freq[q] == a->freq[s]) AplicarParInterferencia(g, s, q, true);
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Cria o grafo de interferência sobre o armazém.
+ *
+ * Existe uma aresta dirigida de cada membro de um par de antenas da mesma
+ * frequência para cada antena (de qualquer frequência) na célula de um dos
+ * efeitos nefastos do par. Cada efeito é testado com uma sondagem à tabela de
+ * dispersão do armazém. Um par que atinja a mesma antena por mais do que uma
+ * via gera uma aresta por via, o que permite retirar exatamente as arestas de
+ * cada par quando uma antena é removida. As inserções e remoções seguintes no
+ * grafo atualizam as arestas de forma incremental.
+ *
+ * \param a Ponteiro para o armazém (não passa a pertencer ao grafo).
+ * \return Ponteiro para o grafo criado ou NULL em caso de erro.
+ */
+GR* CriarGrafoInterferencia(ArmazemAntenas* a) {
+    if (a == NULL) {
+        return NULL;
+    }
+    GR* g = CriarGrafo();
+    if (g == NULL) {
+        return NULL;
+    }
+    g->armazem = a;
+    g->interferencia = true;
+    if (!ReconstruirInterferencias(g)) {
+        DestruirGrafo(g);
+        return NULL;
+    }
+    g->numVertices = a->numAntenas;
+    return g;
+}
+#pragma endregion
+
@@ -0,0 +1,467 @@
+/*****************************************************************//**
+ * \file   baldes.c
+ * \brief  Baldes de frequência do armazém ordenados pelo código de Morton.
+ *
+ * Quando a ordem de Morton está ativa, cada frequência tem um balde com os
+ * pares (código de Morton, slot) por ordem crescente de código. As antenas
+ * próximas no grid ficam próximas na memória, e as coordenadas obtêm-se do
+ * próprio código, sem acesso às colunas do armazém. Os baldes são mantidos
+ * de forma incremental nas inserções e remoções do armazém.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#define MASCARA_BITS_X 0x5555555555555555ull
+#define MASCARA_BITS_Y 0xAAAAAAAAAAAAAAAAull
+
+#pragma region Baldes
+/**
+ * \brief Primeira posição do balde com código maior ou igual a m.
+ */
+static int LimiteInferior(const BaldeMorton* b, int ini, uint64_t m) {
+    int fim = b->numAntenas;
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (b->morton[meio] < m) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+/**
+ * \brief Garante espaço para mais extra entradas num balde.
+ */
+static bool GarantirEspacoBalde(BaldeMorton* b, int extra) {
+    if (b->numAntenas + extra <= b->capacidade) {
+        return true;
+    }
+    int novaCap = b->capacidade < 8 ? 8 : b->capacidade * 2;
+    if (novaCap < b->numAntenas + extra) novaCap = b->numAntenas + extra;
+    uint64_t* m = (uint64_t*)realloc(b->morton, novaCap * sizeof(uint64_t));
+    if (m == NULL) return false;
+    b->morton = m;
+    int* s = (int*)realloc(b->slot, novaCap * sizeof(int));
+    if (s == NULL) return false;
+    b->slot = s;
+    b->capacidade = novaCap;
+    return true;
+}
+
+/**
+ * \brief Obtém (criando se necessário) o balde de um id de frequência.
+ */
+static BaldeMorton* ObterBalde(ArmazemAntenas* a, int id) {
+    BaldeMorton** b = &a->baldes[id];
+    if (*b == NULL) {
+        *b = (BaldeMorton*)calloc(1, sizeof(BaldeMorton));
+    }
+    return *b;
+}
+
+/**
+ * \brief Coloca o slot de uma antena no balde da sua frequência, mantendo a ordem.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da antena (já preenchido).
+ * \return true se o balde foi atualizado, false se faltar memória.
+ */
+bool InserirNoBalde(ArmazemAntenas* a, int slot) {
+    if (!a->ordemMorton) {
+        return true;
+    }
+    BaldeMorton* b = ObterBalde(a, ID_FREQ(a, a->freq[slot]));
+    if (b == NULL || !GarantirEspacoBalde(b, 1)) {
+        return false;
+    }
+    uint64_t m = CodigoMorton(a->x[slot], a->y[slot]);
+    int pos = LimiteInferior(b, 0, m);
+    memmove(b->morton + pos + 1, b->morton + pos, (size_t)(b->numAntenas - pos) * sizeof(uint64_t));
+    memmove(b->slot + pos + 1, b->slot + pos, (size_t)(b->numAntenas - pos) * sizeof(int));
+    b->morton[pos] = m;
+    b->slot[pos] = slot;
+    b->numAntenas++;
+    return true;
+}
+
+/**
+ * \brief Retira o slot de uma antena do balde da sua frequência.
+ *
+ * Deve ser chamada antes de o slot ser libertado no armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da antena.
+ */
+void RemoverDoBalde(ArmazemAntenas* a, int slot) {
+    if (!a->ordemMorton) {
+        return;
+    }
+    BaldeMorton* b = a->baldes[ID_FREQ(a, a->freq[slot])];
+    if (b == NULL) {
+        return;
+    }
+    int pos = LimiteInferior(b, 0, CodigoMorton(a->x[slot], a->y[slot]));
+    if (pos < b->numAntenas && b->slot[pos] == slot) {
+        memmove(b->morton + pos, b->morton + pos + 1, (size_t)(b->numAntenas - pos - 1) * sizeof(uint64_t));
+        memmove(b->slot + pos, b->slot + pos + 1, (size_t)(b->numAntenas - pos - 1) * sizeof(int));
+        b->numAntenas--;
+    }
+}
+
+/**
+ * \brief Par (código, slot) usado para ordenar os baldes de uma só vez.
+ */
+typedef struct ParMorton {
+    uint64_t morton;
+    int slot;
+} ParMorton;
+
+static int CompararPares(const void* p1, const void* p2) {
+    const ParMorton* a = (const ParMorton*)p1;
+    const ParMorton* b = (const ParMorton*)p2;
+    return a->morton < b->morton ? -1 : (a->morton > b->morton ? 1 : 0);
+}
+
+/**
+ * \brief Reconstrói todos os baldes a partir das colunas do armazém.
+ *
+ * Usada ao ativar a ordem de Morton e depois de inserções em lote grandes.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return true se os baldes foram reconstruídos, false se faltar memória.
+ */
+bool ReconstruirBaldes(ArmazemAntenas* a) {
+    int inicio[FREQ_IDS + 1] = { 0 };
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') inicio[a->idDaFreq[(unsigned char)a->freq[s]]]++; // Id + 1
+    }
+    for (int f = 0; f < a->numFreqs; f++) inicio[f + 1] += inicio[f];
+    ParMorton* pares = (ParMorton*)malloc((a->numAntenas + 1) * sizeof(ParMorton));
+    if (pares == NULL) {
+        return false;
+    }
+    // Distribui os slots pelos baldes numa única passagem pelas colunas
+    int pos[FREQ_IDS];
+    memcpy(pos, inicio, sizeof(pos));
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        ParMorton* p = &pares[pos[ID_FREQ(a, a->freq[s])]++];
+        p->morton = CodigoMorton(a->x[s], a->y[s]);
+        p->slot = s;
+    }
+    for (int f = 0; f < a->numFreqs; f++) {
+        int n = inicio[f + 1] - inicio[f];
+        if (n == 0) {
+            if (a->baldes[f] != NULL) a->baldes[f]->numAntenas = 0;
+            continue;
+        }
+        BaldeMorton* b = ObterBalde(a, f);
+        if (b == NULL || !GarantirEspacoBalde(b, n - b->numAntenas)) {
+            free(pares);
+            return false;
+        }
+        qsort(pares + inicio[f], n, sizeof(ParMorton), CompararPares);
+        for (int i = 0; i < n; i++) {
+            b->morton[i] = pares[inicio[f] + i].morton;
+            b->slot[i] = pares[inicio[f] + i].slot;
+        }
+        b->numAntenas = n;
+    }
+    free(pares);
+    return true;
+}
+
+/**
+ * \brief Ativa a ordem de Morton no armazém, construindo os baldes.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return true se a ordem ficou ativa, false se faltar memória.
+ */
+bool AtivarOrdemMorton(ArmazemAntenas* a) {
+    if (a == NULL) {
+        return false;
+    }
+    a->ordemMorton = true;
+    if (!ReconstruirBaldes(a)) {
+        DestruirBaldes(a);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Liberta os baldes e desativa a ordem de Morton.
+ *
+ * \param a Ponteiro para o armazém.
+ */
+void DestruirBaldes(ArmazemAntenas* a) {
+    for (int f = 0; f < a->numFreqs; f++) {
+        if (a->baldes[f] == NULL) continue;
+        free(a->baldes[f]->morton);
+        free(a->baldes[f]->slot);
+        free(a->baldes[f]);
+        a->baldes[f] = NULL;
+    }
+    a->ordemMorton = false;
+}
+#pragma endregion
+
+#pragma region Consultas
+/**
+ * \brief Põe a 1 o bit indicado e a 0 os bits inferiores da mesma dimensão.
+ */
+static uint64_t Carregar1000(uint64_t v, int bit) {
+    uint64_t dim = ((bit & 1) ? MASCARA_BITS_Y : MASCARA_BITS_X) & ((1ull << bit) - 1);
+    return (v | (1ull << bit)) & ~dim;
+}
+
+/**
+ * \brief Põe a 0 o bit indicado e a 1 os bits inferiores da mesma dimensão.
+ */
+static uint64_t Carregar0111(uint64_t v, int bit) {
+    uint64_t dim = ((bit & 1) ? MASCARA_BITS_Y : MASCARA_BITS_X) & ((1ull << bit) - 1);
+    return (v & ~(1ull << bit)) | dim;
+}
+
+/**
+ * \brief Menor código de Morton dentro do retângulo [zmin, zmax] maior que z (BIGMIN).
+ *
+ * Permite saltar as partes da curva Z que saem do retângulo.
+ */
+static uint64_t ProximoNoRetangulo(uint64_t z, uint64_t zmin, uint64_t zmax) {
+    uint64_t bigmin = zmax;
+    for (int bit = 63; bit >= 0; bit--) {
+        uint64_t m = 1ull << bit;
+        int bz = (z & m) != 0, bmin = (zmin & m) != 0, bmax = (zmax & m) != 0;
+        if (!bz && !bmin && bmax) {
+            bigmin = Carregar1000(zmin, bit);
+            zmax = Carregar0111(zmax, bit);
+        }
+        else if (!bz && bmin && bmax) {
+            return zmin;
+        }
+        else if (bz && !bmin && !bmax) {
+            return bigmin;
+        }
+        else if (bz && !bmin && bmax) {
+            zmin = Carregar1000(zmin, bit);
+        }
+    }
+    return bigmin;
+}
+
+/**
+ * \brief Procura as antenas de uma frequência dentro de um retângulo.
+ *
+ * Percorre o balde entre os códigos dos cantos do retângulo, saltando (BIGMIN)
+ * os troços da curva Z que ficam fora dele.
+ *
+ * \param a Ponteiro para o armazém (com a ordem de Morton ativa).
+ * \param freq Frequência.
+ * \param x0 Coordenada x mínima (inclusive).
+ * \param y0 Coordenada y mínima (inclusive).
+ * \param x1 Coordenada x máxima (inclusive).
+ * \param y1 Coordenada y máxima (inclusive).
+ * \param slots Vetor de saída com os slots encontrados (pode ser NULL para só contar).
+ * \param max Capacidade de slots.
+ * \return Número de antenas no retângulo (pode ser maior que max) ou -1 se a ordem não estiver ativa.
+ */
+int ConsultarRetanguloFreq(const ArmazemAntenas* a, char freq, int x0, int y0, int x1, int y1, int* slots, int max) {
+    if (a == NULL || !a->ordemMorton) {
+        return -1;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= a->largura) x1 = a->largura - 1;
+    if (y1 >= a->altura) y1 = a->altura - 1;
+    int id = ID_FREQ(a, freq);
+    const BaldeMorton* b = id >= 0 ? a->baldes[id] : NULL;
+    if (b == NULL || x0 > x1 || y0 > y1) {
+        return 0;
+    }
+    uint64_t zmin = CodigoMorton((uint32_t)x0, (uint32_t)y0);
+    uint64_t zmax = CodigoMorton((uint32_t)x1, (uint32_t)y1);
+    int encontradas = 0;
+    int i = LimiteInferior(b, 0, zmin);
+    while (i < b->numAntenas && b->morton[i] <= zmax) {
+        uint32_t x, y;
+        DescodificarMorton(b->morton[i], &x, &y);
+        if ((int)x >= x0 && (int)x <= x1 && (int)y >= y0 && (int)y <= y1) {
+            if (slots != NULL && encontradas < max) slots[encontradas] = b->slot[i];
+            encontradas++;
+            i++;
+        }
+        else {
+            i = LimiteInferior(b, i + 1, ProximoNoRetangulo(b->morton[i], zmin, zmax));
+        }
+    }
+    return encontradas;
+}
+
+/**
+ * \brief Procura as antenas de todas as frequências dentro de um retângulo.
+ *
+ * \return Número de antenas no retângulo (pode ser maior que max) ou -1 se a ordem não estiver ativa.
+ */
+int ConsultarRetangulo(const ArmazemAntenas* a, int x0, int y0, int x1, int y1, int* slots, int max) {
+    if (a == NULL || !a->ordemMorton) {
+        return -1;
+    }
+    int total = 0;
+    for (int f = 0; f < a->numFreqs; f++) {
+        if (a->baldes[f] == NULL || a->baldes[f]->numAntenas == 0) continue;
+        int* destino = (slots != NULL && total < max) ? slots + total : NULL;
+        int livre = total < max ? max - total : 0;
+        total += ConsultarRetanguloFreq(a, a->freqDoId[f], x0, y0, x1, y1, destino, livre);
+    }
+    return total;
+}
+#pragma endregion
+
+#pragma region Vizinhos mais próximos
+/**
+ * \brief Par (distância ao quadrado, slot) usado para ordenar os candidatos.
+ */
+typedef struct ParDistancia {
+    long long distancia;
+    int slot;
+} ParDistancia;
+
+static int CompararDistancia(const void* p, const void* q) {
+    const ParDistancia* a = (const ParDistancia*)p;
+    const ParDistancia* b = (const ParDistancia*)q;
+    if (a->distancia != b->distancia) return a->distancia < b->distancia ? -1 : 1;
+    return (a->slot > b->slot) - (a->slot < b->slot);
+}
+
+/**
+ * \brief Menor inteiro r com r * r >= v.
+ */
+static int RaizTeto(long long v) {
+    long long r = 0, passo = 1LL << 31;
+    for (; passo > 0; passo >>= 1) {
+        if ((r + passo) * (r + passo) < v) r += passo;
+    }
+    return (int)(r * r < v ? r + 1 : r);
+}
+
+/**
+ * \brief Ordena os candidatos pela distância a (x, y).
+ *
+ * \return Vetor de n pares (a libertar pelo chamador) ou NULL se faltar memória.
+ */
+static ParDistancia* OrdenarPorDistancia(const ArmazemAntenas* a, const int* cand, int n, int x, int y) {
+    ParDistancia* pares = (ParDistancia*)malloc((n + 1) * sizeof(ParDistancia));
+    if (pares == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        long long dx = a->x[cand[i]] - x, dy = a->y[cand[i]] - y;
+        pares[i].distancia = dx * dx + dy * dy;
+        pares[i].slot = cand[i];
+    }
+    qsort(pares, n, sizeof(ParDistancia), CompararDistancia);
+    return pares;
+}
+
+/**
+ * \brief Recolhe os slots da frequência no quadrado de lado 2r + 1 centrado em (x, y).
+ */
+static int RecolherCandidatos(const ArmazemAntenas* a, char freq, int x, int y, int r, int** cand, int* cap) {
+    int n = ConsultarRetanguloFreq(a, freq, x - r, y - r, x + r, y + r, *cand, *cap);
+    if (n > *cap) {
+        int* novo = (int*)realloc(*cand, n * sizeof(int));
+        if (novo == NULL) {
+            return -1;
+        }
+        *cand = novo;
+        *cap = n;
+        n = ConsultarRetanguloFreq(a, freq, x - r, y - r, x + r, y + r, *cand, *cap);
+    }
+    return n;
+}
+
+/**
+ * \brief Procura as k antenas de uma frequência mais próximas de (x, y) (distância euclidiana).
+ *
+ * Com a ordem de Morton ativa, o balde da frequência serve de índice espacial:
+ * o quadrado de procura duplica até conter k antenas e é depois alargado à
+ * distância da k-ésima, para garantir que nenhuma mais próxima fica de fora.
+ * Sem a ordem ativa, as antenas da frequência são percorridas uma a uma.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param freq Frequência.
+ * \param x Coordenada x do ponto.
+ * \param y Coordenada y do ponto.
+ * \param k Número de antenas pretendidas.
+ * \param slots Vetor de saída (capacidade k) com os slots por ordem de distância.
+ * \return Número de antenas encontradas (no máximo k) ou -1 se faltar memória.
+ */
+int AntenasMaisProximas(const ArmazemAntenas* a, char freq, int x, int y, int k, int* slots) {
+    if (a == NULL || freq == '\0' || k <= 0) {
+        return 0;
+    }
+    int* cand = NULL;
+    int cap = 0, n = 0;
+    if (!a->ordemMorton) {
+        cap = a->numAntenas;
+        cand = (int*)calloc(cap + 1, sizeof(int));
+        if (cand == NULL) {
+            return -1;
+        }
+        for (int s = 0; s < a->numSlots; s++) {
+            if (a->freq[s] == freq) cand[n++] = s;
+        }
+    }
+    else {
+        int id = ID_FREQ(a, freq);
+        const BaldeMorton* b = id >= 0 ? a->baldes[id] : NULL;
+        if (b == NULL || b->numAntenas == 0) {
+            return 0;
+        }
+        int alvo = k < b->numAntenas ? k : b->numAntenas;
+        cap = 2 * alvo;
+        cand = (int*)calloc(cap, sizeof(int));
+        if (cand == NULL) {
+            return -1;
+        }
+        // Raio a partir do qual o quadrado cobre o grid inteiro
+        int alcance = x > a->largura - 1 - x ? x : a->largura - 1 - x;
+        if (y > alcance) alcance = y;
+        if (a->altura - 1 - y > alcance) alcance = a->altura - 1 - y;
+        int r = 1;
+        while ((n = RecolherCandidatos(a, freq, x, y, r, &cand, &cap)) >= 0 && n < alvo && r < alcance) {
+            r *= 2;
+        }
+        if (n >= alvo) {
+            // A k-ésima candidata pode estar num canto: alarga o quadrado até à sua distância
+            ParDistancia* pares = OrdenarPorDistancia(a, cand, n, x, y);
+            long long maior = pares != NULL ? pares[alvo - 1].distancia : 0;
+            free(pares);
+            if (maior > (long long)r * r) {
+                n = RecolherCandidatos(a, freq, x, y, RaizTeto(maior), &cand, &cap);
+            }
+        }
+        if (n < 0) {
+            free(cand);
+            return -1;
+        }
+    }
+
+    ParDistancia* pares = OrdenarPorDistancia(a, cand, n, x, y);
+    if (pares == NULL) {
+        free(cand);
+        return -1;
+    }
+    if (n > k) n = k;
+    for (int i = 0; i < n; i++) slots[i] = pares[i].slot;
+    free(pares);
+    free(cand);
+    return n;
+}
+
+#pragma endregion
+
@@ -0,0 +1,490 @@
+/*****************************************************************//**
+ * \file   benchmark.c
+ * \brief  Benchmark das operações do armazém de antenas em grids sintéticos.
+ *
+ * Gera conjuntos de antenas com semente fixa (tamanho do grid a partir da
+ * densidade, frequências com distribuição de Zipf configurável) e mede, para
+ * cada N, a inserção em lote, a memória ocupada pelo armazém, a gravação e o
+ * carregamento (BIN, TXT e snapshot comprimido), a inserção paralela no
+ * armazém fragmentado e a respetiva vista global, a criação do armazém em disco por tiles e os seus
+ * efeitos (comparados com os do armazém em memória), o cálculo dos efeitos,
+ * a contagem dos efeitos em memória constante (gerador de efeitos),
+ * a renderização do grid e de janelas do grid, a exportação da imagem PPM,
+ * a criação do grafo e as procuras em largura e em profundidade. Cada fase é
+ * reportada com o tempo, o débito (itens por segundo) e o pico de memória
+ * residente, em CSV ou JSON, para acompanhar regressões.
+ *
+ * Compilação (Linux, a partir da pasta benchmark):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=32768 -o benchmark benchmark.c ../armazem.c \
+ *       ../baldes.c ../bitboard.c ../carregamento.c ../compressao.c \
+ *       ../efeitos.c ../estatisticas.c ../fragmentos.c ../funcoes.c \
+ *       ../regioes.c ../tiles.c -pthread -lm
+ *
+ * GRID_TAM tem de cobrir o maior grid gerado (os carregamentos criam o
+ * armazém com GRID_TAM x GRID_TAM).
+ *
+ * Utilização:
+ *
+ *   ./benchmark [--n 1000,10000,...] [--densidade 0.01] [--freqs 62]
+ *               [--skew 0.0] [--semente 1] [--formato csv|json]
+ *               [--limite-pares 1e9] [--limite-celulas 1e8] [--pasta /tmp]
+ *               [--threads 0] [--fragmentos 0] [--lado-tiles 1024]
+ *
+ * As fases cujo custo excede os limites (pares para os efeitos, células do
+ * grid para TXT e renderização) são saltadas e assinaladas no stderr.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../dados.h"
+#include "../funcoes.h"
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <threads.h>
+
+#define MAX_TAMANHOS 32
+
+static const char ALFABETO[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+#pragma region Configuração
+/**
+ * \brief Parâmetros do benchmark.
+ */
+typedef struct Configuracao {
+    long long tamanhos[MAX_TAMANHOS];
+    int numTamanhos;
+    double densidade;     // Antenas por célula
+    int numFreqs;         // Frequências distintas (até 62)
+    double skew;          // Expoente de Zipf das frequências (0 = uniforme)
+    unsigned long long semente;
+    bool json;
+    double limitePares;   // Máximo de pares para calcular efeitos
+    double limiteCelulas; // Máximo de células para TXT e renderização
+    const char* pasta;    // Pasta dos ficheiros temporários
+    int numThreads;       // Threads da inserção fragmentada (0 = processadores)
+    int numFragmentos;    // Fragmentos do armazém fragmentado (0 = 4 por processador)
+    int ladoTiles;        // Lado dos tiles do armazém em disco
+} Configuracao;
+
+static void ConfiguracaoPorOmissao(Configuracao* c) {
+    long long omissao[] = { 1000, 10000, 100000, 1000000, 10000000 };
+    c->numTamanhos = 5;
+    for (int i = 0; i < c->numTamanhos; i++) c->tamanhos[i] = omissao[i];
+    c->densidade = 0.01;
+    c->numFreqs = 62;
+    c->skew = 0.0;
+    c->semente = 1;
+    c->json = false;
+    c->limitePares = 1e9;
+    c->limiteCelulas = 1e8;
+    c->pasta = "/tmp";
+    c->numThreads = 0;
+    c->numFragmentos = 0;
+    c->ladoTiles = 1024;
+}
+
+static bool LerArgumentos(Configuracao* c, int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--formato") == 0 && valor != NULL) {
+            c->json = strcmp(valor, "json") == 0;
+        }
+        else if (strcmp(argv[i], "--n") == 0 && valor != NULL) {
+            c->numTamanhos = 0;
+            const char* p = valor;
+            while (*p != '\0' && c->numTamanhos < MAX_TAMANHOS) {
+                char* fim;
+                c->tamanhos[c->numTamanhos++] = (long long)strtod(p, &fim);
+                p = *fim == ',' ? fim + 1 : fim;
+                if (fim == p && *fim != ',') break;
+            }
+        }
+        else if (strcmp(argv[i], "--densidade") == 0 && valor != NULL) c->densidade = atof(valor);
+        else if (strcmp(argv[i], "--freqs") == 0 && valor != NULL) c->numFreqs = atoi(valor);
+        else if (strcmp(argv[i], "--skew") == 0 && valor != NULL) c->skew = atof(valor);
+        else if (strcmp(argv[i], "--semente") == 0 && valor != NULL) c->semente = strtoull(valor, NULL, 10);
+        else if (strcmp(argv[i], "--limite-pares") == 0 && valor != NULL) c->limitePares = atof(valor);
+        else if (strcmp(argv[i], "--limite-celulas") == 0 && valor != NULL) c->limiteCelulas = atof(valor);
+        else if (strcmp(argv[i], "--pasta") == 0 && valor != NULL) c->pasta = valor;
+        else if (strcmp(argv[i], "--threads") == 0 && valor != NULL) c->numThreads = atoi(valor);
+        else if (strcmp(argv[i], "--fragmentos") == 0 && valor != NULL) c->numFragmentos = atoi(valor);
+        else if (strcmp(argv[i], "--lado-tiles") == 0 && valor != NULL) c->ladoTiles = atoi(valor);
+        else {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            return false;
+        }
+        i++;
+    }
+    if (c->numFreqs < 1) c->numFreqs = 1;
+    if (c->numFreqs > (int)sizeof(ALFABETO) - 1) c->numFreqs = (int)sizeof(ALFABETO) - 1;
+    if (c->densidade <= 0) c->densidade = 0.01;
+    if (c->semente == 0) c->semente = 1;
+    if (c->numThreads <= 0) c->numThreads = NumeroProcessadores();
+    if (c->numThreads > 256) c->numThreads = 256;
+    return true;
+}
+#pragma endregion
+
+#pragma region Gerador
+/**
+ * \brief Próximo número do gerador xorshift64*.
+ */
+static unsigned long long Aleatorio(unsigned long long* estado) {
+    unsigned long long x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * \brief Gera n antenas num grid lado x lado, com frequências de Zipf(skew).
+ */
+static void GerarAntenas(const Configuracao* c, int lado, int n, char* freq, int* x, int* y) {
+    unsigned long long estado = c->semente;
+    double acumulado[64];
+    double total = 0;
+    for (int f = 0; f < c->numFreqs; f++) {
+        total += 1.0 / pow(f + 1, c->skew);
+        acumulado[f] = total;
+    }
+    for (int i = 0; i < n; i++) {
+        double u = (Aleatorio(&estado) >> 11) * (1.0 / 9007199254740992.0) * total;
+        int f = 0;
+        while (f < c->numFreqs - 1 && acumulado[f] < u) f++;
+        freq[i] = ALFABETO[f];
+        x[i] = (int)(Aleatorio(&estado) % (unsigned long long)lado);
+        y[i] = (int)(Aleatorio(&estado) % (unsigned long long)lado);
+    }
+}
+#pragma endregion
+
+#pragma region Medição
+static double Agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static long PicoMemoriaKb(void) {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss; // Em KB no Linux
+}
+
+/**
+ * \brief Desvia o stdout para /dev/null (as listagens e procuras escrevem no ecrã).
+ *
+ * \return Descritor do stdout original.
+ */
+static int SilenciarSaida(void) {
+    fflush(stdout);
+    int guardado = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (nulo >= 0) {
+        dup2(nulo, STDOUT_FILENO);
+        close(nulo);
+    }
+    return guardado;
+}
+
+static void RestaurarSaida(int guardado) {
+    fflush(stdout);
+    if (guardado >= 0) {
+        dup2(guardado, STDOUT_FILENO);
+        close(guardado);
+    }
+}
+
+static int numResultados = 0;
+
+/**
+ * \brief Escreve uma linha de resultados.
+ */
+static void Reportar(const Configuracao* c, long long n, int lado, const char* fase, double segundos, long long itens) {
+    double debito = segundos > 0 ? itens / segundos : 0;
+    if (c->json) {
+        printf("%s\n  {\"n\": %lld, \"lado\": %d, \"fase\": \"%s\", \"segundos\": %.6f, \"itens\": %lld, "
+            "\"itens_por_segundo\": %.1f, \"rss_pico_kb\": %ld}",
+            numResultados > 0 ? "," : "", n, lado, fase, segundos, itens, debito, PicoMemoriaKb());
+    }
+    else {
+        printf("%lld,%d,%s,%.6f,%lld,%.1f,%ld\n", n, lado, fase, segundos, itens, debito, PicoMemoriaKb());
+    }
+    numResultados++;
+    fflush(stdout);
+}
+#pragma endregion
+
+#pragma region Inserção paralela
+#define BLOCO_INSERCAO 4096 // Antenas por chamada de InserirAntenasEmLoteFragmentado
+
+/**
+ * \brief Fatia das antenas geradas inserida por uma thread (simula uma fonte de dados).
+ */
+typedef struct TarefaInsercao {
+    ArmazemFragmentado* armazem;
+    const char* freq;
+    const int* x;
+    const int* y;
+    int n;
+    int inseridas;
+} TarefaInsercao;
+
+static int ThreadInserir(void* arg) {
+    TarefaInsercao* t = (TarefaInsercao*)arg;
+    for (int i = 0; i < t->n; i += BLOCO_INSERCAO) {
+        int m = t->n - i < BLOCO_INSERCAO ? t->n - i : BLOCO_INSERCAO;
+        int r = InserirAntenasEmLoteFragmentado(t->armazem, t->freq + i, t->x + i, t->y + i, m, NULL);
+        if (r > 0) t->inseridas += r;
+    }
+    return 0;
+}
+
+/**
+ * \brief Insere as antenas no armazém fragmentado com várias threads.
+ *
+ * \return Antenas inseridas ou -1 se não foi possível criar as threads.
+ */
+static int InserirEmParalelo(ArmazemFragmentado* f, const char* freq, const int* x, const int* y, int n, int numThreads) {
+    TarefaInsercao tarefas[256];
+    thrd_t threads[256];
+    bool criada[256];
+    int total = 0;
+    bool falhou = false;
+    for (int k = 0; k < numThreads; k++) {
+        int ini = (int)((long long)n * k / numThreads);
+        int fim = (int)((long long)n * (k + 1) / numThreads);
+        tarefas[k] = (TarefaInsercao){ f, freq + ini, x + ini, y + ini, fim - ini, 0 };
+        criada[k] = thrd_create(&threads[k], ThreadInserir, &tarefas[k]) == thrd_success;
+        if (!criada[k]) falhou = true;
+    }
+    for (int k = 0; k < numThreads; k++) {
+        if (!criada[k]) continue;
+        thrd_join(threads[k], NULL);
+        total += tarefas[k].inseridas;
+    }
+    return falhou ? -1 : total;
+}
+#pragma endregion
+
+#pragma region Fases
+/**
+ * \brief Executa todas as fases para um tamanho N.
+ */
+static void MedirTamanho(const Configuracao* c, long long n) {
+    int lado = (int)ceil(sqrt(n / c->densidade));
+    if (lado < 1) lado = 1;
+    if (lado > GRID_TAM) {
+        fprintf(stderr, "N=%lld: grid %d maior que GRID_TAM=%d, ignorado\n", n, lado, GRID_TAM);
+        return;
+    }
+    char* freq = (char*)malloc((size_t)n);
+    int* x = (int*)malloc((size_t)n * sizeof(int));
+    int* y = (int*)malloc((size_t)n * sizeof(int));
+    if (freq == NULL || x == NULL || y == NULL) {
+        fprintf(stderr, "N=%lld: sem memoria para gerar as antenas\n", n);
+        free(freq);
+        free(x);
+        free(y);
+        return;
+    }
+    GerarAntenas(c, lado, (int)n, freq, x, y);
+
+    char bin[512], txt[512], zbin[512], tiles[512], nomeTiles[520];
+    snprintf(bin, sizeof(bin), "%s/benchmark_antenas.bin", c->pasta);
+    snprintf(tiles, sizeof(tiles), "%s/benchmark_tiles", c->pasta);
+    snprintf(txt, sizeof(txt), "%s/benchmark_antenas.txt", c->pasta);
+    snprintf(zbin, sizeof(zbin), "%s/benchmark_antenas.zbin", c->pasta);
+    double celulas = (double)lado * lado;
+
+    double t = Agora();
+    ArmazemAntenas* a = CriarArmazem(lado, lado);
+    int inseridas = InserirAntenasEmLote(a, freq, x, y, (int)n, NULL);
+    Reportar(c, n, lado, "inserir_lote", Agora() - t, n);
+
+    ArmazemFragmentado* fragmentado = CriarArmazemFragmentado(lado, lado, c->numFragmentos);
+    if (fragmentado != NULL) {
+        char fase[64];
+        snprintf(fase, sizeof(fase), "inserir_fragmentado_%dt", c->numThreads);
+        t = Agora();
+        int r = InserirEmParalelo(fragmentado, freq, x, y, (int)n, c->numThreads);
+        Reportar(c, n, lado, fase, Agora() - t, n);
+        if (r != inseridas) {
+            fprintf(stderr, "N=%lld: insercao fragmentada com %d antenas (esperadas %d)\n", n, r, inseridas);
+        }
+        t = Agora();
+        DestruirArmazem(CriarVistaGlobal(fragmentado));
+        Reportar(c, n, lado, "vista_global", Agora() - t, r);
+        DestruirArmazemFragmentado(fragmentado);
+    }
+    free(freq);
+    free(x);
+    free(y);
+    if (inseridas < 0) {
+        fprintf(stderr, "N=%lld: falha na insercao em lote\n", n);
+        DestruirArmazem(a);
+        return;
+    }
+    // Sem tempo: os itens são os bytes ocupados pelo armazém, para acompanhar o custo por antena
+    Reportar(c, n, lado, "memoria_armazem", 0, (long long)MemoriaArmazem(a));
+
+    t = Agora();
+    SalvarArmazemEmBin(a, bin);
+    Reportar(c, n, lado, "salvar_bin", Agora() - t, a->numAntenas);
+    t = Agora();
+    DestruirArmazem(CarregarArmazemDeBin(bin));
+    Reportar(c, n, lado, "carregar_bin", Agora() - t, a->numAntenas);
+    t = Agora();
+    ArmazemTiles* armazemTiles = CriarArmazemTiles(tiles, bin, lado, lado, c->ladoTiles);
+    Reportar(c, n, lado, "criar_tiles", Agora() - t, a->numAntenas);
+    if (armazemTiles == NULL) {
+        fprintf(stderr, "N=%lld: falha na criacao do armazem em disco (lado dos tiles %d)\n", n, c->ladoTiles);
+    }
+
+    t = Agora();
+    SalvarArmazemComprimido(a, zbin);
+    Reportar(c, n, lado, "salvar_comprimido", Agora() - t, a->numAntenas);
+    t = Agora();
+    DestruirArmazem(CarregarArmazemComprimido(zbin));
+    Reportar(c, n, lado, "carregar_comprimido", Agora() - t, a->numAntenas);
+
+    if (celulas <= c->limiteCelulas) {
+        t = Agora();
+        SalvarArmazemEmTxt(a, txt);
+        Reportar(c, n, lado, "salvar_txt", Agora() - t, a->numAntenas);
+        t = Agora();
+        DestruirArmazem(CarregarArmazemDeTxt(txt));
+        Reportar(c, n, lado, "carregar_txt", Agora() - t, a->numAntenas);
+    }
+    else {
+        fprintf(stderr, "N=%lld: TXT saltado (%.0f celulas)\n", n, celulas);
+    }
+    remove(bin);
+    remove(txt);
+    remove(zbin);
+
+    // Pares da mesma frequência (custo do cálculo dos efeitos)
+    long long porFreq[FREQ_IDS] = { 0 };
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') porFreq[IdFrequencia(a, a->freq[s])]++;
+    }
+    double pares = 0;
+    for (int f = 0; f < NumeroFrequencias(a); f++) pares += (double)porFreq[f] * (porFreq[f] - 1) / 2;
+    bool efeitosCalculados = false;
+    if (pares <= c->limitePares) {
+        t = Agora();
+        EfeitosEmCache(a, EFEITOS_PONTOS);
+        Reportar(c, n, lado, "efeitos", Agora() - t, (long long)pares);
+        efeitosCalculados = true;
+        t = Agora();
+        long long contados = ContarEfeitosArmazem(a);
+        Reportar(c, n, lado, "contar_efeitos", Agora() - t, (long long)pares);
+        if (contados != 2 * (long long)pares) { // Sem antenas na mesma posição, cada par gera dois efeitos
+            fprintf(stderr, "N=%lld: %lld efeitos gerados (esperados %lld)\n", n, contados, 2 * (long long)pares);
+        }
+        if (armazemTiles != NULL) {
+            t = Agora();
+            long long celulasTiles = CalcularEfeitosTiles(armazemTiles);
+            Reportar(c, n, lado, "efeitos_tiles", Agora() - t, (long long)pares);
+            long long esperadas = ContarConjuntoEfeitos(EfeitosEmCache(a, EFEITOS_PONTOS));
+            if (celulasTiles != esperadas) {
+                fprintf(stderr, "N=%lld: %lld celulas com efeito no armazem em disco (esperadas %lld)\n", n, celulasTiles, esperadas);
+            }
+        }
+    }
+    else {
+        fprintf(stderr, "N=%lld: efeitos saltados (%.3g pares)\n", n, pares);
+    }
+    if (efeitosCalculados && celulas <= c->limiteCelulas) {
+        int guardado = SilenciarSaida();
+        t = Agora();
+        ListarAntenasArmazemModo(a, EFEITOS_PONTOS); // Usa os efeitos em cache: mede só a renderização
+        double duracao = Agora() - t;
+        RestaurarSaida(guardado);
+        Reportar(c, n, lado, "renderizar", duracao, (long long)celulas);
+    }
+
+    t = Agora();
+    GR* g = CriarGrafoSobreArmazem(a);
+    Reportar(c, n, lado, "criar_grafo", Agora() - t, a->numAntenas);
+    int origem = 0;
+    while (origem < a->numSlots && a->freq[origem] == '\0') origem++;
+    if (g != NULL && origem < a->numSlots) {
+        long long alcancaveis = porFreq[IdFrequencia(a, a->freq[origem])]; // O grafo liga as antenas da mesma frequência
+        int guardado = SilenciarSaida();
+        t = Agora();
+        ProcuraLarguraArmazem(g, IdVertice(a, origem));
+        double bfs = Agora() - t;
+        t = Agora();
+        ProcuraProfundidadeArmazem(g, IdVertice(a, origem));
+        double dfs = Agora() - t;
+        RestaurarSaida(guardado);
+        Reportar(c, n, lado, "bfs", bfs, alcancaveis);
+        Reportar(c, n, lado, "dfs", dfs, alcancaveis);
+    }
+    DestruirGrafo(g);
+
+    // Janelas: todo o grid reduzido e uma janela sem redução no centro
+    if (efeitosCalculados) {
+        AtivarOrdemMorton(a);
+        int fator = (lado + JANELA_ALTURA - 1) / JANELA_ALTURA;
+        int guardado = SilenciarSaida();
+        t = Agora();
+        MostrarJanelaArmazem(a, stdout, 0, 0, JANELA_LARGURA, JANELA_ALTURA, fator, EFEITOS_PONTOS);
+        double reduzida = Agora() - t;
+        t = Agora();
+        MostrarJanelaArmazem(a, stdout, lado / 2, lado / 2, JANELA_LARGURA, JANELA_ALTURA, 1, EFEITOS_PONTOS);
+        double janela = Agora() - t;
+        RestaurarSaida(guardado);
+        Reportar(c, n, lado, "janela_reduzida", reduzida, a->numAntenas);
+        Reportar(c, n, lado, "janela", janela, JANELA_LARGURA * JANELA_ALTURA);
+        if (celulas <= c->limiteCelulas) {
+            char ppm[512];
+            snprintf(ppm, sizeof(ppm), "%s/benchmark_antenas.ppm", c->pasta);
+            t = Agora();
+            ExportarImagemArmazem(a, ppm, IMAGEM_PPM, 1, EFEITOS_PONTOS);
+            Reportar(c, n, lado, "exportar_ppm", Agora() - t, (long long)celulas);
+            remove(ppm);
+        }
+    }
+    DestruirArmazem(a);
+    if (armazemTiles != NULL) {
+        FecharArmazemTiles(armazemTiles);
+        snprintf(nomeTiles, sizeof(nomeTiles), "%s.tiles", tiles);
+        remove(nomeTiles);
+        snprintf(nomeTiles, sizeof(nomeTiles), "%s.efeitos", tiles);
+        remove(nomeTiles);
+    }
+}
+#pragma endregion
+
+int main(int argc, char** argv) {
+    Configuracao c;
+    ConfiguracaoPorOmissao(&c);
+    if (!LerArgumentos(&c, argc, argv)) {
+        return 1;
+    }
+    if (c.json) {
+        printf("[");
+    }
+    else {
+        printf("n,lado,fase,segundos,itens,itens_por_segundo,rss_pico_kb\n");
+    }
+    for (int i = 0; i < c.numTamanhos; i++) {
+        fprintf(stderr, "N=%lld...\n", c.tamanhos[i]);
+        MedirTamanho(&c, c.tamanhos[i]);
+    }
+    if (c.json) {
+        printf("\n]\n");
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*****************************************************************//**
+ * \file   reproduzir.c
+ * \brief  Reprodução de rastreios de sessões com medição de latências.
+ *
+ * Lê um rastreio gravado pelo programa (antenas --rastreio sessao.trc),
+ * reconstrói o armazém inicial e volta a executar todas as operações à
+ * velocidade máxima, com as mesmas chamadas que o menu. Com --tempos cada
+ * operação é medida e o relatório mostra, por tipo, o número de operações,
+ * o tempo total e as latências p50, p99 e máxima, para comparar compilações.
+ * Com --repeticoes N as latências das N execuções são juntadas antes de
+ * calcular os percentis; n e total_ms são por execução (média).
+ *
+ * Compilação (Linux, a partir da pasta benchmark):
+ *
+ *   gcc -std=c11 -O2 -o reproduzir reproduzir.c ../armazem.c ../baldes.c \
+ *       ../bitboard.c ../carregamento.c ../compressao.c ../efeitos.c \
+ *       ../estatisticas.c ../funcoes.c ../rastreio.c ../regioes.c -pthread -lm
+ *
+ * GRID_TAM deve ser o mesmo da compilação que gravou o rastreio.
+ *
+ * Utilização:
+ *
+ *   ./reproduzir sessao.trc [--tempos] [--repeticoes 1] [--formato csv|json]
+ *                [--salvar /tmp/reproducao]
+ *
+ * Sem --salvar as operações RASTREIO_SALVAR não escrevem ficheiros (e não
+ * tocam nos antenas.* da pasta atual).
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../dados.h"
+#include "../funcoes.h"
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#pragma region Medição
+static double Agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief Desvia o stdout para /dev/null (listagens e procuras escrevem no ecrã).
+ *
+ * \return Descritor do stdout original.
+ */
+static int SilenciarSaida(void) {
+    fflush(stdout);
+    int guardado = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (nulo >= 0) {
+        dup2(nulo, STDOUT_FILENO);
+        close(nulo);
+    }
+    return guardado;
+}
+
+static void RestaurarSaida(int guardado) {
+    fflush(stdout);
+    if (guardado >= 0) {
+        dup2(guardado, STDOUT_FILENO);
+        close(guardado);
+    }
+}
+
+static int CompararDuplos(const void* p, const void* q) {
+    double a = *(const double*)p, b = *(const double*)q;
+    return (a > b) - (a < b);
+}
+
+/**
+ * \brief Percentil (0-100) de um vetor já ordenado, pelo método do posto mais próximo.
+ */
+static double Percentil(const double* v, int n, double p) {
+    if (n == 0) {
+        return 0;
+    }
+    int k = (int)(p / 100.0 * n + 0.999999);
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    return v[k - 1];
+}
+#pragma endregion
+
+/**
+ * \brief Reconstrói o estado inicial e executa o rastreio uma vez.
+ *
+ * \param latencias Vetor de latências por operação (NULL para medir só o total).
+ * \param aceites Recebe o número de operações com efeito.
+ * \return Tempo total das operações (sem o estado inicial), em segundos.
+ */
+static double ExecutarRastreio(const OperacaoRastreio* ops, int n, double* latencias, const char* prefixo, int* aceites) {
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    int i = 0;
+    while (i < n && ops[i].tipo == RASTREIO_ANTENA_INICIAL) {
+        ExecutarOperacaoRastreio(a, NULL, &ops[i], prefixo);
+        i++;
+    }
+    AtivarOrdemMorton(a); // Mesmo arranque que o programa
+    CriarIndiceRegioes(a);
+    GR* g = CriarGrafoSobreArmazem(a);
+
+    *aceites = 0;
+    int guardado = SilenciarSaida();
+    double inicio = Agora();
+    for (; i < n; i++) {
+        double t = latencias != NULL ? Agora() : 0;
+        if (ExecutarOperacaoRastreio(a, &g, &ops[i], prefixo)) (*aceites)++;
+        if (latencias != NULL) latencias[i] = Agora() - t;
+    }
+    double total = Agora() - inicio;
+    RestaurarSaida(guardado);
+
+    DestruirGrafo(g);
+    DestruirArmazem(a);
+    return total;
+}
+
+/**
+ * \brief Mostra as latências por tipo de operação.
+ *
+ * \param latencias Latências de todas as repetições (repeticoes blocos de n).
+ */
+static void ReportarLatencias(const OperacaoRastreio* ops, int n, const double* latencias, int repeticoes, bool json) {
+    double* amostras = (double*)malloc(((size_t)n * repeticoes + 1) * sizeof(double));
+    if (amostras == NULL) {
+        return;
+    }
+    if (json) printf("[");
+    else printf("operacao,n,total_ms,p50_us,p99_us,max_us\n");
+    bool primeiro = true;
+    for (int tipo = 1; tipo < RASTREIO_TIPOS; tipo++) {
+        int k = 0;
+        double total = 0;
+        for (int r = 0; r < repeticoes; r++) {
+            const double* execucao = latencias + (size_t)r * n;
+            for (int i = 0; i < n; i++) {
+                if (ops[i].tipo != tipo) continue;
+                amostras[k++] = execucao[i];
+                total += execucao[i];
+            }
+        }
+        if (k == 0) continue;
+        qsort(amostras, k, sizeof(double), CompararDuplos);
+        double p50 = Percentil(amostras, k, 50) * 1e6;
+        double p99 = Percentil(amostras, k, 99) * 1e6;
+        double max = amostras[k - 1] * 1e6;
+        int porExecucao = k / repeticoes;
+        total /= repeticoes;
+        if (json) {
+            printf("%s\n  {\"operacao\": \"%s\", \"n\": %d, \"total_ms\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f}",
+                primeiro ? "" : ",", NomeOperacaoRastreio(tipo), porExecucao, total * 1e3, p50, p99, max);
+        }
+        else {
+            printf("%s,%d,%.3f,%.3f,%.3f,%.3f\n", NomeOperacaoRastreio(tipo), porExecucao, total * 1e3, p50, p99, max);
+        }
+        primeiro = false;
+    }
+    if (json) printf("\n]\n");
+    free(amostras);
+}
+
+int main(int argc, char** argv) {
+    const char* nome = NULL;
+    const char* prefixo = NULL;
+    bool tempos = false;
+    bool json = false;
+    int repeticoes = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tempos") == 0) tempos = true;
+        else if (strcmp(argv[i], "--repeticoes") == 0 && i + 1 < argc) repeticoes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc) json = strcmp(argv[++i], "json") == 0;
+        else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) prefixo = argv[++i];
+        else if (nome == NULL) nome = argv[i];
+        else {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (nome == NULL) {
+        fprintf(stderr, "Utilizacao: %s sessao.trc [--tempos] [--repeticoes N] [--formato csv|json] [--salvar prefixo]\n", argv[0]);
+        return 1;
+    }
+    if (repeticoes < 1) repeticoes = 1;
+
+    int n;
+    OperacaoRastreio* ops = CarregarRastreio(nome, &n);
+    if (ops == NULL) {
+        fprintf(stderr, "Rastreio invalido ou inexistente: %s\n", nome);
+        return 1;
+    }
+    int iniciais = 0;
+    while (iniciais < n && ops[iniciais].tipo == RASTREIO_ANTENA_INICIAL) iniciais++;
+
+    // Com várias repetições as latências de todas as execuções entram nos percentis
+    double* latencias = NULL;
+    if (tempos) {
+        latencias = (double*)calloc((size_t)n * repeticoes + 1, sizeof(double));
+        if (latencias == NULL) {
+            fprintf(stderr, "Sem memoria para as latencias\n");
+            return 1;
+        }
+    }
+    double melhorTotal = 0;
+    int aceites = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        double* execucao = tempos ? latencias + (size_t)r * n : NULL;
+        double total = ExecutarRastreio(ops, n, execucao, prefixo, &aceites);
+        if (r == 0 || total < melhorTotal) melhorTotal = total;
+    }
+    int numOps = n - iniciais;
+    fprintf(stderr, "%d antenas iniciais, %d operacoes (%d com efeito) em %.3f ms (%.0f operacoes/s)\n",
+        iniciais, numOps, aceites, melhorTotal * 1e3, melhorTotal > 0 ? numOps / melhorTotal : 0);
+    if (tempos) {
+        ReportarLatencias(ops, n, latencias, repeticoes, json);
+    }
+    free(latencias);
+    free(ops);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*****************************************************************//**
+ * \file   bitboard.c
+ * \brief  Motor de bitboards para grids pequenos (até 64x64).
+ *
+ * Cada linha do grid cabe numa palavra de 64 bits (bit x = coluna x), pelo
+ * que uma camada de frequência são no máximo 64 palavras. Os efeitos de uma
+ * antena a com todas as outras da mesma camada são a camada refletida em
+ * torno de a (rotação de 180 graus): a linha y vai para a linha 2ya - y e a
+ * coluna x para 2xa - x, o que se obtém invertendo a ordem dos bits da linha
+ * e deslocando-a. Cada antena custa assim O(altura) operações de palavra em
+ * vez de O(k) pares.
+ *
+ * O motor é escolhido automaticamente quando GRID_TAM <= 64 (MOTOR_BITBOARD)
+ * e o armazém cabe nos 64x64.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#pragma region Bitboards
+/**
+ * \brief Inverte a ordem dos 64 bits de uma palavra.
+ */
+static uint64_t InverterBits(uint64_t v) {
+    v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+    v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+    return (v >> 32) | (v << 32);
+}
+
+/**
+ * \brief Cria o motor de bitboards com as camadas de frequência de um armazém.
+ *
+ * \param a Ponteiro para o armazém (no máximo BITBOARD_TAM x BITBOARD_TAM).
+ * \return Ponteiro para o motor ou NULL se o grid for grande demais ou faltar memória.
+ */
+MotorBitboard* CriarMotorBitboard(const ArmazemAntenas* a) {
+    if (a == NULL || a->largura > BITBOARD_TAM || a->altura > BITBOARD_TAM) {
+        return NULL;
+    }
+    MotorBitboard* m = (MotorBitboard*)calloc(1, sizeof(MotorBitboard));
+    if (m == NULL) {
+        return NULL;
+    }
+    m->largura = a->largura;
+    m->altura = a->altura;
+    m->mascara = a->largura == 64 ? ~0ull : (1ull << a->largura) - 1;
+    m->numCamadas = a->numFreqs; // Uma camada por id de frequência do armazém
+    m->camadas = (uint64_t(*)[BITBOARD_TAM])calloc(m->numCamadas + 1, sizeof(*m->camadas));
+    if (m->camadas == NULL) {
+        free(m);
+        return NULL;
+    }
+    memcpy(m->freqCamada, a->freqDoId, a->numFreqs);
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        uint64_t bit = 1ull << a->x[s];
+        m->camadas[ID_FREQ(a, a->freq[s])][a->y[s]] |= bit;
+        m->ocupacao[a->y[s]] |= bit;
+    }
+    return m;
+}
+
+/**
+ * \brief Destrói o motor de bitboards.
+ *
+ * \return true se o motor foi destruído, false se era NULL.
+ */
+bool DestruirMotorBitboard(MotorBitboard* m) {
+    if (m == NULL) {
+        return false;
+    }
+    free(m->camadas);
+    free(m);
+    return true;
+}
+
+/**
+ * \brief Junta ao conjunto os efeitos de todas as camadas (modo EFEITOS_PONTOS).
+ *
+ * \param m Ponteiro para o motor.
+ * \param c Conjunto com as mesmas dimensões do motor (uma palavra por linha).
+ * \return true se os efeitos foram calculados, false se as dimensões não coincidirem.
+ */
+bool EfeitosBitboard(const MotorBitboard* m, ConjuntoEfeitos* c) {
+    if (m == NULL || c == NULL || c->largura != m->largura || c->altura != m->altura) {
+        return false;
+    }
+    uint64_t invertidas[BITBOARD_TAM];
+    for (int k = 0; k < m->numCamadas; k++) {
+        const uint64_t* camada = m->camadas[k];
+        for (int y = 0; y < m->altura; y++) invertidas[y] = InverterBits(camada[y]);
+#ifdef ESTATISTICAS
+        unsigned long long antenasCamada = 0;
+        for (int y = 0; y < m->altura; y++) antenasCamada += (unsigned long long)ContarBits(camada[y]);
+        ESTAT_SOMAR(paresMesmaFreq, antenasCamada * (antenasCamada - 1) / 2);
+#endif
+        for (int ya = 0; ya < m->altura; ya++) {
+            uint64_t linha = camada[ya];
+            while (linha != 0) {
+                int xa = IndiceBitMenor(linha);
+                linha &= linha - 1;
+                // Reflexão da camada em torno de a: a antena b = (x, y) vai para (2xa - x, 2ya - y)
+                int desloca = 63 - 2 * xa;
+                int yMin = 2 * ya - (m->altura - 1) > 0 ? 2 * ya - (m->altura - 1) : 0;
+                int yMax = 2 * ya < m->altura - 1 ? 2 * ya : m->altura - 1;
+                for (int y = yMin; y <= yMax; y++) {
+                    uint64_t v = invertidas[y];
+                    if (y == ya) v &= ~(1ull << (63 - xa)); // A própria antena não forma par
+                    if (v == 0) continue;
+                    v = desloca >= 0 ? v >> desloca : v << -desloca;
+                    c->bits[2 * ya - y] |= v & m->mascara;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Mostra o grid com as antenas e os efeitos, linha a linha a partir das bitboards.
+ *
+ * Escreve o mesmo que ListarAntenasArmazemModo, sem construir o grid de caracteres.
+ *
+ * \param m Ponteiro para o motor.
+ * \param c Efeitos a mostrar (por exemplo os da cache do armazém), com as dimensões do motor.
+ * \return true se o grid foi mostrado, false se as dimensões não coincidirem.
+ */
+bool ListarBitboard(const MotorBitboard* m, const ConjuntoEfeitos* c) {
+    if (m == NULL || c == NULL || c->largura != m->largura || c->altura != m->altura) {
+        return false;
+    }
+    char linha[2 * BITBOARD_TAM + 2];
+    for (int y = 0; y < m->altura; y++) {
+        uint64_t efeitos = c->bits[(size_t)y * c->palavrasLinha] & ~m->ocupacao[y]; // As antenas sobrepõem-se aos efeitos
+        for (int x = 0; x < m->largura; x++) {
+            char simbolo = '.';
+            if ((m->ocupacao[y] >> x) & 1) {
+                for (int k = 0; k < m->numCamadas; k++) {
+                    if ((m->camadas[k][y] >> x) & 1) {
+                        simbolo = m->freqCamada[k];
+                        break;
+                    }
+                }
+            }
+            else if ((efeitos >> x) & 1) {
+                simbolo = '#';
+            }
+            linha[2 * x] = simbolo;
+            linha[2 * x + 1] = ' ';
+        }
+        linha[2 * m->largura] = '\n';
+        linha[2 * m->largura + 1] = '\0';
+        fputs(linha, stdout);
+    }
+    return true;
+}
+#pragma endregion
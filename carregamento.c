@@ -0,0 +1,402 @@
+/*****************************************************************//**
+ * \file   carregamento.c
+ * \brief  Carregamento paralelo de ficheiros de antenas (TXT e BIN).
+ *
+ * O ficheiro é lido para memória e dividido em blocos alinhados às linhas
+ * (TXT) ou aos registos (BIN). Cada bloco é analisado numa thread para um
+ * buffer próprio; no fim cada thread copia o seu buffer para a sua zona do
+ * lote, que fica pela ordem do ficheiro. A validação e a remoção de
+ * duplicados ficam para InserirAntenasEmLote, que ordena o lote ao inseri-lo
+ * no armazém; os baldes de frequência são os do próprio armazém.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include "dados.h"
+#include "funcoes.h"
+#include <threads.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define TAM_REGISTO_BIN 9 // freq (1 byte) + x (4 bytes) + y (4 bytes)
+
+/**
+ * \brief Trabalho atribuído a cada thread de carregamento.
+ */
+typedef struct TarefaCarregamento {
+    const char* inicio;   // Início do bloco no buffer do ficheiro
+    const char* fim;      // Fim do bloco (exclusivo)
+    bool binario;
+    bool semMemoria;      // AcrescentarAoLote falhou: o carregamento é abandonado
+    int numLinhas;        // Linhas completas encontradas no bloco (TXT)
+    int linhaBase;        // Linha do ficheiro onde o bloco começa (TXT)
+    LoteAntenas local;    // Antenas lidas (y relativo ao bloco no caso TXT)
+    LoteAntenas* destino; // Lote final, usado na fase de distribuição
+    int posicao;          // Posição do bloco no lote final
+} TarefaCarregamento;
+
+#pragma region Lotes
+/**
+ * \brief Cria um lote vazio de antenas.
+ *
+ * \param capacidade Capacidade inicial.
+ * \return Ponteiro para o lote criado ou NULL se faltar memória.
+ */
+LoteAntenas* CriarLote(int capacidade) {
+    LoteAntenas* lote = (LoteAntenas*)calloc(1, sizeof(LoteAntenas));
+    if (lote == NULL) {
+        return NULL;
+    }
+    if (capacidade < 16) capacidade = 16;
+    lote->freq = (char*)malloc(capacidade);
+    lote->x = (int*)malloc(capacidade * sizeof(int));
+    lote->y = (int*)malloc(capacidade * sizeof(int));
+    if (lote->freq == NULL || lote->x == NULL || lote->y == NULL) {
+        DestruirLote(lote);
+        return NULL;
+    }
+    lote->capacidade = capacidade;
+    return lote;
+}
+
+/**
+ * \brief Acrescenta uma antena ao fim de um lote, aumentando-o se necessário.
+ *
+ * \return true se a antena foi acrescentada, false se faltar memória.
+ */
+bool AcrescentarAoLote(LoteAntenas* lote, char freq, int x, int y) {
+    if (lote->numAntenas == lote->capacidade) {
+        int novaCap = lote->capacidade < 16 ? 16 : lote->capacidade * 2;
+        char* f = (char*)realloc(lote->freq, novaCap);
+        if (f == NULL) return false;
+        lote->freq = f;
+        int* nx = (int*)realloc(lote->x, novaCap * sizeof(int));
+        if (nx == NULL) return false;
+        lote->x = nx;
+        int* ny = (int*)realloc(lote->y, novaCap * sizeof(int));
+        if (ny == NULL) return false;
+        lote->y = ny;
+        lote->capacidade = novaCap;
+    }
+    lote->freq[lote->numAntenas] = freq;
+    lote->x[lote->numAntenas] = x;
+    lote->y[lote->numAntenas] = y;
+    lote->numAntenas++;
+    return true;
+}
+
+/**
+ * \brief Destrói um lote, liberando a memória alocada.
+ *
+ * \param lote Ponteiro para o lote.
+ * \return true se o lote foi destruído, false se era NULL.
+ */
+bool DestruirLote(LoteAntenas* lote) {
+    if (lote == NULL) {
+        return false;
+    }
+    free(lote->freq);
+    free(lote->x);
+    free(lote->y);
+    free(lote);
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Carregamento paralelo
+/**
+ * \brief Devolve o número de processadores disponíveis.
+ */
+int NumeroProcessadores() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/**
+ * \brief Analisa um bloco de um ficheiro de texto (uma linha do grid por linha).
+ */
+static void AnalisarBlocoTxt(TarefaCarregamento* t) {
+    int linha = 0;
+    int coluna = 0;
+    for (const char* p = t->inicio; p < t->fim; p++) {
+        char c = *p;
+        if (c == '\n') {
+            linha++;
+            coluna = 0;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r') {
+            if (c != '.' && !AcrescentarAoLote(&t->local, c, coluna, linha)) {
+                t->semMemoria = true;
+                return;
+            }
+            coluna++;
+        }
+    }
+    t->numLinhas = linha;
+}
+
+/**
+ * \brief Analisa um bloco de registos binários (freq, x, y).
+ */
+static void AnalisarBlocoBin(TarefaCarregamento* t) {
+    for (const char* p = t->inicio; p + TAM_REGISTO_BIN <= t->fim; p += TAM_REGISTO_BIN) {
+        int x, y;
+        memcpy(&x, p + 1, sizeof(int));
+        memcpy(&y, p + 1 + sizeof(int), sizeof(int));
+        if (!AcrescentarAoLote(&t->local, p[0], x, y)) {
+            t->semMemoria = true;
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Primeira fase de cada thread: analisa o seu bloco.
+ */
+static int ThreadAnalisar(void* arg) {
+    TarefaCarregamento* t = (TarefaCarregamento*)arg;
+    if (t->binario) {
+        AnalisarBlocoBin(t);
+    }
+    else {
+        AnalisarBlocoTxt(t);
+    }
+    return 0;
+}
+
+/**
+ * \brief Segunda fase de cada thread: copia as suas antenas para a sua zona do lote final.
+ */
+static int ThreadDistribuir(void* arg) {
+    TarefaCarregamento* t = (TarefaCarregamento*)arg;
+    LoteAntenas* d = t->destino;
+    int n = t->local.numAntenas;
+    if (n == 0) {
+        return 0; // Bloco vazio: os buffers locais podem nem ter sido criados
+    }
+    memcpy(d->freq + t->posicao, t->local.freq, n);
+    memcpy(d->x + t->posicao, t->local.x, n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        d->y[t->posicao + i] = t->local.y[i] + t->linhaBase; // Linha relativa ao bloco -> linha do ficheiro
+    }
+    return 0;
+}
+
+/**
+ * \brief Executa func sobre todas as tarefas, uma thread por tarefa.
+ */
+static void ExecutarTarefas(TarefaCarregamento* tarefas, int numTarefas, thrd_start_t func) {
+    thrd_t* threads = (thrd_t*)malloc(numTarefas * sizeof(thrd_t));
+    bool* criada = (bool*)calloc(numTarefas, sizeof(bool));
+    for (int i = 1; i < numTarefas; i++) {
+        if (threads != NULL && criada != NULL && thrd_create(&threads[i], func, &tarefas[i]) == thrd_success) {
+            criada[i] = true;
+        }
+        else {
+            func(&tarefas[i]); // Sem thread: executa na thread atual
+        }
+    }
+    func(&tarefas[0]); // A thread atual trata do primeiro bloco
+    for (int i = 1; i < numTarefas; i++) {
+        if (criada != NULL && criada[i]) thrd_join(threads[i], NULL);
+    }
+    free(criada);
+    free(threads);
+}
+
+/**
+ * \brief Devolve o tamanho de um ficheiro aberto (64 bits também em Windows).
+ *
+ * \return Tamanho em bytes ou -1 em caso de erro.
+ */
+long long TamanhoFicheiro(FILE* ficheiro) {
+#ifdef _WIN32
+    struct _stat64 info;
+    return _fstat64(_fileno(ficheiro), &info) == 0 ? (long long)info.st_size : -1;
+#else
+    struct stat info;
+    return fstat(fileno(ficheiro), &info) == 0 ? (long long)info.st_size : -1;
+#endif
+}
+
+/**
+ * \brief Lê o ficheiro inteiro para memória.
+ *
+ * \return Buffer alocado ou NULL se ocorrer um erro.
+ */
+static char* LerFicheiroCompleto(const char* nomeFicheiro, size_t* tam) {
+    FILE* ficheiro = fopen(nomeFicheiro, "rb");
+    if (ficheiro == NULL) {
+        return NULL;
+    }
+    long long fim = TamanhoFicheiro(ficheiro);
+    char* buf = fim >= 0 && (unsigned long long)fim < SIZE_MAX ? (char*)malloc((size_t)fim + 1) : NULL;
+    if (buf != NULL && fread(buf, 1, (size_t)fim, ficheiro) != (size_t)fim) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(ficheiro);
+    *tam = buf != NULL ? (size_t)fim : 0;
+    return buf;
+}
+
+/**
+ * \brief Liberta os buffers locais das tarefas.
+ */
+static void LibertarTarefas(TarefaCarregamento* tarefas, int numTarefas) {
+    for (int i = 0; i < numTarefas; i++) {
+        free(tarefas[i].local.freq);
+        free(tarefas[i].local.x);
+        free(tarefas[i].local.y);
+    }
+    free(tarefas);
+}
+
+/**
+ * \brief Carrega um ficheiro de antenas em paralelo para um lote, pela ordem do ficheiro.
+ *
+ * O lote não é validado: as antenas fora do grid e as coordenadas repetidas
+ * são descartadas por InserirAntenasEmLote, que ordena e deduplica o lote de
+ * qualquer forma e mantém a primeira ocorrência no ficheiro.
+ *
+ * \param nomeFicheiro Nome do ficheiro a ser carregado.
+ * \param binario true para o formato de antenas.bin, false para o grid em texto.
+ * \param numThreads Número de threads a usar (0 ou negativo usa todos os processadores).
+ * \return Ponteiro para o lote ou NULL se ocorrer um erro ou faltar memória.
+ */
+LoteAntenas* CarregarLoteParalelo(const char* nomeFicheiro, bool binario, int numThreads) {
+    size_t tam;
+    char* buf = LerFicheiroCompleto(nomeFicheiro, &tam);
+    if (buf == NULL) {
+        return NULL;
+    }
+    if (numThreads <= 0) numThreads = NumeroProcessadores();
+    size_t porTarefa = tam / numThreads;
+    if (porTarefa < 4096) { // Blocos pequenos não compensam o custo das threads
+        numThreads = (int)(tam / 4096) + 1;
+        porTarefa = tam / numThreads;
+    }
+
+    TarefaCarregamento* tarefas = (TarefaCarregamento*)calloc(numThreads, sizeof(TarefaCarregamento));
+    if (tarefas == NULL) {
+        free(buf);
+        return NULL;
+    }
+    // Divide o buffer em blocos alinhados a linhas ou a registos
+    const char* fimBuf = buf + tam;
+    const char* p = buf;
+    for (int i = 0; i < numThreads; i++) {
+        tarefas[i].inicio = p;
+        tarefas[i].binario = binario;
+        if (i == numThreads - 1) {
+            p = fimBuf;
+        }
+        else if (binario) {
+            size_t registos = porTarefa / TAM_REGISTO_BIN;
+            p = (size_t)(fimBuf - p) > registos * TAM_REGISTO_BIN ? p + registos * TAM_REGISTO_BIN : fimBuf;
+        }
+        else {
+            const char* q = (size_t)(fimBuf - p) > porTarefa ? p + porTarefa : fimBuf;
+            while (q < fimBuf && *q != '\n') q++;
+            p = q < fimBuf ? q + 1 : fimBuf;
+        }
+        tarefas[i].fim = p;
+    }
+
+    ExecutarTarefas(tarefas, numThreads, ThreadAnalisar);
+    free(buf);
+
+    // Junção: posição de cada bloco no lote e primeira linha de cada bloco (TXT)
+    long long total = 0;
+    int linhaBase = 0;
+    bool ok = true;
+    for (int i = 0; i < numThreads; i++) {
+        ok = ok && !tarefas[i].semMemoria;
+        tarefas[i].posicao = (int)total;
+        tarefas[i].linhaBase = binario ? 0 : linhaBase;
+        total += tarefas[i].local.numAntenas;
+        linhaBase += tarefas[i].numLinhas;
+    }
+    LoteAntenas* lote = ok && total < INT32_MAX ? CriarLote((int)total) : NULL;
+    if (lote != NULL) {
+        lote->numAntenas = (int)total;
+        for (int i = 0; i < numThreads; i++) tarefas[i].destino = lote;
+        ExecutarTarefas(tarefas, numThreads, ThreadDistribuir);
+    }
+    LibertarTarefas(tarefas, numThreads);
+    return lote;
+}
+
+/**
+ * \brief Converte um lote numa lista só com as antenas que InserirAntenasEmLote aceita.
+ *
+ * As antenas fora do grid e as coordenadas repetidas (fica a primeira
+ * ocorrência) são descartadas, tal como em InserirAntena; as restantes
+ * mantêm a ordem do lote.
+ */
+static Antena* ListaValidadaDeLote(LoteAntenas* lote) {
+    if (lote == NULL) {
+        return NULL;
+    }
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    signed char* estado = (signed char*)malloc((size_t)lote->numAntenas + 1);
+    Antena* lista = NULL;
+    Antena* ultima = NULL;
+    if (a != NULL && estado != NULL && InserirAntenasEmLote(a, lote->freq, lote->x, lote->y, lote->numAntenas, estado) >= 0) {
+        for (int i = 0; i < lote->numAntenas; i++) {
+            if (estado[i] != 0) continue;
+            Antena* nova = CriarAntena(lote->freq[i], lote->x[i], lote->y[i]);
+            if (nova == NULL) break;
+            if (ultima == NULL) lista = nova;
+            else ultima->prox = nova;
+            ultima = nova;
+        }
+    }
+    free(estado);
+    DestruirArmazem(a);
+    return lista;
+}
+
+/**
+ * \brief Carrega as antenas de um ficheiro de texto usando várias threads.
+ *
+ * \param nomeFicheiro Nome do ficheiro de texto a ser carregado.
+ * \param numThreads Número de threads (0 usa todos os processadores).
+ * \return Ponteiro para o início da lista de antenas ou NULL se ocorrer um erro.
+ */
+Antena* CarregarAntenasDeTxtParalelo(const char* nomeFicheiro, int numThreads) {
+    LoteAntenas* lote = CarregarLoteParalelo(nomeFicheiro, false, numThreads);
+    Antena* lista = ListaValidadaDeLote(lote);
+    DestruirLote(lote);
+    return lista;
+}
+
+/**
+ * \brief Carrega as antenas de um ficheiro binário usando várias threads.
+ *
+ * \param nomeFicheiro Nome do ficheiro binário a ser carregado.
+ * \param numThreads Número de threads (0 usa todos os processadores).
+ * \return Ponteiro para o início da lista de antenas ou NULL se ocorrer um erro.
+ */
+Antena* CarregarAntenasDeBinParalelo(const char* nomeFicheiro, int numThreads) {
+    LoteAntenas* lote = CarregarLoteParalelo(nomeFicheiro, true, numThreads);
+    Antena* lista = ListaValidadaDeLote(lote);
+    DestruirLote(lote);
+    return lista;
+}
+#pragma endregion
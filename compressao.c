@@ -0,0 +1,497 @@
+/*****************************************************************//**
+ * \file   compressao.c
+ * \brief  Snapshots binários comprimidos (ordem de Morton + deltas LEB128).
+ *
+ * Formato do ficheiro:
+ *   cabeçalho  : magia "ANTZ", numRegistos, registosPorBloco, numBlocos (uint32)
+ *   índice     : numBlocos deslocamentos (uint64) relativos ao início dos dados
+ *   dados      : blocos de registos ordenados por (freq, código de Morton)
+ *
+ * Cada bloco começa com valores absolutos, para permitir acesso aleatório.
+ * Dentro do bloco cada registo guarda o delta da frequência e, se a
+ * frequência não mudou, o delta do código de Morton (senão o código absoluto),
+ * ambos como varints LEB128.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include "dados.h"
+#include "funcoes.h"
+#include <limits.h>
+
+#define SNAPSHOT_MAGIA 0x5A544E41u // "ANTZ" em little-endian
+
+/**
+ * \brief Registo intermédio usado para ordenar as antenas antes de comprimir.
+ */
+typedef struct RegistoSnapshot {
+    uint64_t morton;
+    char freq;
+} RegistoSnapshot;
+
+#pragma region Morton
+/**
+ * \brief Espalha os 32 bits de v pelas posições pares de um inteiro de 64 bits.
+ */
+static uint64_t EspalharBits(uint32_t v) {
+    uint64_t r = v;
+    r = (r | (r << 16)) & 0x0000FFFF0000FFFFull;
+    r = (r | (r << 8)) & 0x00FF00FF00FF00FFull;
+    r = (r | (r << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    r = (r | (r << 2)) & 0x3333333333333333ull;
+    r = (r | (r << 1)) & 0x5555555555555555ull;
+    return r;
+}
+
+/**
+ * \brief Operação inversa de EspalharBits.
+ */
+static uint32_t JuntarBits(uint64_t r) {
+    r &= 0x5555555555555555ull;
+    r = (r | (r >> 1)) & 0x3333333333333333ull;
+    r = (r | (r >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    r = (r | (r >> 4)) & 0x00FF00FF00FF00FFull;
+    r = (r | (r >> 8)) & 0x0000FFFF0000FFFFull;
+    r = (r | (r >> 16)) & 0x00000000FFFFFFFFull;
+    return (uint32_t)r;
+}
+
+/**
+ * \brief Calcula o código de Morton (ordem Z) de uma coordenada.
+ *
+ * \param x Coordenada x.
+ * \param y Coordenada y.
+ * \return Código de Morton com os bits de x nas posições pares e os de y nas ímpares.
+ */
+uint64_t CodigoMorton(uint32_t x, uint32_t y) {
+    return EspalharBits(x) | (EspalharBits(y) << 1);
+}
+
+/**
+ * \brief Obtém as coordenadas correspondentes a um código de Morton.
+ *
+ * \param m Código de Morton.
+ * \param x Ponteiro onde é guardada a coordenada x.
+ * \param y Ponteiro onde é guardada a coordenada y.
+ */
+void DescodificarMorton(uint64_t m, uint32_t* x, uint32_t* y) {
+    *x = JuntarBits(m);
+    *y = JuntarBits(m >> 1);
+}
+#pragma endregion
+
+#pragma region Varints
+/**
+ * \brief Escreve um inteiro sem sinal em formato LEB128.
+ *
+ * \return Número de bytes escritos em buf (no máximo 10).
+ */
+int EscreverVarint(uint8_t* buf, uint64_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * \brief Lê um inteiro LEB128 de buf, sem ultrapassar fim.
+ *
+ * \return Ponteiro para o byte seguinte ou NULL se o varint estiver truncado.
+ */
+const uint8_t* LerVarint(const uint8_t* buf, const uint8_t* fim, uint64_t* v) {
+    uint64_t r = 0;
+    int desloc = 0;
+    while (buf < fim && desloc < 64) {
+        uint8_t b = *buf++;
+        r |= (uint64_t)(b & 0x7F) << desloc;
+        if ((b & 0x80) == 0) {
+            *v = r;
+            return buf;
+        }
+        desloc += 7;
+    }
+    return NULL;
+}
+#pragma endregion
+
+#pragma region Snapshot
+/**
+ * \brief Compara registos por frequência e depois por código de Morton.
+ */
+static int CompararRegistos(const void* a, const void* b) {
+    const RegistoSnapshot* ra = (const RegistoSnapshot*)a;
+    const RegistoSnapshot* rb = (const RegistoSnapshot*)b;
+    if ((unsigned char)ra->freq != (unsigned char)rb->freq) {
+        return (unsigned char)ra->freq < (unsigned char)rb->freq ? -1 : 1;
+    }
+    if (ra->morton != rb->morton) {
+        return ra->morton < rb->morton ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief Ordena os registos e escreve o snapshot comprimido.
+ *
+ * \param nomeFicheiro Nome do ficheiro de destino.
+ * \param regs Registos a escrever (são reordenados).
+ * \param n Número de registos.
+ * \return true se o ficheiro foi escrito, false caso contrário.
+ */
+static bool EscreverSnapshot(const char* nomeFicheiro, RegistoSnapshot* regs, int n) {
+    qsort(regs, n, sizeof(RegistoSnapshot), CompararRegistos);
+
+    uint32_t porBloco = SNAPSHOT_REGISTOS_POR_BLOCO;
+    uint32_t numBlocos = (uint32_t)((n + porBloco - 1) / porBloco);
+    uint64_t* indice = (uint64_t*)malloc((numBlocos + 1) * sizeof(uint64_t));
+    uint8_t* dados = (uint8_t*)malloc((size_t)n * 11 + 1); // pior caso: 1 + 10 bytes por registo
+    if (indice == NULL || dados == NULL) {
+        free(indice);
+        free(dados);
+        return false;
+    }
+
+    size_t tam = 0;
+    char freqAnt = 0;
+    uint64_t mortonAnt = 0;
+    for (int i = 0; i < n; i++) {
+        if (i % porBloco == 0) { // Início de bloco: valores absolutos
+            indice[i / porBloco] = tam;
+            freqAnt = 0;
+            mortonAnt = 0;
+        }
+        uint64_t deltaFreq = (uint64_t)((unsigned char)regs[i].freq - (unsigned char)freqAnt);
+        tam += EscreverVarint(dados + tam, deltaFreq);
+        if (deltaFreq == 0 && i % porBloco != 0) {
+            tam += EscreverVarint(dados + tam, regs[i].morton - mortonAnt);
+        }
+        else {
+            tam += EscreverVarint(dados + tam, regs[i].morton);
+        }
+        freqAnt = regs[i].freq;
+        mortonAnt = regs[i].morton;
+    }
+
+    FILE* ficheiro = fopen(nomeFicheiro, "wb");
+    if (ficheiro == NULL) {
+        free(indice);
+        free(dados);
+        return false;
+    }
+    uint32_t cabecalho[4] = { SNAPSHOT_MAGIA, (uint32_t)n, porBloco, numBlocos };
+    bool ok = fwrite(cabecalho, sizeof(uint32_t), 4, ficheiro) == 4 &&
+        fwrite(indice, sizeof(uint64_t), numBlocos, ficheiro) == numBlocos &&
+        fwrite(dados, 1, tam, ficheiro) == tam;
+    ESTAT_FICHEIRO(ficheiro);
+    fclose(ficheiro);
+    free(indice);
+    free(dados);
+    return ok;
+}
+
+/**
+ * \brief Descodifica um bloco de registos a partir de um buffer em memória.
+ *
+ * \param ini Início do bloco.
+ * \param fim Fim dos dados disponíveis.
+ * \param n Número de registos do bloco.
+ * \param freq Vetor de saída com as frequências.
+ * \param x Vetor de saída com as coordenadas x.
+ * \param y Vetor de saída com as coordenadas y.
+ * \return true se o bloco foi descodificado, false se os dados estiverem corrompidos.
+ */
+static bool DescodificarBloco(const uint8_t* ini, const uint8_t* fim, int n, char* freq, int* x, int* y) {
+    const uint8_t* p = ini;
+    unsigned char freqAnt = 0;
+    uint64_t mortonAnt = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t deltaFreq, valor;
+        p = LerVarint(p, fim, &deltaFreq);
+        if (p == NULL) return false;
+        p = LerVarint(p, fim, &valor);
+        if (p == NULL) return false;
+        freqAnt = (unsigned char)(freqAnt + deltaFreq);
+        mortonAnt = (deltaFreq == 0 && i != 0) ? mortonAnt + valor : valor;
+        uint32_t ux, uy;
+        DescodificarMorton(mortonAnt, &ux, &uy);
+        freq[i] = (char)freqAnt;
+        x[i] = (int)ux;
+        y[i] = (int)uy;
+    }
+    return true;
+}
+
+/**
+ * \brief Posiciona um ficheiro num deslocamento de 64 bits (também em Windows).
+ */
+static bool PosicionarFicheiro(FILE* ficheiro, long long pos) {
+#ifdef _WIN32
+    return _fseeki64(ficheiro, pos, SEEK_SET) == 0;
+#else
+    return fseeko(ficheiro, (off_t)pos, SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * \brief Verifica a coerência do cabeçalho de um snapshot.
+ *
+ * O número de registos tem de caber num int, os registos por bloco não podem
+ * exceder SNAPSHOT_REGISTOS_POR_BLOCO e o número de blocos tem de ser
+ * exatamente o necessário para os registos.
+ */
+static bool CabecalhoValido(const uint32_t* cabecalho) {
+    uint32_t porBloco = cabecalho[2];
+    return cabecalho[0] == SNAPSHOT_MAGIA && cabecalho[1] <= INT_MAX &&
+        porBloco > 0 && porBloco <= SNAPSHOT_REGISTOS_POR_BLOCO &&
+        cabecalho[3] == (uint32_t)(((uint64_t)cabecalho[1] + porBloco - 1) / porBloco);
+}
+
+/**
+ * \brief Lê o cabeçalho, o índice e os dados de um snapshot comprimido.
+ *
+ * \param nomeFicheiro Nome do ficheiro.
+ * \param cabecalho Vetor de 4 posições para o cabeçalho.
+ * \param indice Ponteiro onde é devolvido o índice de blocos (alocado).
+ * \param dados Ponteiro onde são devolvidos os dados (alocados).
+ * \param tamDados Ponteiro onde é devolvido o tamanho dos dados.
+ * \return true se a leitura foi bem-sucedida, false caso contrário.
+ */
+static bool LerSnapshot(const char* nomeFicheiro, uint32_t* cabecalho, uint64_t** indice, uint8_t** dados, size_t* tamDados) {
+    FILE* ficheiro = fopen(nomeFicheiro, "rb");
+    if (ficheiro == NULL) {
+        return false;
+    }
+    *indice = NULL;
+    *dados = NULL;
+    if (fread(cabecalho, sizeof(uint32_t), 4, ficheiro) != 4 || !CabecalhoValido(cabecalho)) {
+        fclose(ficheiro);
+        return false;
+    }
+    long long inicioDados = (long long)(4 * sizeof(uint32_t) + (uint64_t)cabecalho[3] * sizeof(uint64_t));
+    long long fimFicheiro = TamanhoFicheiro(ficheiro);
+    if (fimFicheiro < inicioDados || (unsigned long long)(fimFicheiro - inicioDados) >= SIZE_MAX) {
+        fclose(ficheiro);
+        return false;
+    }
+
+    *tamDados = (size_t)(fimFicheiro - inicioDados);
+    *indice = (uint64_t*)malloc((cabecalho[3] + 1) * sizeof(uint64_t));
+    *dados = (uint8_t*)malloc(*tamDados + 1);
+    bool ok = *indice != NULL && *dados != NULL &&
+        fread(*indice, sizeof(uint64_t), cabecalho[3], ficheiro) == cabecalho[3] &&
+        fread(*dados, 1, *tamDados, ficheiro) == *tamDados;
+    fclose(ficheiro);
+    if (!ok) {
+        free(*indice);
+        free(*dados);
+    }
+    return ok;
+}
+
+/**
+ * \brief Descodifica todos os registos de um snapshot para vetores alocados.
+ *
+ * \return Número de registos lidos ou -1 em caso de erro.
+ */
+static int DescodificarSnapshot(const char* nomeFicheiro, char** freq, int** x, int** y) {
+    uint32_t cabecalho[4];
+    uint64_t* indice;
+    uint8_t* dados;
+    size_t tamDados;
+    if (!LerSnapshot(nomeFicheiro, cabecalho, &indice, &dados, &tamDados)) {
+        return -1;
+    }
+    int n = (int)cabecalho[1];
+    *freq = (char*)malloc(n + 1);
+    *x = (int*)malloc((n + 1) * sizeof(int));
+    *y = (int*)malloc((n + 1) * sizeof(int));
+    bool ok = *freq != NULL && *x != NULL && *y != NULL;
+    for (uint32_t b = 0; ok && b < cabecalho[3]; b++) {
+        int primeiro = (int)(b * cabecalho[2]);
+        int quantos = n - primeiro < (int)cabecalho[2] ? n - primeiro : (int)cabecalho[2];
+        // O bloco acaba onde começa o seguinte (o último no fim dos dados)
+        uint64_t fimBloco = b + 1 < cabecalho[3] ? indice[b + 1] : (uint64_t)tamDados;
+        ok = indice[b] <= fimBloco && fimBloco <= tamDados &&
+            DescodificarBloco(dados + indice[b], dados + fimBloco, quantos, *freq + primeiro, *x + primeiro, *y + primeiro);
+    }
+    free(indice);
+    free(dados);
+    if (!ok) {
+        free(*freq);
+        free(*x);
+        free(*y);
+        return -1;
+    }
+    return n;
+}
+
+/**
+ * \brief Salva a lista de antenas num snapshot comprimido.
+ *
+ * \param lista Ponteiro para o início da lista de antenas.
+ * \param nomeFicheiro Nome do ficheiro onde as antenas serão salvas.
+ * \return true se o salvamento foi bem-sucedido, false caso contrário.
+ */
+bool SalvarAntenasComprimidas(Antena* lista, const char* nomeFicheiro) {
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    int n = 0;
+    for (Antena* a = lista; a != NULL; a = a->prox) n++;
+    RegistoSnapshot* regs = (RegistoSnapshot*)malloc((n + 1) * sizeof(RegistoSnapshot));
+    if (regs == NULL) {
+        return false;
+    }
+    int i = 0;
+    for (Antena* a = lista; a != NULL; a = a->prox, i++) {
+        regs[i].freq = a->freq;
+        regs[i].morton = CodigoMorton((uint32_t)a->x, (uint32_t)a->y);
+    }
+    bool ok = EscreverSnapshot(nomeFicheiro, regs, n);
+    free(regs);
+    ESTAT_FIM(nsSalvar, inicio);
+    return ok;
+}
+
+/**
+ * \brief Carrega as antenas de um snapshot comprimido.
+ *
+ * A lista resultante fica na ordem do snapshot (frequência e ordem Z).
+ *
+ * \param nomeFicheiro Nome do ficheiro a ser carregado.
+ * \return Ponteiro para o início da lista de antenas ou NULL se ocorrer um erro.
+ */
+Antena* CarregarAntenasComprimidas(const char* nomeFicheiro) {
+    char* freq;
+    int* x;
+    int* y;
+    int n = DescodificarSnapshot(nomeFicheiro, &freq, &x, &y);
+    if (n < 0) {
+        return NULL;
+    }
+    Antena* lista = NULL;
+    Antena* ultima = NULL;
+    for (int i = 0; i < n; i++) {
+        if ((unsigned)x[i] >= GRID_TAM || (unsigned)y[i] >= GRID_TAM) continue; // Ignora registos fora do grid (incluindo coordenadas negativas)
+        Antena* nova = CriarAntena(freq[i], x[i], y[i]);
+        if (nova == NULL) break;
+        if (ultima == NULL) lista = nova;
+        else ultima->prox = nova;
+        ultima = nova;
+    }
+    free(freq);
+    free(x);
+    free(y);
+    return lista;
+}
+
+/**
+ * \brief Salva um conjunto de antenas guardado em colunas num snapshot comprimido.
+ *
+ * \param nomeFicheiro Nome do ficheiro onde as antenas serão salvas.
+ * \param freq Coluna das frequências ('\0' indica uma posição a ignorar).
+ * \param x Coluna das coordenadas x.
+ * \param y Coluna das coordenadas y.
+ * \param n Número de posições das colunas.
+ * \return true se o salvamento foi bem-sucedido, false caso contrário.
+ */
+bool SalvarColunasComprimidas(const char* nomeFicheiro, const char* freq, const CoordAntena* x, const CoordAntena* y, int n) {
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    RegistoSnapshot* regs = (RegistoSnapshot*)malloc((n + 1) * sizeof(RegistoSnapshot));
+    if (regs == NULL) {
+        return false;
+    }
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (freq[i] == '\0') continue;
+        regs[k].freq = freq[i];
+        regs[k].morton = CodigoMorton((uint32_t)x[i], (uint32_t)y[i]);
+        k++;
+    }
+    bool ok = EscreverSnapshot(nomeFicheiro, regs, k);
+    free(regs);
+    ESTAT_FIM(nsSalvar, inicio);
+    return ok;
+}
+
+/**
+ * \brief Carrega um snapshot comprimido para um lote de antenas.
+ *
+ * \param nomeFicheiro Nome do ficheiro a ser carregado.
+ * \return Ponteiro para o lote ou NULL se ocorrer um erro.
+ */
+LoteAntenas* CarregarLoteComprimido(const char* nomeFicheiro) {
+    LoteAntenas* lote = (LoteAntenas*)calloc(1, sizeof(LoteAntenas));
+    if (lote == NULL) {
+        return NULL;
+    }
+    int n = DescodificarSnapshot(nomeFicheiro, &lote->freq, &lote->x, &lote->y);
+    if (n < 0) {
+        free(lote);
+        return NULL;
+    }
+    lote->numAntenas = n;
+    lote->capacidade = n + 1;
+    return lote;
+}
+
+/**
+ * \brief Lê um único bloco de um snapshot comprimido (acesso aleatório).
+ *
+ * Apenas o cabeçalho, a entrada do índice e o próprio bloco são lidos do disco.
+ *
+ * \param nomeFicheiro Nome do ficheiro.
+ * \param bloco Número do bloco a ler (a começar em 0).
+ * \param freq Vetor de saída com capacidade para SNAPSHOT_REGISTOS_POR_BLOCO frequências.
+ * \param x Vetor de saída com capacidade para SNAPSHOT_REGISTOS_POR_BLOCO coordenadas x.
+ * \param y Vetor de saída com capacidade para SNAPSHOT_REGISTOS_POR_BLOCO coordenadas y.
+ * \return Número de registos lidos ou -1 se o bloco não existir ou ocorrer um erro.
+ */
+int LerBlocoComprimido(const char* nomeFicheiro, int bloco, char* freq, int* x, int* y) {
+    FILE* ficheiro = fopen(nomeFicheiro, "rb");
+    if (ficheiro == NULL) {
+        return -1;
+    }
+    uint32_t cabecalho[4];
+    if (fread(cabecalho, sizeof(uint32_t), 4, ficheiro) != 4 || !CabecalhoValido(cabecalho) ||
+        bloco < 0 || (uint32_t)bloco >= cabecalho[3]) {
+        fclose(ficheiro);
+        return -1;
+    }
+    uint64_t desloc[2];
+    int numDesloc = (uint32_t)bloco + 1 < cabecalho[3] ? 2 : 1;
+    long long inicioDados = (long long)(4 * sizeof(uint32_t) + (uint64_t)cabecalho[3] * sizeof(uint64_t));
+    long long fimFicheiro = TamanhoFicheiro(ficheiro);
+    if (fimFicheiro < inicioDados || !PosicionarFicheiro(ficheiro, (long long)(4 * sizeof(uint32_t) + (size_t)bloco * sizeof(uint64_t))) ||
+        fread(desloc, sizeof(uint64_t), numDesloc, ficheiro) != (size_t)numDesloc) {
+        fclose(ficheiro);
+        return -1;
+    }
+    uint64_t tamDados = (uint64_t)(fimFicheiro - inicioDados);
+    if (numDesloc == 1) { // Último bloco: vai até ao fim do ficheiro
+        desloc[1] = tamDados;
+    }
+    if (desloc[1] < desloc[0] || desloc[1] > tamDados || desloc[1] - desloc[0] >= SIZE_MAX) {
+        fclose(ficheiro);
+        return -1;
+    }
+    size_t tam = (size_t)(desloc[1] - desloc[0]);
+    uint8_t* buf = (uint8_t*)malloc(tam + 1);
+    bool ok = buf != NULL && PosicionarFicheiro(ficheiro, inicioDados + (long long)desloc[0]) &&
+        fread(buf, 1, tam, ficheiro) == tam;
+    fclose(ficheiro);
+
+    int primeiro = bloco * (int)cabecalho[2];
+    int quantos = (int)cabecalho[1] - primeiro < (int)cabecalho[2] ? (int)cabecalho[1] - primeiro : (int)cabecalho[2];
+    ok = ok && DescodificarBloco(buf, buf + tam, quantos, freq, x, y);
+    free(buf);
+    return ok ? quantos : -1;
+}
+#pragma endregion
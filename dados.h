@@ -1,6 +1,6 @@
 /*****************************************************************//**
  * \file   dados.h
- * \brief  Declarao das estruturas de dados para antenas e efeitos nefastos.
+ * \brief  Declaração das estruturas de dados para antenas e efeitos nefastos.
  *
  * \author matos
  * \date   March 2025
@@ -13,6 +13,58 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <string.h>
+#include <stdint.h>
+
+#ifndef GRID_TAM
+#define GRID_TAM 10 // Dimensão do grid (pode ser redefinida na compilação)
+#endif
+
+#define SNAPSHOT_REGISTOS_POR_BLOCO 256 // Registos por bloco nos snapshots comprimidos
+#define REGIAO_TILE 64 // Lado dos tiles do índice de regiões
+
+// Modos do motor de efeitos
+#define EFEITOS_PONTOS 0     // Dois efeitos por par: 2a - b e 2b - a
+#define EFEITOS_HARMONICOS 1 // Todas as células do grid na reta do par
+#define GERADOR_BLOCO 1024   // Efeitos por bloco nos consumidores do gerador de efeitos
+
+// Janelas do grid (MostrarJanelaArmazem)
+#define JANELA_LARGURA 64            // Caracteres por linha da janela do menu
+#define JANELA_ALTURA 32             // Linhas da janela do menu
+#define JANELA_DENSIDADE ":-=+*%@"   // Blocos com 2-3, 4-7, 8-15, ... antenas
+
+// Imagens exportadas (ExportarImagemArmazem)
+#define IMAGEM_PGM 0      // Tons de cinzento (P5)
+#define IMAGEM_PPM 1      // Uma cor por frequência (P6)
+#define IMAGEM_FAIXA 256  // Linhas do grid lidas de cada vez dos baldes de Morton
+
+// Motor de bitboards: uma palavra de 64 bits por linha, usado automaticamente em grids pequenos
+#define BITBOARD_TAM 64
+#define MOTOR_BITBOARD (GRID_TAM <= BITBOARD_TAM)
+
+// Coordenadas compactas do armazém: 16 bits chegam para grids até 65535x65535
+#if GRID_TAM > 65535 || defined(ARMAZEM_COORD_32)
+typedef int32_t CoordAntena;
+#define COORD_ANTENA_MAX INT32_MAX
+#else
+typedef uint16_t CoordAntena;
+#define COORD_ANTENA_MAX 65535
+#endif
+
+// Frequências internadas no armazém: cada rótulo recebe um id denso (0..numFreqs-1) na primeira inserção.
+// Os rótulos continuam a ser um byte (TXT, BIN, snapshots, tiles, rastreios e protocolo); rótulos de 16 bits
+// exigem mudar esses formatos e ficam para um pedido à parte.
+#define FREQ_IDS 255 // Rótulos possíveis (o '\0' marca os slots livres)
+#define ID_FREQ(a, f) ((int)(a)->idDaFreq[(unsigned char)(f)] - 1) // Id do rótulo f (-1 se nunca foi inserido)
+
+// IDs dos vértices dos grafos sobre o armazém: slot + 1 nos bits baixos e a geração do slot nos bits altos
+#define VERTICE_BITS_SLOT 24
+#define VERTICE_MAX_SLOTS ((1 << VERTICE_BITS_SLOT) - 1) // Slots que podem ter vértices
+#define VERTICE_GERACOES 128 // Reutilizações de cada slot; depois da última o slot é retirado
+
+// Códigos de erro das inserções no armazém
+#define ARMAZEM_FORA_GRID -1
+#define ARMAZEM_DUPLICADA -2
+#define ARMAZEM_SEM_MEMORIA -3
 
  /**
   * \brief Estrutura que representa uma antena.
@@ -22,25 +74,17 @@
 typedef struct Antena {
 	char freq; 
 	int x, y; 
-	struct Antena* prox; // Ponteiro para a prxima antena
+	struct Antena* prox; // Ponteiro para a próxima antena
 } Antena;
 /**
- * \brief Estrutura que representa um efeito nefasto.
- */
- // Estrutura do Efeito Nefasto
-typedef struct EfeitoNefasto {
-	int x, y; 
-	struct EfeitoNefasto* prox;	// Ponteiro para o prximo efeito nefasto
-} EfeitoNefasto; 
-/**
- * \brief Estrutura que representa um vrtice do grafo.
+ * \brief Estrutura que representa um vértice do grafo.
  */
- // Estrutura do Vrtice
+ // Estrutura do Vértice
 typedef struct Vertice {
 	int id;
 	char freq;
 	int x, y;
-	struct Aresta* adjacentes; // Lista de arestas (adjacncias)
+	struct Aresta* adjacentes; // Lista de arestas (adjacências)
 	struct Vertice* prox;      
 } Vertice;
 /**
@@ -48,7 +92,7 @@ typedef struct Vertice {
  */
  // Estrutura da Aresta
 typedef struct Aresta {
-	int destino; // ID do vrtice de destino
+	int destino; // ID do vértice de destino
 	struct Aresta* prox;
 } Aresta;
 /**
@@ -57,6 +101,272 @@ typedef struct Aresta {
  // Estrutura do Grafo
 typedef struct GR {
 	int numVertices;
-	Vertice* inicio; // Ponteiro para o incio da lista de vrtices
+	Vertice* inicio; // Ponteiro para o início da lista de vértices
+	struct ArmazemAntenas* armazem; // Armazém partilhado quando o grafo é um índice sobre ele (NULL no modo de lista)
+	Aresta** adjacentes; // Adjacências indexadas pelo slot do armazém (o destino das arestas é slot + 1; ver IdVertice)
+	int capacidadeAdj;
+	bool interferencia; // Grafo derivado: arestas dirigidas dos membros de um par para as antenas atingidas pelos seus efeitos
+	unsigned long long versao; // Incrementada em cada alteração de vértices ou arestas
+	int raio; // 0: cada vértice liga ao anterior da mesma frequência; > 0: liga a todos os da mesma frequência a distância <= raio
+	int* anteriorFreq;  // Com raio 0: slot inserido antes com a mesma frequência (-1 se nenhum)
+	int* seguinteFreq;  // Com raio 0: slot inserido depois com a mesma frequência (-1 se nenhum)
+	int ultimoFreq[FREQ_IDS]; // Com raio 0: último slot inserido de cada id de frequência (-1 se nenhum)
 } GR;
+/**
+ * \brief Lote de antenas em vetores paralelos (usado nos carregamentos em massa).
+ */
+ // Estrutura do Lote de Antenas
+typedef struct LoteAntenas {
+	int numAntenas;
+	int capacidade;
+	char* freq;
+	int* x;
+	int* y;
+} LoteAntenas;
+/**
+ * \brief Balde de uma frequência com as antenas por ordem de código de Morton.
+ */
+ // Estrutura do Balde de Morton
+typedef struct BaldeMorton {
+	int numAntenas;
+	int capacidade;
+	uint64_t* morton; // Códigos de Morton por ordem crescente
+	int* slot;        // Slot do armazém correspondente a cada código
+} BaldeMorton;
+/**
+ * \brief Conjunto de efeitos nefastos em bitset (um bit por célula).
+ */
+ // Estrutura do Conjunto de Efeitos
+typedef struct ConjuntoEfeitos {
+	int largura, altura;
+	int palavrasLinha; // Palavras de 64 bits por linha
+	uint64_t* bits;
+} ConjuntoEfeitos;
+/**
+ * \brief Motor de bitboards: camadas de frequência com uma palavra por linha.
+ */
+ // Estrutura do Motor de Bitboards
+typedef struct MotorBitboard {
+	int largura, altura;
+	uint64_t mascara;                  // Bits das colunas do grid
+	uint64_t ocupacao[BITBOARD_TAM];   // União de todas as camadas
+	int numCamadas;
+	uint64_t (*camadas)[BITBOARD_TAM]; // Uma bitboard por id de frequência do armazém
+	char freqCamada[FREQ_IDS];         // Frequência de cada camada
+} MotorBitboard;
+/**
+ * \brief Ids densos das frequências de antenas fora do armazém (colunas, listas e tiles).
+ */
+ // Estrutura da Tabela de Frequências
+typedef struct TabelaFrequencias {
+	uint8_t idDaFreq[256]; // Id + 1 de cada rótulo (0 se ainda não apareceu)
+	int numFreqs;          // Ids atribuídos (0..numFreqs-1, por ordem de aparecimento)
+} TabelaFrequencias;
+/**
+ * \brief Gerador de efeitos nefastos (estado para retomar a geração aos blocos).
+ */
+ // Estrutura do Gerador de Efeitos
+typedef struct GeradorEfeitos {
+	const CoordAntena* x;
+	const CoordAntena* y;
+	int* ordem;        // Posições das antenas agrupadas por id de frequência
+	int* inicio;       // Início de cada id em ordem (numFreqs + 1 posições)
+	int numFreqs;      // Ids de frequência distintos
+	int freqAtual;     // Id em curso
+	int i, k;          // Par em curso (relativo ao início do id)
+} GeradorEfeitos;
+/**
+ * \brief Índice de regiões: contagens de antenas e de efeitos por tile.
+ */
+ // Estrutura do Índice de Regiões
+typedef struct IndiceRegioes {
+	int largura, altura;
+	int tilesX, tilesY;
+	int* fenwickAntenas;  // Árvore de Fenwick 2D com as antenas por tile
+	int* fenwickEfeitos;  // Árvore de Fenwick 2D com as células com efeito por tile
+	int palavrasLinha;    // Palavras de 64 bits por linha dos mapas de bits
+	uint64_t* bitsAntenas; // Células com antena (um bit por célula), para as bordas parciais das consultas
+	uint64_t* bitsEfeitos; // Células com efeito (um bit por célula)
+	uint64_t* chaves;     // Mapa célula -> multiplicidade do efeito (0 indica entrada vazia)
+	uint32_t* contagens;
+	int tamMapa;          // Tamanho do mapa (potência de 2)
+	int numEfeitos;       // Células com efeito dentro do grid
+} IndiceRegioes;
+/**
+ * \brief Armazém colunar de antenas, partilhado pela lista de antenas e pelo grafo.
+ */
+ // Estrutura do Armazém de Antenas
+typedef struct ArmazemAntenas {
+	int numAntenas;  // Antenas ativas
+	int numSlots;    // Slots usados (ativos e removidos)
+	int capacidade;
+	char* freq;      // Coluna das frequências ('\0' indica slot livre)
+	CoordAntena* x;  // Coluna das coordenadas x (nos slots livres guarda a lista de livres)
+	CoordAntena* y;  // Coluna das coordenadas y
+	uint8_t* geracao; // Coluna das gerações (incrementada sempre que o slot é libertado)
+	int livre;       // Primeiro slot da lista de slots livres (-1 se vazia)
+	int numLivres;
+	int* tabela;     // Tabela de dispersão coordenada -> slot
+	int tamTabela;   // Tamanho da tabela (potência de 2)
+	int ocupadosTabela; // Entradas ocupadas ou removidas da tabela
+	int largura, altura;
+	int numFreqs;              // Frequências internadas (os ids nunca são reutilizados)
+	char freqDoId[FREQ_IDS];   // Rótulo de cada id
+	uint8_t idDaFreq[256];     // Id + 1 de cada rótulo (0 se o rótulo nunca foi inserido)
+	bool ordemMorton;          // Mantém os baldes de frequência em ordem de Morton
+	BaldeMorton* baldes[FREQ_IDS]; // Baldes por id de frequência (só com ordemMorton)
+	IndiceRegioes* regioes;    // Índice de regiões (NULL se não estiver ativo)
+	unsigned long long versao; // Incrementada em cada alteração das antenas
+	ConjuntoEfeitos* cacheEfeitos[2];           // Efeitos por modo (EFEITOS_PONTOS, EFEITOS_HARMONICOS)
+	unsigned long long versaoCacheEfeitos[2];   // Versão do armazém em que cada conjunto foi calculado
+} ArmazemAntenas;
+/**
+ * \brief Contadores e tempos de instrumentação das operações principais.
+ *
+ * Só são atualizados quando o programa é compilado com ESTATISTICAS definido;
+ * sem ele as macros ESTAT_* não geram código. Os contadores não são atómicos
+ * (as threads do carregamento paralelo não os atualizam).
+ */
+ // Estrutura das Estatísticas
+typedef struct Estatisticas {
+	unsigned long long operacoes;        // Inserções, remoções, cálculos de efeitos, salvamentos e procuras
+	unsigned long long alocacoes;        // Nós e blocos alocados
+	unsigned long long procurasLista;    // Chamadas de InserirAntena e EncontrarVerticePorId
+	unsigned long long nosPercorridos;   // Nós de lista percorridos nessas chamadas
+	unsigned long long paresExaminados;  // Pares comparados no cálculo dos efeitos
+	unsigned long long paresMesmaFreq;   // Pares de antenas com a mesma frequência
+	unsigned long long bytesEscritos;    // Bytes escritos pelos salvamentos e exportações
+	unsigned long long procurasGrafo;    // Procuras em largura e em profundidade
+	unsigned long long verticesVisitados;
+	unsigned long long fronteiraMaxBFS;  // Maior fila da procura em largura
+	unsigned long long fronteiraMaxDFS;  // Maior pilha (ou profundidade de recursão) da procura em profundidade
+	unsigned long long tilesMapeados;    // Tiles mapeados pela cache do armazém em disco
+	unsigned long long efeitosAdiados;   // Efeitos aplicados fora do tile do par que os gerou
+	unsigned long long nsEfeitos;        // Tempo no cálculo dos efeitos
+	unsigned long long nsSalvar;         // Tempo nos salvamentos
+	unsigned long long nsProcuras;       // Tempo nas procuras no grafo
+} Estatisticas;
+
+extern Estatisticas estatisticas;
+
+#ifdef ESTATISTICAS
+#define ESTAT_SOMAR(campo, v) (estatisticas.campo += (unsigned long long)(v))
+#define ESTAT_MAXIMO(campo, v) do { if ((unsigned long long)(v) > estatisticas.campo) estatisticas.campo = (unsigned long long)(v); } while (0)
+#define ESTAT_INICIO(t) unsigned long long t = RelogioNs()
+#define ESTAT_FIM(campo, t) ESTAT_SOMAR(campo, RelogioNs() - (t))
+#define ESTAT_FICHEIRO(f) RegistarBytesEscritos(f)
+#define ESTAT_PARES_BALDES(inicio, n) ContarParesBaldes(inicio, n)
+#else
+#define ESTAT_SOMAR(campo, v) ((void)0)
+#define ESTAT_MAXIMO(campo, v) ((void)0)
+#define ESTAT_INICIO(t) ((void)0)
+#define ESTAT_FIM(campo, t) ((void)0)
+#define ESTAT_FICHEIRO(f) ((void)0)
+#define ESTAT_PARES_BALDES(inicio, n) ((void)0)
+#endif
+
+// Operações dos rastreios de sessões (capturados no main e reproduzidos offline)
+#define RASTREIO_ANTENA_INICIAL 0    // freq, x, y (conteúdo do armazém no início da sessão)
+#define RASTREIO_INSERIR_ANTENA 1    // freq, x, y
+#define RASTREIO_REMOVER_ANTENA 2    // freq, x, y
+#define RASTREIO_LISTAR 3            // modo
+#define RASTREIO_CONSULTAR_REGIAO 4  // x0, y0, x1, y1
+#define RASTREIO_CAUSAS 5            // x, y
+#define RASTREIO_MAIS_PROXIMAS 6     // freq, x, y, k
+#define RASTREIO_INSERIR_VERTICE 7   // freq, x, y
+#define RASTREIO_REMOVER_VERTICE 8   // id
+#define RASTREIO_MOSTRAR_GRAFO 9     // modo
+#define RASTREIO_MOSTRAR_VERTICES 10
+#define RASTREIO_DFS 11              // id
+#define RASTREIO_BFS 12              // id
+#define RASTREIO_LIGAR_RAIO 13       // raio
+#define RASTREIO_INTERFERENCIA 14
+#define RASTREIO_SALVAR 15
+#define RASTREIO_JANELA 16           // x0, y0, fator, modo
+#define RASTREIO_TIPOS 17
+/**
+ * \brief Operação de um rastreio (tipo, frequência e até quatro argumentos inteiros).
+ */
+ // Estrutura da Operação de Rastreio
+typedef struct OperacaoRastreio {
+	int tipo;
+	char freq;
+	int args[4];
+} OperacaoRastreio;
+/**
+ * \brief Rastreio aberto para escrita.
+ */
+ // Estrutura do Rastreio
+typedef struct Rastreio {
+	FILE* ficheiro;
+	long long numOperacoes;
+} Rastreio;
+
+#define VERSOES_MAX_LEITORES 64 // Threads leitoras registadas em simultâneo num publicador de versões
+/**
+ * \brief Versão imutável do armazém e do grafo, partilhada com leitores concorrentes.
+ */
+ // Estrutura da Versão do Armazém
+typedef struct VersaoArmazem {
+	ArmazemAntenas* armazem;     // Cópia das colunas (CopiarArmazem)
+	GR* grafo;                   // Cópia do grafo sobre a cópia do armazém (NULL se não foi publicado grafo)
+	unsigned long long numero;   // Número da versão (1, 2, ...)
+	unsigned long long epocaRetirada; // Época em que deixou de ser a versão atual
+	struct VersaoArmazem* proxRetirada;
+} VersaoArmazem;
+typedef struct PublicadorVersoes PublicadorVersoes; // Definido em versoes.c (usa atómicos C11)
+
+#define FRAGMENTOS_MAX 256  // Máximo de fragmentos de um armazém fragmentado
+#define FRAGMENTO_BLOCO 16  // Lado dos blocos de células atribuídos a cada fragmento
+typedef struct ArmazemFragmentado ArmazemFragmentado; // Definido em fragmentos.c (usa locks C11)
+
+#define TILES_LADO 4096           // Lado dos tiles do armazém em disco (potência de 2)
+#define TILES_CACHE 16            // Tiles mapeados em simultâneo (cache LRU)
+#define TILES_ADIADOS (1 << 20)   // Efeitos adiados antes de serem aplicados aos tiles de destino
+typedef struct ArmazemTiles ArmazemTiles; // Definido em tiles.c (mapeia os ficheiros em memória)
+
+// Pedidos do protocolo do servidor (servidor/servidor.c); argumentos entre parênteses
+#define PEDIDO_INFO 0       // () -> antenas, largura, altura, versão do armazém
+#define PEDIDO_INSERIR 1    // (freq, x, y) -> ID do vértice
+#define PEDIDO_REMOVER 2    // (x, y)
+#define PEDIDO_PROCURAR 3   // (x, y) -> frequência
+#define PEDIDO_EFEITOS 4    // () -> células com efeito, antenas
+#define PEDIDO_REGIAO 5     // (x0, y0, x1, y1) -> antenas, células com efeito
+#define PEDIDO_BFS 6        // (x, y) -> visitados, IDs (no máximo PROTOCOLO_MAX_VISITADOS)
+#define PEDIDO_DFS 7        // (x, y) -> visitados, IDs (no máximo PROTOCOLO_MAX_VISITADOS)
+#define PEDIDO_SALVAR 8     // () -> antenas gravadas (prefixo.bin, .txt e .zbin do servidor, a partir da versão publicada)
+#define PEDIDO_TIPOS 9
 
+#define RESPOSTA_OK 0
+#define RESPOSTA_INVALIDO 1     // Pedido mal formado
+#define RESPOSTA_NAO_EXISTE 2   // Antena ou vértice inexistente
+#define RESPOSTA_DUPLICADA 3
+#define RESPOSTA_FORA_GRID 4
+#define RESPOSTA_SEM_MEMORIA 5
+
+#define PROTOCOLO_MAX_VISITADOS 1024
+#define PROTOCOLO_MAX_VALORES (PROTOCOLO_MAX_VISITADOS + 4)
+#define PROTOCOLO_MAX_PEDIDO 32                                   // Bytes de um pedido codificado
+#define PROTOCOLO_MAX_RESPOSTA (16 + 10 * PROTOCOLO_MAX_VALORES) // Bytes de uma resposta codificada
+/**
+ * \brief Pedido ao servidor (o id é devolvido na resposta para emparelhar pedidos em pipeline).
+ */
+ // Estrutura do Pedido
+typedef struct PedidoServidor {
+	int tipo;
+	char freq;
+	uint32_t id;
+	int args[4];
+	bool invalido; // Algum argumento não cabe num int (resposta RESPOSTA_INVALIDO)
+} PedidoServidor;
+/**
+ * \brief Resposta do servidor a um pedido.
+ */
+ // Estrutura da Resposta
+typedef struct RespostaServidor {
+	int estado;   // RESPOSTA_*
+	uint32_t id;  // Id do pedido
+	int numValores;
+	long long valores[PROTOCOLO_MAX_VALORES];
+} RespostaServidor;
+typedef struct ServidorAntenas ServidorAntenas; // Definido em protocolo.c (usa locks e versões)
@@ -0,0 +1,502 @@
+/*****************************************************************//**
+ * \file   efeitos.c
+ * \brief  Conjunto de efeitos nefastos em bitset e modos do motor de efeitos.
+ *
+ * O conjunto de efeitos guarda um bit por célula do grid (linhas alinhadas
+ * a palavras de 64 bits). Além do modo original (dois efeitos por par, em
+ * 2a - b e 2b - a), existe o modo de harmónicos, em que todas as células do
+ * grid sobre a reta do par, em múltiplos inteiros do passo reduzido
+ * (dx / mdc, dy / mdc), ficam afetadas.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#pragma region Conjunto de efeitos
+/**
+ * \brief Número de bits a 1 numa palavra (sem depender de intrínsecos do compilador).
+ */
+int ContarBits(uint64_t v) {
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((v * 0x0101010101010101ull) >> 56);
+}
+
+/**
+ * \brief Índice do bit a 1 menos significativo (v != 0), por multiplicação de De Bruijn.
+ */
+int IndiceBitMenor(uint64_t v) {
+    static const int tabela[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+    };
+    return tabela[((v & (0 - v)) * 0x03F79D71B4CB0A89ull) >> 58];
+}
+
+/**
+ * \brief Cria um conjunto de efeitos vazio para um grid.
+ *
+ * \param largura Largura do grid.
+ * \param altura Altura do grid.
+ * \return Ponteiro para o conjunto ou NULL se faltar memória.
+ */
+ConjuntoEfeitos* CriarConjuntoEfeitos(int largura, int altura) {
+    if (largura <= 0 || altura <= 0) {
+        return NULL;
+    }
+    ConjuntoEfeitos* c = (ConjuntoEfeitos*)malloc(sizeof(ConjuntoEfeitos));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->largura = largura;
+    c->altura = altura;
+    c->palavrasLinha = (largura + 63) / 64;
+    c->bits = (uint64_t*)calloc((size_t)c->palavrasLinha * altura, sizeof(uint64_t));
+    if (c->bits == NULL) {
+        free(c);
+        return NULL;
+    }
+    ESTAT_SOMAR(alocacoes, 2);
+    return c;
+}
+
+/**
+ * \brief Destrói um conjunto de efeitos.
+ *
+ * \return true se o conjunto foi destruído, false se era NULL.
+ */
+bool DestruirConjuntoEfeitos(ConjuntoEfeitos* c) {
+    if (c == NULL) {
+        return false;
+    }
+    free(c->bits);
+    free(c);
+    return true;
+}
+
+/**
+ * \brief Marca uma célula com efeito (células fora do grid são ignoradas).
+ */
+void MarcarEfeito(ConjuntoEfeitos* c, int x, int y) {
+    if (x >= 0 && x < c->largura && y >= 0 && y < c->altura) {
+        c->bits[(size_t)y * c->palavrasLinha + (x >> 6)] |= 1ull << (x & 63);
+    }
+}
+
+/**
+ * \brief Indica se uma célula tem efeito.
+ */
+bool TemEfeito(const ConjuntoEfeitos* c, int x, int y) {
+    if (x < 0 || x >= c->largura || y < 0 || y >= c->altura) {
+        return false;
+    }
+    return (c->bits[(size_t)y * c->palavrasLinha + (x >> 6)] >> (x & 63)) & 1;
+}
+
+/**
+ * \brief Conta as células com efeito.
+ */
+long long ContarConjuntoEfeitos(const ConjuntoEfeitos* c) {
+    long long total = 0;
+    size_t n = (size_t)c->palavrasLinha * c->altura;
+    for (size_t i = 0; i < n; i++) {
+        total += ContarBits(c->bits[i]);
+    }
+    return total;
+}
+#pragma endregion
+
+#pragma region Harmónicos
+static int Mdc(int a, int b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    while (b != 0) {
+        int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static int DivisaoChao(int a, int b) {
+    int q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+/**
+ * \brief Restringe [tmin, tmax] aos t com 0 <= origem + t * passo < limite.
+ */
+static void RestringirParametro(int origem, int passo, int limite, long long* tmin, long long* tmax) {
+    if (passo == 0) {
+        if (origem < 0 || origem >= limite) *tmax = *tmin - 1;
+        return;
+    }
+    // origem + t * passo >= 0 e origem + t * passo <= limite - 1
+    int a = DivisaoChao(-origem, passo);
+    int b = DivisaoChao(limite - 1 - origem, passo);
+    long long lo, hi;
+    if (passo > 0) {
+        lo = (-origem % passo == 0) ? a : a + 1; // teto de -origem / passo
+        hi = b;
+    }
+    else {
+        lo = ((limite - 1 - origem) % passo == 0) ? b : b + 1;
+        hi = a;
+    }
+    if (lo > *tmin) *tmin = lo;
+    if (hi < *tmax) *tmax = hi;
+}
+
+/**
+ * \brief Marca todas as células do grid na reta de (xa, ya) para (xb, yb).
+ *
+ * Os pontos são (xa, ya) + t * (dx / mdc, dy / mdc) para t inteiro. O
+ * intervalo de t dentro do grid é calculado analiticamente, pelo que o
+ * custo é proporcional às células marcadas.
+ *
+ * \return Número de células marcadas (com repetições).
+ */
+int RasterizarReta(ConjuntoEfeitos* c, int xa, int ya, int xb, int yb) {
+    int dx = xb - xa, dy = yb - ya;
+    int g = Mdc(dx, dy);
+    if (g == 0) {
+        return 0; // Mesma posição: sem reta
+    }
+    int sx = dx / g, sy = dy / g;
+    long long tmin = -(long long)c->largura - c->altura, tmax = (long long)c->largura + c->altura;
+    RestringirParametro(xa, sx, c->largura, &tmin, &tmax);
+    RestringirParametro(ya, sy, c->altura, &tmin, &tmax);
+    int marcadas = 0;
+    for (long long t = tmin; t <= tmax; t++) {
+        int x = (int)(xa + t * sx), y = (int)(ya + t * sy);
+        c->bits[(size_t)y * c->palavrasLinha + (x >> 6)] |= 1ull << (x & 63);
+        marcadas++;
+    }
+    return marcadas;
+}
+#pragma endregion
+
+#pragma region Motor de efeitos
+/**
+ * \brief Calcula o conjunto de efeitos do armazém no modo indicado.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param modo EFEITOS_PONTOS ou EFEITOS_HARMONICOS.
+ * \return Ponteiro para o conjunto (a destruir pelo chamador) ou NULL se faltar memória.
+ */
+ConjuntoEfeitos* CalcularConjuntoEfeitos(const ArmazemAntenas* a, int modo) {
+    if (a == NULL) {
+        return NULL;
+    }
+    ConjuntoEfeitos* c = CriarConjuntoEfeitos(a->largura, a->altura);
+    if (c == NULL) {
+        return NULL;
+    }
+    // Agrupa os slots por frequência (contagem)
+    int inicio[FREQ_IDS + 1] = { 0 };
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') inicio[a->idDaFreq[(unsigned char)a->freq[s]]]++; // Id + 1
+    }
+    for (int f = 0; f < a->numFreqs; f++) inicio[f + 1] += inicio[f];
+    ESTAT_PARES_BALDES(inicio, a->numFreqs);
+    int* ordem = (int*)malloc(((size_t)inicio[a->numFreqs] + 1) * sizeof(int));
+    if (ordem == NULL) {
+        DestruirConjuntoEfeitos(c);
+        return NULL;
+    }
+    int pos[FREQ_IDS];
+    memcpy(pos, inicio, sizeof(pos));
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') ordem[pos[ID_FREQ(a, a->freq[s])]++] = s;
+    }
+
+    for (int f = 0; f < a->numFreqs; f++) {
+        for (int i = inicio[f]; i < inicio[f + 1]; i++) {
+            int xa = a->x[ordem[i]], ya = a->y[ordem[i]];
+            for (int k = i + 1; k < inicio[f + 1]; k++) {
+                int xb = a->x[ordem[k]], yb = a->y[ordem[k]];
+                ESTAT_SOMAR(paresExaminados, 1);
+                if (modo == EFEITOS_HARMONICOS) {
+                    RasterizarReta(c, xa, ya, xb, yb);
+                }
+                else {
+                    MarcarEfeito(c, 2 * xa - xb, 2 * ya - yb);
+                    MarcarEfeito(c, 2 * xb - xa, 2 * yb - ya);
+                }
+            }
+        }
+    }
+    free(ordem);
+    return c;
+}
+
+/**
+ * \brief Devolve o conjunto de efeitos do armazém no modo indicado, usando a cache.
+ *
+ * O conjunto só é recalculado quando a versão do armazém mudou desde o último
+ * cálculo nesse modo. O conjunto pertence ao armazém e deixa de ser válido
+ * na alteração seguinte.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param modo EFEITOS_PONTOS ou EFEITOS_HARMONICOS.
+ * \return Ponteiro para o conjunto ou NULL se faltar memória.
+ */
+const ConjuntoEfeitos* EfeitosEmCache(ArmazemAntenas* a, int modo) {
+    if (a == NULL) {
+        return NULL;
+    }
+    int m = modo == EFEITOS_HARMONICOS ? 1 : 0;
+    if (a->cacheEfeitos[m] != NULL && a->versaoCacheEfeitos[m] == a->versao) {
+        return a->cacheEfeitos[m];
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    ConjuntoEfeitos* c = a->cacheEfeitos[m];
+    if (c == NULL) {
+        c = CriarConjuntoEfeitos(a->largura, a->altura);
+        if (c == NULL) {
+            return NULL;
+        }
+        a->cacheEfeitos[m] = c;
+    }
+    else {
+        memset(c->bits, 0, (size_t)c->palavrasLinha * c->altura * sizeof(uint64_t));
+    }
+    if (!MarcarEfeitosArmazem(a, c, modo)) {
+        LimparCacheEfeitos(a);
+        return NULL;
+    }
+    a->versaoCacheEfeitos[m] = a->versao;
+    ESTAT_FIM(nsEfeitos, inicio);
+    return c;
+}
+
+/**
+ * \brief Liberta os conjuntos de efeitos em cache do armazém.
+ */
+void LimparCacheEfeitos(ArmazemAntenas* a) {
+    for (int m = 0; m < 2; m++) {
+        DestruirConjuntoEfeitos(a->cacheEfeitos[m]);
+        a->cacheEfeitos[m] = NULL;
+    }
+}
+#pragma endregion
+
+#pragma region Gerador de efeitos
+/**
+ * \brief Cria um gerador que produz os efeitos de um conjunto de antenas em colunas.
+ *
+ * Para cada par de antenas com a mesma frequência em posições diferentes
+ * são gerados os efeitos 2a - b e 2b - a (sem recorte ao grid), entregues
+ * aos poucos por ProximosEfeitos, sem construir uma lista. O gerador só guarda a ordem das antenas por id de frequência (O(n),
+ * com um balde por frequência presente) e a posição atual; as colunas têm de
+ * se manter válidas enquanto for usado.
+ *
+ * \param freq Coluna das frequências ('\0' indica uma posição a ignorar).
+ * \param x Coluna das coordenadas x.
+ * \param y Coluna das coordenadas y.
+ * \param n Número de posições das colunas.
+ * \return Ponteiro para o gerador ou NULL se faltar memória.
+ */
+GeradorEfeitos* CriarGeradorEfeitos(const char* freq, const CoordAntena* x, const CoordAntena* y, int n) {
+    GeradorEfeitos* g = (GeradorEfeitos*)calloc(1, sizeof(GeradorEfeitos));
+    if (g == NULL) {
+        return NULL;
+    }
+    TabelaFrequencias ids = { { 0 }, 0 };
+    for (int i = 0; i < n; i++) {
+        if (freq[i] != '\0') InternarFrequenciaTabela(&ids, freq[i]);
+    }
+    g->numFreqs = ids.numFreqs;
+    g->inicio = (int*)calloc((size_t)g->numFreqs + 1, sizeof(int));
+    int* pos = (int*)malloc(((size_t)g->numFreqs + 1) * sizeof(int));
+    if (g->inicio == NULL || pos == NULL) {
+        free(pos);
+        DestruirGeradorEfeitos(g);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        if (freq[i] != '\0') g->inicio[ids.idDaFreq[(unsigned char)freq[i]]]++; // Id + 1
+    }
+    for (int f = 0; f < g->numFreqs; f++) g->inicio[f + 1] += g->inicio[f];
+    ESTAT_PARES_BALDES(g->inicio, g->numFreqs);
+    g->ordem = (int*)malloc(((size_t)g->inicio[g->numFreqs] + 1) * sizeof(int));
+    if (g->ordem == NULL) {
+        free(pos);
+        DestruirGeradorEfeitos(g);
+        return NULL;
+    }
+    memcpy(pos, g->inicio, (size_t)g->numFreqs * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        if (freq[i] != '\0') g->ordem[pos[ids.idDaFreq[(unsigned char)freq[i]] - 1]++] = i;
+    }
+    free(pos);
+    g->x = x;
+    g->y = y;
+    g->freqAtual = 0;
+    g->i = 0;
+    g->k = 1;
+    return g;
+}
+
+/**
+ * \brief Cria um gerador sobre as antenas de um armazém.
+ */
+GeradorEfeitos* CriarGeradorEfeitosArmazem(const ArmazemAntenas* a) {
+    if (a == NULL) {
+        return NULL;
+    }
+    return CriarGeradorEfeitos(a->freq, a->x, a->y, a->numSlots);
+}
+
+/**
+ * \brief Escreve os próximos efeitos nos vetores do chamador.
+ *
+ * Pode ser chamada repetidamente; continua onde a chamada anterior parou.
+ *
+ * \param g Ponteiro para o gerador.
+ * \param xs Vetor de saída com as coordenadas x.
+ * \param ys Vetor de saída com as coordenadas y.
+ * \param max Capacidade dos vetores (>= 2).
+ * \return Número de efeitos escritos (0 quando já não há mais).
+ */
+int ProximosEfeitos(GeradorEfeitos* g, int* xs, int* ys, int max) {
+    if (g == NULL || max < 2) {
+        return 0;
+    }
+    int escritos = 0;
+    while (g->freqAtual < g->numFreqs && escritos + 2 <= max) {
+        int fim = g->inicio[g->freqAtual + 1];
+        int i = g->inicio[g->freqAtual] + g->i;
+        int k = g->inicio[g->freqAtual] + g->k;
+        if (k >= fim) { // Fim dos pares de i: avança para a antena seguinte (ou para a frequência seguinte)
+            g->i++;
+            g->k = g->i + 1;
+            if (g->inicio[g->freqAtual] + g->k >= fim) {
+                g->freqAtual++;
+                g->i = 0;
+                g->k = 1;
+            }
+            continue;
+        }
+        int a = g->ordem[i], b = g->ordem[k];
+        g->k++;
+        ESTAT_SOMAR(paresExaminados, 1);
+        int xa = g->x[a], ya = g->y[a], xb = g->x[b], yb = g->y[b];
+        if (xa == xb && ya == yb) continue; // Mesma posição: sem efeito
+        xs[escritos] = 2 * xa - xb;
+        ys[escritos++] = 2 * ya - yb;
+        xs[escritos] = 2 * xb - xa;
+        ys[escritos++] = 2 * yb - ya;
+    }
+    return escritos;
+}
+
+/**
+ * \brief Destrói um gerador de efeitos.
+ *
+ * \return true se o gerador foi destruído, false se era NULL.
+ */
+bool DestruirGeradorEfeitos(GeradorEfeitos* g) {
+    if (g == NULL) {
+        return false;
+    }
+    free(g->ordem);
+    free(g->inicio);
+    free(g);
+    return true;
+}
+
+/**
+ * \brief Marca no conjunto os efeitos do armazém no modo indicado, sem construir listas.
+ *
+ * \return true se os efeitos foram marcados, false se faltar memória.
+ */
+bool MarcarEfeitosArmazem(const ArmazemAntenas* a, ConjuntoEfeitos* c, int modo) {
+    if (modo == EFEITOS_HARMONICOS) {
+        ConjuntoEfeitos* h = CalcularConjuntoEfeitos(a, modo);
+        if (h == NULL) {
+            return false;
+        }
+        size_t n = (size_t)c->palavrasLinha * c->altura;
+        for (size_t i = 0; i < n; i++) c->bits[i] |= h->bits[i];
+        DestruirConjuntoEfeitos(h);
+        return true;
+    }
+#if MOTOR_BITBOARD
+    if (c->largura == a->largura && c->altura == a->altura) {
+        MotorBitboard* m = CriarMotorBitboard(a);
+        bool feito = EfeitosBitboard(m, c);
+        DestruirMotorBitboard(m);
+        if (feito) {
+            return true;
+        }
+    }
+#endif
+    GeradorEfeitos* g = CriarGeradorEfeitosArmazem(a);
+    if (g == NULL) {
+        return false;
+    }
+    int xs[GERADOR_BLOCO], ys[GERADOR_BLOCO];
+    int n;
+    while ((n = ProximosEfeitos(g, xs, ys, GERADOR_BLOCO)) > 0) {
+        for (int i = 0; i < n; i++) MarcarEfeito(c, xs[i], ys[i]);
+    }
+    DestruirGeradorEfeitos(g);
+    return true;
+}
+
+/**
+ * \brief Conta os efeitos do armazém (contando repetições e efeitos fora do grid).
+ *
+ * \return Número de efeitos ou -1 se faltar memória.
+ */
+long long ContarEfeitosArmazem(const ArmazemAntenas* a) {
+    GeradorEfeitos* g = CriarGeradorEfeitosArmazem(a);
+    if (g == NULL) {
+        return -1;
+    }
+    int xs[GERADOR_BLOCO], ys[GERADOR_BLOCO];
+    long long total = 0;
+    int n;
+    while ((n = ProximosEfeitos(g, xs, ys, GERADOR_BLOCO)) > 0) total += n;
+    DestruirGeradorEfeitos(g);
+    return total;
+}
+
+/**
+ * \brief Exporta os efeitos do armazém para um ficheiro de texto ("x y" por linha).
+ *
+ * \param a Ponteiro para o armazém.
+ * \param nomeFicheiro Nome do ficheiro.
+ * \return true se a exportação foi bem-sucedida, false caso contrário.
+ */
+bool ExportarEfeitosArmazem(const ArmazemAntenas* a, const char* nomeFicheiro) {
+    FILE* ficheiro = fopen(nomeFicheiro, "w");
+    if (ficheiro == NULL) {
+        return false;
+    }
+    GeradorEfeitos* g = CriarGeradorEfeitosArmazem(a);
+    if (g == NULL) {
+        fclose(ficheiro);
+        return false;
+    }
+    int xs[GERADOR_BLOCO], ys[GERADOR_BLOCO];
+    int n;
+    while ((n = ProximosEfeitos(g, xs, ys, GERADOR_BLOCO)) > 0) {
+        for (int i = 0; i < n; i++) fprintf(ficheiro, "%d %d\n", xs[i], ys[i]);
+    }
+    DestruirGeradorEfeitos(g);
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_FICHEIRO(ficheiro);
+    fclose(ficheiro);
+    return true;
+}
+#pragma endregion
+
@@ -0,0 +1,131 @@
+/*****************************************************************//**
+ * \file   estatisticas.c
+ * \brief  Contadores de instrumentação e respetiva apresentação (ecrã e JSON).
+ *
+ * Os contadores são atualizados pelas macros ESTAT_* de dados.h, que só geram
+ * código quando o programa é compilado com ESTATISTICAS definido (por exemplo
+ * -DESTATISTICAS ou /DESTATISTICAS). Sem essa opção ficam sempre a zero.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+#include <time.h>
+
+Estatisticas estatisticas;
+
+#pragma region Estatísticas
+/**
+ * \brief Indica se a instrumentação foi compilada.
+ */
+bool EstatisticasAtivas() {
+#ifdef ESTATISTICAS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * \brief Relógio em nanossegundos para os tempos das operações.
+ */
+unsigned long long RelogioNs() {
+    struct timespec t;
+    if (timespec_get(&t, TIME_UTC) != TIME_UTC) {
+        return 0;
+    }
+    return (unsigned long long)t.tv_sec * 1000000000ull + (unsigned long long)t.tv_nsec;
+}
+
+/**
+ * \brief Soma aos bytes escritos o tamanho de um ficheiro acabado de escrever (antes de fechar).
+ */
+void RegistarBytesEscritos(FILE* ficheiro) {
+    long tam = ftell(ficheiro);
+    if (tam > 0) {
+        estatisticas.bytesEscritos += (unsigned long long)tam;
+    }
+}
+
+/**
+ * \brief Soma aos pares da mesma frequência os pares de cada balde (inicio com numBaldes + 1 posições).
+ */
+void ContarParesBaldes(const int* inicio, int numBaldes) {
+    for (int f = 0; f < numBaldes; f++) {
+        unsigned long long k = (unsigned long long)(inicio[f + 1] - inicio[f]);
+        if (k > 1) estatisticas.paresMesmaFreq += k * (k - 1) / 2;
+    }
+}
+
+/**
+ * \brief Põe todos os contadores a zero.
+ */
+void ReiniciarEstatisticas() {
+    memset(&estatisticas, 0, sizeof(estatisticas));
+}
+
+/**
+ * \brief Divide dois contadores (0 se o divisor for 0).
+ */
+static double Razao(unsigned long long a, unsigned long long b) {
+    return b == 0 ? 0.0 : (double)a / (double)b;
+}
+
+/**
+ * \brief Mostra os contadores no ecrã.
+ */
+void MostrarEstatisticas() {
+    const Estatisticas* e = &estatisticas;
+    if (!EstatisticasAtivas()) {
+        printf("Estatisticas desativadas (compile com ESTATISTICAS definido).\n");
+        return;
+    }
+    printf("Operacoes: %llu (%.2f alocacoes por operacao)\n", e->operacoes, Razao(e->alocacoes, e->operacoes));
+    printf("Procuras em listas: %llu (%.2f nos percorridos por procura)\n", e->procurasLista, Razao(e->nosPercorridos, e->procurasLista));
+    printf("Pares examinados: %llu de %llu com a mesma frequencia\n", e->paresExaminados, e->paresMesmaFreq);
+    printf("Bytes escritos: %llu\n", e->bytesEscritos);
+    printf("Procuras no grafo: %llu (%llu vertices visitados, fronteira maxima BFS %llu, DFS %llu)\n",
+        e->procurasGrafo, e->verticesVisitados, e->fronteiraMaxBFS, e->fronteiraMaxDFS);
+    printf("Armazem em disco: %llu tiles mapeados, %llu efeitos adiados\n", e->tilesMapeados, e->efeitosAdiados);
+    printf("Tempo (ms): efeitos %.3f, salvamentos %.3f, procuras %.3f\n",
+        e->nsEfeitos / 1e6, e->nsSalvar / 1e6, e->nsProcuras / 1e6);
+}
+
+/**
+ * \brief Exporta os contadores para um ficheiro JSON.
+ *
+ * \param nomeFicheiro Nome do ficheiro.
+ * \return true se o ficheiro foi escrito, false caso contrário.
+ */
+bool ExportarEstatisticasJson(const char* nomeFicheiro) {
+    FILE* ficheiro = fopen(nomeFicheiro, "w");
+    if (ficheiro == NULL) {
+        return false;
+    }
+    const Estatisticas* e = &estatisticas;
+    fprintf(ficheiro, "{\n");
+    fprintf(ficheiro, "  \"ativas\": %s,\n", EstatisticasAtivas() ? "true" : "false");
+    fprintf(ficheiro, "  \"operacoes\": %llu,\n", e->operacoes);
+    fprintf(ficheiro, "  \"alocacoes\": %llu,\n", e->alocacoes);
+    fprintf(ficheiro, "  \"alocacoes_por_operacao\": %.3f,\n", Razao(e->alocacoes, e->operacoes));
+    fprintf(ficheiro, "  \"procuras_lista\": %llu,\n", e->procurasLista);
+    fprintf(ficheiro, "  \"nos_percorridos\": %llu,\n", e->nosPercorridos);
+    fprintf(ficheiro, "  \"pares_examinados\": %llu,\n", e->paresExaminados);
+    fprintf(ficheiro, "  \"pares_mesma_frequencia\": %llu,\n", e->paresMesmaFreq);
+    fprintf(ficheiro, "  \"bytes_escritos\": %llu,\n", e->bytesEscritos);
+    fprintf(ficheiro, "  \"procuras_grafo\": %llu,\n", e->procurasGrafo);
+    fprintf(ficheiro, "  \"vertices_visitados\": %llu,\n", e->verticesVisitados);
+    fprintf(ficheiro, "  \"fronteira_max_bfs\": %llu,\n", e->fronteiraMaxBFS);
+    fprintf(ficheiro, "  \"fronteira_max_dfs\": %llu,\n", e->fronteiraMaxDFS);
+    fprintf(ficheiro, "  \"tiles_mapeados\": %llu,\n", e->tilesMapeados);
+    fprintf(ficheiro, "  \"efeitos_adiados\": %llu,\n", e->efeitosAdiados);
+    fprintf(ficheiro, "  \"ns_efeitos\": %llu,\n", e->nsEfeitos);
+    fprintf(ficheiro, "  \"ns_salvar\": %llu,\n", e->nsSalvar);
+    fprintf(ficheiro, "  \"ns_procuras\": %llu\n", e->nsProcuras);
+    fprintf(ficheiro, "}\n");
+    fclose(ficheiro);
+    return true;
+}
+#pragma endregion
@@ -0,0 +1,299 @@
+/*****************************************************************//**
+ * \file   fragmentos.c
+ * \brief  Armazém de antenas dividido em fragmentos espaciais com locks próprios.
+ *
+ * O grid é dividido em blocos de FRAGMENTO_BLOCO x FRAGMENTO_BLOCO células e
+ * cada bloco é atribuído a um fragmento por dispersão, para que regiões densas
+ * fiquem repartidas por vários fragmentos. Cada fragmento é um armazém normal
+ * com o seu lock, pelo que inserções e remoções em fragmentos diferentes
+ * decorrem em paralelo. As inserções em lote tomam o lock de cada fragmento
+ * uma única vez.
+ *
+ * Os efeitos e a renderização usam uma vista global: um armazém normal com
+ * todas as antenas, copiado com todos os locks tomados (estado consistente).
+ *
+ * As estatísticas (ESTATISTICAS) não são atómicas e não devem ser ativadas em
+ * programas com várias threads a alterar o armazém fragmentado.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+#include <threads.h>
+
+/**
+ * \brief Fragmento: armazém e lock.
+ */
+typedef struct Fragmento {
+    mtx_t lock;
+    ArmazemAntenas* armazem;
+    char preenchimento[64]; // Os locks de fragmentos vizinhos não partilham linhas de cache
+} Fragmento;
+
+/**
+ * \brief Armazém fragmentado.
+ */
+struct ArmazemFragmentado {
+    int numFragmentos;
+    int largura, altura;
+    Fragmento* fragmentos;
+};
+
+#pragma region Fragmentos
+/**
+ * \brief Fragmento responsável por uma coordenada.
+ *
+ * Coordenadas fora do grid também dão um fragmento válido; a validação é
+ * feita pelo armazém do fragmento.
+ */
+static int FragmentoDe(const ArmazemFragmentado* f, int x, int y) {
+    uint32_t bx = (uint32_t)x / FRAGMENTO_BLOCO;
+    uint32_t by = (uint32_t)y / FRAGMENTO_BLOCO;
+    uint32_t h = bx * 0x9E3779B1u ^ by * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 13;
+    return (int)(((uint64_t)h * (uint64_t)f->numFragmentos) >> 32);
+}
+
+/**
+ * \brief Cria um armazém fragmentado vazio.
+ *
+ * \param largura Largura do grid.
+ * \param altura Altura do grid.
+ * \param numFragmentos Número de fragmentos (0 para 4 por processador), até FRAGMENTOS_MAX.
+ * \return Ponteiro para o armazém ou NULL se as dimensões forem inválidas ou faltar memória.
+ */
+ArmazemFragmentado* CriarArmazemFragmentado(int largura, int altura, int numFragmentos) {
+    if (numFragmentos <= 0) numFragmentos = 4 * NumeroProcessadores();
+    if (numFragmentos > FRAGMENTOS_MAX) numFragmentos = FRAGMENTOS_MAX;
+    ArmazemFragmentado* f = (ArmazemFragmentado*)malloc(sizeof(ArmazemFragmentado));
+    if (f == NULL) {
+        return NULL;
+    }
+    f->fragmentos = (Fragmento*)calloc(numFragmentos, sizeof(Fragmento));
+    if (f->fragmentos == NULL) {
+        free(f);
+        return NULL;
+    }
+    f->numFragmentos = 0;
+    f->largura = largura;
+    f->altura = altura;
+    for (int i = 0; i < numFragmentos; i++) {
+        Fragmento* fr = &f->fragmentos[i];
+        fr->armazem = CriarArmazem(largura, altura);
+        if (fr->armazem == NULL || mtx_init(&fr->lock, mtx_plain) != thrd_success) {
+            DestruirArmazem(fr->armazem);
+            DestruirArmazemFragmentado(f);
+            return NULL;
+        }
+        f->numFragmentos++;
+    }
+    return f;
+}
+
+/**
+ * \brief Número de fragmentos do armazém.
+ */
+int NumeroFragmentos(const ArmazemFragmentado* f) {
+    return f != NULL ? f->numFragmentos : 0;
+}
+
+/**
+ * \brief Insere uma antena no fragmento responsável pela coordenada.
+ *
+ * \return 0 se a antena foi inserida, ARMAZEM_FORA_GRID, ARMAZEM_DUPLICADA ou ARMAZEM_SEM_MEMORIA.
+ */
+int InserirAntenaFragmentado(ArmazemFragmentado* f, char freq, int x, int y) {
+    if (f == NULL) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    Fragmento* fr = &f->fragmentos[FragmentoDe(f, x, y)];
+    mtx_lock(&fr->lock);
+    int s = InserirAntenaArmazem(fr->armazem, freq, x, y);
+    mtx_unlock(&fr->lock);
+    return s >= 0 ? 0 : s;
+}
+
+/**
+ * \brief Insere várias antenas, agrupadas por fragmento.
+ *
+ * As entradas são distribuídas pelos fragmentos (ordenação por contagem) e
+ * cada grupo é inserido com InserirAntenasEmLote, com o lock do fragmento
+ * tomado uma só vez. Duplicados dentro do lote ficam com a primeira ocorrência.
+ *
+ * \param estado Vetor opcional (pode ser NULL) que recebe, por entrada, 0 se foi
+ *               inserida ou o código ARMAZEM_* que levou à rejeição.
+ * \return Número de antenas inseridas ou ARMAZEM_SEM_MEMORIA.
+ */
+int InserirAntenasEmLoteFragmentado(ArmazemFragmentado* f, const char* freq, const int* x, const int* y, int n, signed char* estado) {
+    if (f == NULL || n < 0) {
+        return ARMAZEM_SEM_MEMORIA;
+    }
+    int* frag = (int*)malloc((n + 1) * sizeof(int));
+    int* ordem = (int*)malloc((n + 1) * sizeof(int));
+    int* gx = (int*)malloc((n + 1) * sizeof(int));
+    int* gy = (int*)malloc((n + 1) * sizeof(int));
+    char* gfreq = (char*)malloc(n + 1);
+    signed char* gest = (signed char*)malloc(n + 1);
+    if (frag == NULL || ordem == NULL || gx == NULL || gy == NULL || gfreq == NULL || gest == NULL) {
+        free(frag);
+        free(ordem);
+        free(gx);
+        free(gy);
+        free(gfreq);
+        free(gest);
+        return ARMAZEM_SEM_MEMORIA;
+    }
+
+    // Ordenação estável por fragmento (mantém a ordem do lote dentro de cada grupo)
+    int inicio[FRAGMENTOS_MAX + 1] = { 0 };
+    for (int i = 0; i < n; i++) {
+        frag[i] = FragmentoDe(f, x[i], y[i]);
+        inicio[frag[i] + 1]++;
+    }
+    for (int k = 0; k < f->numFragmentos; k++) inicio[k + 1] += inicio[k];
+    int pos[FRAGMENTOS_MAX];
+    memcpy(pos, inicio, sizeof(pos));
+    for (int i = 0; i < n; i++) {
+        int j = pos[frag[i]]++;
+        ordem[j] = i;
+        gfreq[j] = freq[i];
+        gx[j] = x[i];
+        gy[j] = y[i];
+    }
+
+    int total = 0;
+    bool semMemoria = false;
+    for (int k = 0; k < f->numFragmentos; k++) {
+        int m = inicio[k + 1] - inicio[k];
+        if (m == 0) continue;
+        Fragmento* fr = &f->fragmentos[k];
+        mtx_lock(&fr->lock);
+        int aceites = InserirAntenasEmLote(fr->armazem, gfreq + inicio[k], gx + inicio[k], gy + inicio[k], m, gest + inicio[k]);
+        mtx_unlock(&fr->lock);
+        if (aceites < 0) {
+            semMemoria = true;
+            memset(gest + inicio[k], ARMAZEM_SEM_MEMORIA, m);
+        }
+        else {
+            total += aceites;
+        }
+    }
+    if (estado != NULL) {
+        for (int j = 0; j < n; j++) estado[ordem[j]] = gest[j];
+    }
+
+    free(frag);
+    free(ordem);
+    free(gx);
+    free(gy);
+    free(gfreq);
+    free(gest);
+    return semMemoria ? ARMAZEM_SEM_MEMORIA : total;
+}
+
+/**
+ * \brief Remove a antena de uma coordenada.
+ *
+ * \return true se a antena foi removida, false se não existia.
+ */
+bool RemoverAntenaFragmentado(ArmazemFragmentado* f, int x, int y) {
+    if (f == NULL) {
+        return false;
+    }
+    Fragmento* fr = &f->fragmentos[FragmentoDe(f, x, y)];
+    mtx_lock(&fr->lock);
+    int s = ProcurarAntenaArmazem(fr->armazem, x, y);
+    bool removida = s >= 0 && RemoverAntenaArmazem(fr->armazem, s);
+    mtx_unlock(&fr->lock);
+    return removida;
+}
+
+/**
+ * \brief Frequência da antena numa coordenada.
+ *
+ * \return Frequência da antena ou '\0' se não existir.
+ */
+char ProcurarAntenaFragmentado(ArmazemFragmentado* f, int x, int y) {
+    if (f == NULL) {
+        return '\0';
+    }
+    Fragmento* fr = &f->fragmentos[FragmentoDe(f, x, y)];
+    mtx_lock(&fr->lock);
+    int s = ProcurarAntenaArmazem(fr->armazem, x, y);
+    char freq = s >= 0 ? fr->armazem->freq[s] : '\0';
+    mtx_unlock(&fr->lock);
+    return freq;
+}
+
+/**
+ * \brief Número de antenas em todos os fragmentos (cada fragmento é contado com o seu lock).
+ */
+int ContarAntenasFragmentado(ArmazemFragmentado* f) {
+    int total = 0;
+    for (int k = 0; f != NULL && k < f->numFragmentos; k++) {
+        mtx_lock(&f->fragmentos[k].lock);
+        total += f->fragmentos[k].armazem->numAntenas;
+        mtx_unlock(&f->fragmentos[k].lock);
+    }
+    return total;
+}
+
+/**
+ * \brief Cria um armazém normal com todas as antenas (para efeitos, renderização e grafos).
+ *
+ * Os locks são tomados por ordem crescente de fragmento e mantidos só durante
+ * a cópia das colunas; a construção do armazém é feita depois de os libertar.
+ * A vista não acompanha alterações posteriores e é destruída com DestruirArmazem.
+ *
+ * \return Ponteiro para a vista ou NULL se faltar memória.
+ */
+ArmazemAntenas* CriarVistaGlobal(ArmazemFragmentado* f) {
+    if (f == NULL) {
+        return NULL;
+    }
+    for (int k = 0; k < f->numFragmentos; k++) mtx_lock(&f->fragmentos[k].lock);
+    int total = 0;
+    for (int k = 0; k < f->numFragmentos; k++) total += f->fragmentos[k].armazem->numAntenas;
+    LoteAntenas* lote = CriarLote(total);
+    for (int k = 0; lote != NULL && k < f->numFragmentos; k++) {
+        const ArmazemAntenas* a = f->fragmentos[k].armazem;
+        for (int s = 0; s < a->numSlots; s++) {
+            if (a->freq[s] != '\0') AcrescentarAoLote(lote, a->freq[s], a->x[s], a->y[s]);
+        }
+    }
+    for (int k = f->numFragmentos - 1; k >= 0; k--) mtx_unlock(&f->fragmentos[k].lock);
+    if (lote == NULL) {
+        return NULL;
+    }
+
+    ArmazemAntenas* vista = CriarArmazem(f->largura, f->altura);
+    if (vista != NULL && InserirAntenasEmLote(vista, lote->freq, lote->x, lote->y, lote->numAntenas, NULL) < 0) {
+        DestruirArmazem(vista);
+        vista = NULL;
+    }
+    DestruirLote(lote);
+    return vista;
+}
+
+/**
+ * \brief Destrói o armazém fragmentado (não pode haver threads a usá-lo).
+ *
+ * \return true se o armazém foi destruído, false se era NULL.
+ */
+bool DestruirArmazemFragmentado(ArmazemFragmentado* f) {
+    if (f == NULL) {
+        return false;
+    }
+    for (int k = 0; k < f->numFragmentos; k++) {
+        mtx_destroy(&f->fragmentos[k].lock);
+        DestruirArmazem(f->fragmentos[k].armazem);
+    }
+    free(f->fragmentos);
+    free(f);
+    return true;
+}
+#pragma endregion
@@ -1,31 +1,32 @@
 /*****************************************************************//**
  * \file   funcoes.c
- * \brief  Implementao das funes para manipulao de antenas e efeitos nefastos.
+ * \brief  Implementação das funções para manipulação de antenas e efeitos nefastos.
  *
  * \author matos
  * \date   March 2025
  *********************************************************************/
 
 #include "dados.h"
-#define GRID_TAM 10
+#include "funcoes.h"
 #define CRT_SECURE_NO_WARNINGS
 
 #pragma region Antenas
  /**
   * \brief Cria uma nova antena.
   *
-  * \param freq Frequncia da antena.
+  * \param freq Frequência da antena.
   * \param x Coordenada x da antena.
   * \param y Coordenada y da antena.
   * \return Ponteiro para a nova antena criada.
   */
 Antena* CriarAntena(char freq, int x, int y) {
-    Antena* aux = (Antena*)malloc(sizeof(Antena)); // Aloca memria para uma nova antena
+    Antena* aux = (Antena*)malloc(sizeof(Antena)); // Aloca memória para uma nova antena
     if (aux != NULL) {
-        aux->freq = freq; // Define a frequncia da antena
+        ESTAT_SOMAR(alocacoes, 1);
+        aux->freq = freq; // Define a frequência da antena
         aux->x = x; // Define a coordenada x da antena
         aux->y = y; // Define a coordenada y da antena
-        aux->prox = NULL; // Define o prximo ponteiro como NULL
+        aux->prox = NULL; // Define o próximo ponteiro como NULL
     }
     return aux; // Retorna o ponteiro para a nova antena
 }
@@ -33,104 +34,44 @@ Antena* CriarAntena(char freq, int x, int y) {
 /**
  * \brief Insere uma antena na lista de forma ordenada.
  *
- * \param inicio Ponteiro para o incio da lista de antenas.
+ * \param inicio Ponteiro para o início da lista de antenas.
  * \param aux Ponteiro para a antena a ser inserida.
- * \return Ponteiro para o incio da lista atualizada.
+ * \return Ponteiro para o início da lista atualizada.
  */
 Antena* InserirAntena(Antena* inicio, char freq, int x, int y) {
     // Criar a nova antena
 
     if (x < 0 || x >= GRID_TAM || y < 0 || y >= GRID_TAM) {
-        return NULL; // No insere
+        return NULL; // Não insere
     }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_SOMAR(procurasLista, 1);
 
     Antena* aux = CriarAntena(freq, x, y);
     if (aux == NULL) {
         return inicio; // Verifica se a antena foi criada com sucesso
     }
-    // Verificar se j existe uma antena nas mesmas coordenadas
+    // Verificar se já existe uma antena nas mesmas coordenadas
     Antena* atual = inicio;
     while (atual != NULL) {
-        if (atual->x == x && atual->y == y) { // Verifica se j existe uma antena nas mesmas coordenadas
-            free(aux); // Liberar a memria da nova antena
-            return inicio; // Retorna o incio da lista sem alteraes
+        ESTAT_SOMAR(nosPercorridos, 1);
+        if (atual->x == x && atual->y == y) { // Verifica se já existe uma antena nas mesmas coordenadas
+            free(aux); // Liberar a memória da nova antena
+            return inicio; // Retorna o início da lista sem alterações
         }
-        atual = atual->prox; // Avana para a prxima antena na lista
+        atual = atual->prox; // Avança para a próxima antena na lista
     }
 
-    // Inserir a antena no incio da lista
-    aux->prox = inicio; // Define o prximo ponteiro da nova antena como o incio da lista
-    return aux; // Retorna a nova antena como o incio da lista
+    // Inserir a antena no início da lista
+    aux->prox = inicio; // Define o próximo ponteiro da nova antena como o início da lista
+    return aux; // Retorna a nova antena como o início da lista
 }
 
-/**
- * \brief Remove uma antena da lista.
- *
- * \param h Ponteiro para o incio da lista de antenas.
- * \param freq Frequncia da antena a ser removida.
- * \param x Coordenada x da antena a ser removida.
- * \param y Coordenada y da antena a ser removida.
- * \param removida Ponteiro para indicar se a remoo foi bem-sucedida.
- * \return Ponteiro para o incio da lista atualizada.
- */
-
-Antena* RemoverAntena(Antena* h, char freq, int x, int y, int* removida) {
-    Antena* aux = h; 
-	Antena* anterior = NULL; // Ponteiro para o elemento anterior na lista
-    *removida = 0; 
-    while (aux != NULL) {
-        if (aux->freq == freq && aux->x == x && aux->y == y) {
-			if (anterior == NULL) // Se a antena a ser removida  a primeira da lista
-                h = aux->prox;
-            else
-                anterior->prox = aux->prox;
-            free(aux);
-            *removida = 1;
-			return h; // Retorna o incio da lista atualizada
-        }
-		anterior = aux; // Avana para a prxima antena na lista
-        aux = aux->prox;
-    }
-	return h; // Retorna o incio da lista sem alteraes
-}
-
-/**
- * \brief Salva a lista de antenas em um ficheiro de texto.
- *
- * \param lista Ponteiro para o incio da lista de antenas.
- * \param nomeFicheiro Nome do ficheiro onde as antenas sero salvas.
- * \return true se o salvamento foi bem-sucedido, false caso contrrio.
- */
-
-bool SalvarAntenasEmTxt(Antena* lista, const char* nomeFicheiro) {
-    FILE* ficheiro = fopen(nomeFicheiro, "w");
-    if (ficheiro == NULL) {
-        return false;
-    }
-    for (int i = 0; i < GRID_TAM; i++) {
-        for (int j = 0; j < GRID_TAM; j++) {
-            char simbolo = '.';
-            Antena* auxAntena = lista;
-			while (auxAntena != NULL) { // Percorre a lista de antenas
-				
-				if (auxAntena->x == j && auxAntena->y == i) { // Verifica se a antena est na posio atual
-                    simbolo = auxAntena->freq;
-                    break;
-                }
-				auxAntena = auxAntena->prox; // Avana para a prxima antena na lista
-            }
-            fprintf(ficheiro, "%c ", simbolo);
-        }
-        fprintf(ficheiro, "\n");
-    }
-    fclose(ficheiro);
-    return true;
-}
 /**
  * \brief Carrega as antenas de um ficheiro de texto.
  *
  * \param nomeFicheiro Nome do ficheiro de texto a ser carregado.
- * \return Ponteiro para o incio da lista de antenas ou NULL se ocorrer um erro.
+ * \return Ponteiro para o início da lista de antenas ou NULL se ocorrer um erro.
  */
 Antena* CarregarAntenasDeTxt(const char* nomeFicheiro) {
     FILE* ficheiro = fopen(nomeFicheiro, "r");
@@ -141,7 +82,7 @@ Antena* CarregarAntenasDeTxt(const char* nomeFicheiro) {
     for (int i = 0; i < GRID_TAM; i++) {
         for (int j = 0; j < GRID_TAM; j++) {
             char simbolo; 
-			fscanf(ficheiro, " %c", &simbolo); // L o smbolo do ficheiro
+			fscanf(ficheiro, " %c", &simbolo); // Lê o símbolo do ficheiro
             if (simbolo != '.') { 
 				lista = InserirAntena(lista, simbolo, j, i); // Insere a antena na lista 
             }
@@ -152,73 +93,10 @@ Antena* CarregarAntenasDeTxt(const char* nomeFicheiro) {
 }
 
 /**
- * \brief Lista as antenas e os efeitos nefastos no grid.
+ * \brief Carrega as antenas de um ficheiro binário.
  *
- * \param lista Ponteiro para o incio da lista de antenas.
- * \param efeitos Ponteiro para o incio da lista de efeitos nefastos.
- * \return Ponteiro para o incio da lista de antenas.
- */
-
-Antena* ListarAntenas(Antena* lista, EfeitoNefasto* efeitos) {
-    for (int i = 0; i < GRID_TAM; i++) {
-        for (int j = 0; j < GRID_TAM; j++) {
-            char simbolo = '.';
-            //Procura antena
-            Antena* auxAntena = lista;
-            while (auxAntena != NULL) {
-                if (auxAntena->x == j && auxAntena->y == i) {
-                    simbolo = auxAntena->freq;
-                    break;
-                }
-                auxAntena = auxAntena->prox;
-            }
-            // Se no encontrou antena, procura efeito nefasto
-            if (simbolo == '.') {
-                EfeitoNefasto* auxEfeito = efeitos;
-                while (auxEfeito != NULL) {
-                    if (auxEfeito->x == j && auxEfeito->y == i) {
-                        simbolo = '#';
-                        break;
-                    }
-                    auxEfeito = auxEfeito->prox;
-                }
-            }
-            printf("%c ", simbolo);
-        }
-        printf("\n");
-    }
-    return lista;
-}
-
-/**
- * \brief Salva a lista de antenas em um ficheiro binrio.
- *
- * \param lista Ponteiro para o incio da lista de antenas.
- * \return true se o salvamento foi bem-sucedido, false caso contrrio.
- */
-
-bool SalvarAntenasEmFicheiroBin(Antena* lista) {
-    FILE* ficheiro = fopen("antenas.bin", "wb");
-    if (ficheiro == NULL) {
-        return false;
-    }
-
-    Antena* aux = lista;
-	while (aux != NULL) { // Percorre a lista de antenas
-        fwrite(&(aux->freq), sizeof(char), 1, ficheiro);
-        fwrite(&(aux->x), sizeof(int), 1, ficheiro);
-        fwrite(&(aux->y), sizeof(int), 1, ficheiro);
-        aux = aux->prox;
-    }
-
-    fclose(ficheiro);
-    return true;
-}
-/**
- * \brief Carrega as antenas de um ficheiro binrio.
- *
- * \param nomeFicheiro Nome do ficheiro binrio a ser carregado.
- * \return Ponteiro para o incio da lista de antenas ou NULL se ocorrer um erro.
+ * \param nomeFicheiro Nome do ficheiro binário a ser carregado.
+ * \return Ponteiro para o início da lista de antenas ou NULL se ocorrer um erro.
  */
 Antena* CarregarAntenasDeBin(const char* nomeFicheiro) {
     FILE* ficheiro = fopen(nomeFicheiro, "rb");
@@ -238,139 +116,44 @@ Antena* CarregarAntenasDeBin(const char* nomeFicheiro) {
 }
 
 /**
- * \brief Destri a lista de antenas, liberando a memria alocada.
+ * \brief Destrói a lista de antenas, liberando a memória alocada.
  *
- * \param h Ponteiro para o incio da lista de antenas.
+ * \param h Ponteiro para o início da lista de antenas.
  */
 bool DestruirListaAntenas(Antena* h) {
     if (h == NULL) {
-        return false; // Lista j estava vazia
+        return false; // Lista já estava vazia
     }
 
     while (h != NULL) {
-        Antena* aux = h; // Salva o ponteiro para a antena a ser destruda
-        h = h->prox;     // Avana para a prxima antena na lista
-        free(aux);       // Libera a memria da antena destruda
+        Antena* aux = h; // Salva o ponteiro para a antena a ser destruída
+        h = h->prox;     // Avança para a próxima antena na lista
+        free(aux);       // Libera a memória da antena destruída
     }
 
-    return true; // Lista destruda com sucesso
+    return true; // Lista destruída com sucesso
 }
 #pragma endregion
 
-#pragma region Efeitos Nefastos
-/**
- * \brief Cria um novo efeito nefasto.
- *
- * \param x Coordenada x do efeito nefasto.
- * \param y Coordenada y do efeito nefasto.
- * \return Ponteiro para o novo efeito nefasto criado.
- */
-EfeitoNefasto* CriarEfeito(int x, int y) {
-    EfeitoNefasto* aux = (EfeitoNefasto*)malloc(sizeof(EfeitoNefasto));// Aloca memria para um novo efeito nefasto
-    if (aux != NULL) {
-        aux->x = x; // Define a coordenada x do efeito nefasto
-        aux->y = y; // Define a coordenada y do efeito nefasto
-        aux->prox = NULL; // Define o prximo ponteiro como NULL
-    }
-    return aux; // Retorna o ponteiro para o novo efeito nefasto
-}
-
-/**
- * \brief Insere um efeito nefasto na lista.
- *
- * \param inicio Ponteiro para o incio da lista de efeitos nefastos.
- * \param x Coordenada x do efeito nefasto.
- * \param y Coordenada y do efeito nefasto.
- * \return Ponteiro para o incio da lista atualizada.
- */
-EfeitoNefasto* InserirEfeito(EfeitoNefasto* inicio, int x, int y) {
-    EfeitoNefasto* aux = CriarEfeito(x, y); // Cria um novo efeito nefasto
-    if (aux == NULL) return inicio; // Verifica se o efeito nefasto foi criado com sucesso
-    aux->prox = inicio; // Define o prximo ponteiro do novo efeito nefasto como o incio da lista
-    return aux; // Retorna o novo efeito nefasto como o incio da lista
-}
-
-/**
- * \brief Verifica se existem antenas com a mesma frequncia e calcula os efeitos nefastos.
- *
- * \param inicio Ponteiro para o incio da lista de antenas.
- * \return Ponteiro para o incio da lista de efeitos nefastos.
- */
-EfeitoNefasto* efeitoNefasto(Antena* inicio) {
-    if (inicio == NULL) {
-        return NULL; // Retorna NULL se a lista de antenas estiver vazia
-    }
-
-    EfeitoNefasto* efeitos = NULL; // Inicializa a lista de efeitos nefastos como NULL
-    EfeitoNefasto* aux; 
-    Antena* current = inicio; 
-    Antena* compare;  
-
-    while (current != NULL) {
-		compare = current->prox; // Comea a comparar com as antenas seguintes
-        while (compare != NULL) {
-            if (current->freq == compare->freq) { // Verifica se as antenas tm a mesma frequncia
-                if ((current->x == compare->x) && (current->y != compare->y)) { // Verifica se as antenas esto na mesma coordenada x e em coordenadas y diferentes
-                    int subtracao = current->y - compare->y; // Calcula a diferena entre as coordenadas y
-                    int nefy = current->y + subtracao; // Calcula a coordenada y do efeito nefasto
-                    int nefy1 = compare->y - subtracao;
-                    aux = CriarEfeito(current->x, nefy);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                    aux = CriarEfeito(compare->x, nefy1); 
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                }
-                else if ((current->x != compare->x) && (current->y == compare->y)) { // Verifica se as antenas esto na mesma coordenada y e em coordenadas x diferentes
-                    int subtracao = current->x - compare->x; // Calcula a diferena entre as coordenadas x
-                    int nefx = current->x + subtracao; // Calcula a coordenada x do efeito nefasto
-                    int nefx1 = compare->x - subtracao; 
-                    aux = CriarEfeito(nefx, current->y); 
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                    aux = CriarEfeito(nefx1, compare->y); 
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                }
-                else if ((current->x != compare->x) && (current->y != compare->y)) { // Verifica se as antenas esto em coordenadas x e y diferentes
-                    int subtracaox = current->x - compare->x; // Calcula a diferena entre as coordenadas x
-                    int subtracaoy = current->y - compare->y; // Calcula a diferena entre as coordenadas y
-                    int nefx = current->x + subtracaox; // Calcula a coordenada x do efeito nefasto
-                    int nefx1 = compare->x - subtracaox; 
-                    int nefy = current->y + subtracaoy; // Calcula a coordenada y do efeito nefasto
-                    int nefy1 = compare->y - subtracaoy; 
-                    aux = CriarEfeito(nefx, nefy); 
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                    aux = CriarEfeito(nefx1, nefy1); 
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y); 
-                }
-            }
-            compare = compare->prox; // Avana para a prxima antena na lista
-        }
-        current = current->prox; // Avana para a prxima antena na lista
-    }
-
-    return efeitos; // Retorna a lista de efeitos nefastos
-}
-
-
+#pragma region Frequências
 /**
- * \brief Destri a lista de efeitos nefastos, liberando a memria alocada.
+ * \brief Devolve o id denso de uma frequência, atribuindo o seguinte se ainda não apareceu.
  *
- * \param lista Ponteiro para o incio da lista de efeitos nefastos.
+ * \param t Ponteiro para a tabela (inicialmente a zeros).
+ * \param freq Frequência (diferente de '\0').
+ * \return Id da frequência (0..t->numFreqs - 1).
  */
-bool DestruirListaEfeitos(EfeitoNefasto* lista) {
-    if (lista == NULL) {
-        return false; // Lista j estava vazia
-    }
-
-    while (lista != NULL) {
-        EfeitoNefasto* aux = lista; // Salva o ponteiro para o efeito nefasto a ser destrudo
-        lista = lista->prox;       // Avana para o prximo efeito nefasto na lista
-        free(aux);                 // Libera a memria do efeito nefasto destrudo
-    }
-
-    return true; // Lista destruda com sucesso
+int InternarFrequenciaTabela(TabelaFrequencias* t, char freq) {
+    uint8_t* id = &t->idDaFreq[(unsigned char)freq];
+    if (*id == 0) *id = (uint8_t)++t->numFreqs;
+    return *id - 1;
 }
 #pragma endregion
 
 #pragma region Grafo
+#ifdef ESTATISTICAS
+static unsigned long long profundidadeDFS = 0; // Profundidade atual de DFS_Recursivo
+#endif
 
 /**
  * \brief Cria um grafo.
@@ -382,88 +165,46 @@ GR* CriarGrafo() {
     if (g != NULL) {
         g->numVertices = 0;
         g->inicio = NULL;
+        g->armazem = NULL;
+        g->adjacentes = NULL;
+        g->capacidadeAdj = 0;
+        g->raio = 0;
+        g->interferencia = false;
+        g->versao = 0;
+        g->anteriorFreq = NULL;
+        g->seguinteFreq = NULL;
     }
     return g;
 }
 
-/**
- * \brief Cria um novo vrtice.
- *
- * \param id ID do vrtice.
- * \param freq Frequncia do vrtice.
- * \param x Coordenada x do vrtice.
- * \param y Coordenada y do vrtice.
- * \return Ponteiro para o novo vrtice criado.
- */
-Vertice* CriarVertice(int id, char freq, int x, int y) {
-    Vertice* v = (Vertice*)malloc(sizeof(Vertice));
-	if (v != NULL) { // Verifica se a memria foi alocada com sucesso
-        v->id = id;
-        v->freq = freq;
-        v->x = x;
-        v->y = y;
-        v->adjacentes = NULL;
-        v->prox = NULL;
-    }
-    return v;
-}
 /**
  * \brief Cria uma nova aresta.
  *
- * \param destino ID do vrtice de destino da aresta.
+ * \param destino ID do vértice de destino da aresta.
  * \return Ponteiro para a nova aresta criada.
  */
 Aresta* CriarAresta(int destino) {
     Aresta* a = (Aresta*)malloc(sizeof(Aresta));
-	if (a != NULL) {   // Verifica se a memria foi alocada com sucesso 
+    if (a != NULL) {   // Verifica se a memória foi alocada com sucesso
+        ESTAT_SOMAR(alocacoes, 1);
         a->destino = destino;
         a->prox = NULL;
     }
     return a;
 }
-/**
- * \brief Insere um vrtice no grafo.
- *
- * \param g Ponteiro para o grafo.
- * \param novo Ponteiro para o novo vrtice a ser inserido.
- */
-
-
-bool InserirVertice(GR* g, int id, char freq, int x, int y) {
-    if (g == NULL) return false;
-    if (x < 0 || x >= GRID_TAM || y < 0 || y >= GRID_TAM) return false;
-
-    // Verifica duplicados
-    Vertice* v = g->inicio; //
-    while (v != NULL) {
-        if (v->x == x && v->y == y) {
-            return false; // J existe vrtice nessas coordenadas
-        }
-        v = v->prox;
-    }
-
-    // Cria o novo vrtice
-    Vertice* novo = CriarVertice(id, freq, x, y);
-    if (novo == NULL) {
-		return false; // Falha ao alocar memria para o novo vrtice
-    }
 
-    // Insere no incio da lista
-    novo->prox = g->inicio;
-    g->inicio = novo;
-    g->numVertices++;
-    return true;
-}
 /**
- * \brief Encontra um vrtice no grafo pelo ID.
+ * \brief Encontra um vértice no grafo pelo ID.
  *
  * \param g Ponteiro para o grafo.
- * \param id ID do vrtice a ser encontrado.
- * \return Ponteiro para o vrtice encontrado ou NULL se no encontrado.
+ * \param id ID do vértice a ser encontrado.
+ * \return Ponteiro para o vértice encontrado ou NULL se não encontrado.
  */
 Vertice* EncontrarVerticePorId(GR* g, int id) {
+    ESTAT_SOMAR(procurasLista, 1);
     Vertice* v = g->inicio;
     while (v != NULL) {
+        ESTAT_SOMAR(nosPercorridos, 1);
         if (v->id == id) {
             return v;
         }
@@ -472,11 +213,15 @@ Vertice* EncontrarVerticePorId(GR* g, int id) {
     return NULL;
 }
 /**
- * \brief Mostra os vrtices do grafo.
+ * \brief Mostra os vértices do grafo.
  *
  * \param g Ponteiro para o grafo.
  */
 void MostrarVertices(GR* g) {
+    if (g != NULL && g->armazem != NULL) {
+        MostrarVerticesArmazem(g);
+        return;
+    }
     if (g == NULL || g->inicio == NULL) {
         printf("Grafo vazio.\n");
         return;
@@ -494,362 +239,22 @@ void MostrarVertices(GR* g) {
     }
 }
 
-/**
- * \brief Insere arestas entre o novo vrtice e os outros vrtices com a mesma frequncia.
- *
- * \param g Ponteiro para o grafo.
- * \param novo Ponteiro para o novo vrtice a ser inserido.
- * \return true se as arestas foram inseridas com sucesso, false caso contrrio.
- */
-bool InserirAresta(GR* g, Vertice* novo) {
-    if (g == NULL || novo == NULL) {
-        return false;
-	}
-    Vertice* v = g->inicio;
-    while (v != NULL) {
-		if (v != novo && v->freq == novo->freq) { // Verifica se o vrtice atual tem a mesma frequncia que o novo
-            // Verifica se j existe a ligao
-            Aresta* a = novo->adjacentes; 
-            while (a != NULL) {
-                if (a->destino == v->id) {
-                    break; // J existe, no cria
-                }
-                a = a->prox;
-            }
-			if (a == NULL) { // Se no encontrou aresta com o destino igual ao ID do vrtice atual
-                // Liga nos dois sentidos 
-                Aresta* a1 = CriarAresta(v->id);
-                if (a1 != NULL) {
-                    a1->prox = novo->adjacentes;
-                    novo->adjacentes = a1;
-                }
-                Aresta* a2 = CriarAresta(novo->id);
-                if (a2 != NULL) {
-                    a2->prox = v->adjacentes;
-                    v->adjacentes = a2;
-                }
-                return true; // Ligao criada
-            }
-        }
-        v = v->prox;
-    }
-    return false; // Nenhuma ligao criada
-}
-
-/**
- * \brief Remove arestas do vrtice com o ID especificado.
- *
- * \param g Ponteiro para o grafo.
- * \param id ID do vrtice cujas arestas sero removidas.
- * \return true se as arestas foram removidas com sucesso, false caso contrrio.
- */
-bool RemoverArestas(GR* g, int id) {
-    if (g == NULL){
-        return false;
-	}
-    Vertice* v = g->inicio;
-    // Remove arestas de outros vrtices que apontam para 'id'
-    while (v != NULL) {
-        if (v->id != id) {
-            Aresta* a = v->adjacentes; 
-            Aresta* ant = NULL;
-            while (a != NULL) {
-				if (a->destino == id) { // Verifica se a aresta aponta para o vrtice com o ID especificado
-                    if (ant != NULL) {
-						ant->prox = a->prox; // Remove a aresta do vrtice atual
-                    }
-                    else {
-                        v->adjacentes = a->prox; 
-                    }
-                    free(a);
-                    return true; // Removeu uma aresta, retorna imediatamente
-                }
-                ant = a;
-                a = a->prox;
-            }
-        }
-        v = v->prox;
-    }
-    // Remove todas as arestas do prprio vrtice
-    Vertice* alvo = g->inicio;
-    while (alvo != NULL && alvo->id != id) { 
-        alvo = alvo->prox;
-    }
-    if (alvo != NULL && alvo->adjacentes != NULL) {  
-        Aresta* a = alvo->adjacentes;  
-        while (a != NULL) {
-			Aresta* temp = a; // Salva o ponteiro da aresta a ser removida
-            a = a->prox;
-            free(temp); 
-            return true; // Removeu pelo menos uma aresta do prprio vrtice
-        }
-        alvo->adjacentes = NULL; 
-    }
-    return false; // No removeu nenhuma aresta
-}
-
-/**
- * \brief Remove um vrtice do grafo.
- *
- * \param g Ponteiro para o grafo.
- * \param id ID do vrtice a ser removido.
- * \return true se o vrtice foi removido com sucesso, false caso contrrio.
- */
-bool RemoverVertice(GR* g, int id) {
-    if (g == NULL || g->inicio == NULL) {
-        return false;
-	}
-    RemoverArestas(g, id);
-	Vertice* atual = g->inicio; // Ponteiro para percorrer a lista de vrtices
-    Vertice* anterior = NULL;
-    while (atual != NULL && atual->id != id) {
-		anterior = atual; // Salva o ponteiro do vrtice anterior
-        atual = atual->prox;
-    }
-    if (atual == NULL) {
-        return false;
-	}
-    if (anterior != NULL) {
-        anterior->prox = atual->prox;
-    }
-    else {
-		g->inicio = atual->prox; // Se o vrtice a ser removido  o primeiro
-    }
-    free(atual);
-    g->numVertices--;
-    return true;
-}
-
-
-/**
- * \brief Verifica se existem antenas com a mesma frequncia e calcula os efeitos nefastos.
- *
- * \param inicio Ponteiro para o incio da lista de vrtices.
- * \return Ponteiro para o incio da lista de efeitos nefastos.
- */
-
-EfeitoNefasto* efeitoNefastoVertices(Vertice* inicio) {
-    if (inicio == NULL) {
-        return NULL;
-    }
-
-    EfeitoNefasto* efeitos = NULL;
-    EfeitoNefasto* aux;
-    Vertice* current = inicio;
-    Vertice* compare;
-
-    while (current != NULL) {
-        compare = current->prox;
-        while (compare != NULL) {
-            if (current->freq == compare->freq) {
-                if ((current->x == compare->x) && (current->y != compare->y)) {
-                    int subtracao = current->y - compare->y;
-                    int nefy = current->y + subtracao;
-                    int nefy1 = compare->y - subtracao;
-                    aux = CriarEfeito(current->x, nefy);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                    aux = CriarEfeito(compare->x, nefy1);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                }
-                else if ((current->x != compare->x) && (current->y == compare->y)) {
-                    int subtracao = current->x - compare->x;
-                    int nefx = current->x + subtracao;
-                    int nefx1 = compare->x - subtracao;
-                    aux = CriarEfeito(nefx, current->y);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                    aux = CriarEfeito(nefx1, compare->y);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                }
-                else if ((current->x != compare->x) && (current->y != compare->y)) {
-                    int subtracaox = current->x - compare->x;
-                    int subtracaoy = current->y - compare->y;
-                    int nefx = current->x + subtracaox;
-                    int nefx1 = compare->x - subtracaox;
-                    int nefy = current->y + subtracaoy;
-                    int nefy1 = compare->y - subtracaoy;
-                    aux = CriarEfeito(nefx, nefy);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                    aux = CriarEfeito(nefx1, nefy1);
-                    efeitos = InserirEfeito(efeitos, aux->x, aux->y);
-                }
-            }
-            compare = compare->prox;
-        }
-        current = current->prox;
-    }
-
-    return efeitos;
-}
-
-/**
- * \brief Salva o grafo em um ficheiro de texto.
- *
- * \param lista Ponteiro para a lista de vrtices.
- * \param nomeFicheiro Nome do ficheiro onde o grafo ser salvo.
- * \return true se o salvamento foi bem-sucedido, false caso contrrio.
- */
-
-bool SalvarGrafoEmTxt(Vertice* lista, const char* nomeFicheiro) {
-    FILE* ficheiro = fopen(nomeFicheiro, "w");
-    if (ficheiro == NULL) {
-        return false;
-    }
-    for (int i = 0; i < GRID_TAM; i++) {
-        for (int j = 0; j < GRID_TAM; j++) {
-            char simbolo = '.'; 
-			Vertice* aux = lista; // Inicializa o ponteiro auxiliar para percorrer a lista de vrtices
-            while (aux != NULL) { 
-                if (aux->x == j && aux->y == i) { 
-                    simbolo = aux->freq; 
-					break;  // Se encontrou o vrtice, armazena a frequncia
-                }
-                aux = aux->prox;
-            }
-            fprintf(ficheiro, "%c ", simbolo);
-        }
-        fprintf(ficheiro, "\n");
-    }
-    fclose(ficheiro);
-    return true;
-}
-
-/**
- * \brief Carrega o grafo de um ficheiro de texto.
- *
- * \param nomeFicheiro Nome do ficheiro de texto a ser carregado.
- * \return Ponteiro para a lista de vrtices ou NULL se ocorrer um erro.
- */
-
-Vertice* CarregarGrafoDeTxt(const char* nomeFicheiro) {
-    FILE* ficheiro = fopen(nomeFicheiro, "r");
-    if (ficheiro == NULL) {
-        return NULL;
-    }
-    Vertice* lista = NULL; 
-	int id = 1; // Inicializa o ID dos vrtices
-    for (int i = 0; i < GRID_TAM; i++) {
-        for (int j = 0; j < GRID_TAM; j++) {
-            char simbolo;
-			fscanf(ficheiro, " %c", &simbolo); // L o smbolo do ficheiro
-            if (simbolo != '.') {
-				Vertice* novo = CriarVertice(id++, simbolo, j, i); // Cria um novo vrtice
-                novo->prox = lista; 
-                lista = novo;
-            }
-        }
-    }
-    fclose(ficheiro);
-    return lista;
-}
-
-/**
- * \brief Salva o grafo em um ficheiro binrio.
- *
- * \param lista Ponteiro para a lista de vrtices.
- * \param nomeFicheiro Nome do ficheiro onde o grafo ser salvo.
- * \return true se o salvamento foi bem-sucedido, false caso contrrio.
- */
-
-bool SalvarGrafoEmBin(Vertice* lista, const char* nomeFicheiro) {
-    FILE* ficheiro = fopen(nomeFicheiro, "wb");
-    if (ficheiro == NULL) {
-        return false;
-    }
-
-    Vertice* aux = lista;
-    while (aux != NULL) { // Percorre a lista de vrtices
-        fwrite(&(aux->freq), sizeof(char), 1, ficheiro);
-        fwrite(&(aux->x), sizeof(int), 1, ficheiro);
-        fwrite(&(aux->y), sizeof(int), 1, ficheiro);
-        aux = aux->prox;
-    }
-
-    fclose(ficheiro);
-    return true;
-}
-
-Vertice* CarregarGrafoDeBin(const char* nomeFicheiro) {
-    FILE* ficheiro = fopen(nomeFicheiro, "rb");
-    if (ficheiro == NULL) {
-        return NULL;
-    }
-    Vertice* lista = NULL;
-    char freq;
-    int x, y;
-    int id = 1;
-    while (fread(&freq, sizeof(char), 1, ficheiro) == 1 &&
-        fread(&x, sizeof(int), 1, ficheiro) == 1 &&
-        fread(&y, sizeof(int), 1, ficheiro) == 1) {
-        Vertice* novo = CriarVertice(id++, freq, x, y);
-        novo->prox = lista;
-        lista = novo;
-    }
-    fclose(ficheiro);
-    return lista;
-}
-
-/**
- * \brief Mostra o grid com as antenas e os efeitos nefastos.
- *
- * \param listaVertices Ponteiro para a lista de vrtices.
- * \return true se a exibio foi bem-sucedida, false caso contrrio.
- */
-
-bool MostrarGrid(Vertice* listaVertices) {
-    if (listaVertices == NULL) {
-        printf("Grafo vazio.\n");
-        return false;
-    }
-
-    // Calcula os efeitos nefastos a partir dos vrtices
-    EfeitoNefasto* efeitos = efeitoNefastoVertices(listaVertices);
-
-    for (int i = 0; i < GRID_TAM; i++) {
-        for (int j = 0; j < GRID_TAM; j++) {
-            char simbolo = '.';
-
-            // Procura vrtice
-            Vertice* aux = listaVertices;
-            while (aux != NULL) {
-                if (aux->x == j && aux->y == i) {
-                    simbolo = aux->freq;
-                    break;
-                }
-                aux = aux->prox;
-            }
-
-            // Se no encontrou vrtice, procura efeito nefasto
-            if (simbolo == '.') {
-                EfeitoNefasto* auxEfeito = efeitos;
-                while (auxEfeito != NULL) {
-                    if (auxEfeito->x == j && auxEfeito->y == i) {
-                        simbolo = '#';
-                        break;
-                    }
-                    auxEfeito = auxEfeito->prox;
-                }
-            }
-
-            printf("%c ", simbolo);
-        }
-        printf("\n");
-    }
-
-    DestruirListaEfeitos(efeitos);
-    return true;
-}
-
 /**
  * \brief Realiza uma busca em profundidade recursiva no grafo.
  *
  * \param g Ponteiro para o grafo.
- * \param v Ponteiro para o vrtice atual.
- * \param visitado Array de booleanos para marcar os vrtices visitados.
+ * \param v Ponteiro para o vértice atual.
+ * \param visitado Array de booleanos para marcar os vértices visitados.
  */
 void DFS_Recursivo(GR* g, Vertice* v, bool* visitado) {
     if (v == NULL) {
         return;
     }
+#ifdef ESTATISTICAS
+    profundidadeDFS++;
+    ESTAT_MAXIMO(fronteiraMaxDFS, profundidadeDFS);
+    ESTAT_SOMAR(verticesVisitados, 1);
+#endif
 
     visitado[v->id] = true;
     printf("Antena ID %d\n", v->id);
@@ -865,17 +270,27 @@ void DFS_Recursivo(GR* g, Vertice* v, bool* visitado) {
 
         a = a->prox;
     }
+#ifdef ESTATISTICAS
+    profundidadeDFS--;
+#endif
 }
 /**
- * \brief Realiza uma busca em profundidade no grafo a partir de um vrtice de origem.
+ * \brief Realiza uma busca em profundidade no grafo a partir de um vértice de origem.
  *
  * \param g Ponteiro para o grafo.
- * \param idOrigem ID do vrtice de origem.
+ * \param idOrigem ID do vértice de origem.
  */
 void ProcuraProfundidade(GR* g, int idOrigem) {
     if (g == NULL) {
         return;
     }
+    if (g->armazem != NULL) {
+        ProcuraProfundidadeArmazem(g, idOrigem);
+        return;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_SOMAR(procurasGrafo, 1);
+    ESTAT_INICIO(inicio);
 
     int maxId = 0;
     Vertice* v = g->inicio; 
@@ -896,17 +311,18 @@ void ProcuraProfundidade(GR* g, int idOrigem) {
         DFS_Recursivo(g, origem, visitado);
     }
     else {
-        printf("Antena de origem no encontrada.\n");
+        printf("Antena de origem não encontrada.\n");
     }
 
     free(visitado);
+    ESTAT_FIM(nsProcuras, inicio);
 }
 
 /**
- * \brief Realiza uma busca em largura no grafo a partir de um vrtice de origem.
+ * \brief Realiza uma busca em largura no grafo a partir de um vértice de origem.
  *
  * \param g Ponteiro para o grafo.
- * \param idOrigem ID do vrtice de origem.
+ * \param idOrigem ID do vértice de origem.
  */
 
 
@@ -916,6 +332,14 @@ void ProcuraLargura(GR* g, int idOrigem)
     {
         return;
     }
+    if (g->armazem != NULL)
+    {
+        ProcuraLarguraArmazem(g, idOrigem);
+        return;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_SOMAR(procurasGrafo, 1);
+    ESTAT_INICIO(inicioTempo);
 
     // Descobre o maior id para alocar o vetor de visitados
     int maxId = 0;
@@ -933,8 +357,9 @@ void ProcuraLargura(GR* g, int idOrigem)
     Vertice* origem = EncontrarVerticePorId(g, idOrigem);
     if (origem == NULL)
     {
-        printf("Antena de origem no encontrada.\n");
+        printf("Antena de origem não encontrada.\n");
         free(visitado);
+        ESTAT_FIM(nsProcuras, inicioTempo);
         return;
     }
 
@@ -950,6 +375,7 @@ void ProcuraLargura(GR* g, int idOrigem)
     while (inicio < fim)
     {
         int idAtual = fila[inicio++];
+        ESTAT_SOMAR(verticesVisitados, 1);
         Vertice* atual = EncontrarVerticePorId(g, idAtual);
         if (atual != NULL)
         {
@@ -963,6 +389,7 @@ void ProcuraLargura(GR* g, int idOrigem)
             {
                 fila[fim++] = a->destino;
                 visitado[a->destino] = true;
+                ESTAT_MAXIMO(fronteiraMaxBFS, fim - inicio);
             }
             a = a->prox;
         }
@@ -970,17 +397,29 @@ void ProcuraLargura(GR* g, int idOrigem)
 
     free(fila);
     free(visitado);
+    ESTAT_FIM(nsProcuras, inicioTempo);
 }
 
 /**
- * \brief Destri o grafo, liberando a memria alocada.
+ * \brief Destrói o grafo, liberando a memória alocada.
  *
- * \param g Ponteiro para o grafo a ser destrudo.
- * \return true se o grafo foi destrudo com sucesso, false caso contrrio.
+ * \param g Ponteiro para o grafo a ser destruído.
+ * \return true se o grafo foi destruído com sucesso, false caso contrário.
  */
 
 bool DestruirGrafo(GR* g) {
     if (g != NULL) {
+        for (int i = 0; i < g->capacidadeAdj; i++) { // Adjacências do modo armazém (o armazém não pertence ao grafo)
+            Aresta* a = g->adjacentes[i];
+            while (a != NULL) {
+                Aresta* tempA = a;
+                a = a->prox;
+                free(tempA);
+            }
+        }
+        free(g->adjacentes);
+        free(g->anteriorFreq);
+        free(g->seguinteFreq);
         Vertice* v = g->inicio;
         while (v != NULL) {
             Aresta* a = v->adjacentes;
@@ -4,38 +4,194 @@
 // --- Antenas ---
 Antena* CriarAntena(char freq, int x, int y);
 Antena* InserirAntena(Antena* inicio, char freq, int x, int y);
-Antena* RemoverAntena(Antena* h, char freq, int x, int y, int* removida);
-Antena* ListarAntenas(Antena* lista, EfeitoNefasto* efeitos);
-bool SalvarAntenasEmTxt(Antena* lista, const char* nomeFicheiro);
 Antena* CarregarAntenasDeTxt(const char* nomeFicheiro);
-bool SalvarAntenasEmFicheiroBin(Antena* lista);
 Antena* CarregarAntenasDeBin(const char* nomeFicheiro);
 bool DestruirListaAntenas(Antena* h);
 
-// --- Efeitos Nefastos ---
-EfeitoNefasto* CriarEfeito(int x, int y);
-EfeitoNefasto* InserirEfeito(EfeitoNefasto* inicio, int x, int y);
-EfeitoNefasto* efeitoNefasto(Antena* inicio);
-EfeitoNefasto* efeitoNefastoVertices(Vertice* inicio);
-bool DestruirListaEfeitos(EfeitoNefasto* lista);
+// --- Frequências ---
+int InternarFrequenciaTabela(TabelaFrequencias* t, char freq);
 
 // --- Grafo ---
 GR* CriarGrafo();
-Vertice* CriarVertice(int id, char freq, int x, int y);
 Aresta* CriarAresta(int destino);
-bool InserirVertice(GR* g, int id, char freq, int x, int y);
 Vertice* EncontrarVerticePorId(GR* g, int id);
 void MostrarVertices(GR* g);
-bool InserirAresta(GR* g, Vertice* novo);
-bool RemoverArestas(GR* g, int id);
-bool RemoverVertice(GR* g, int id);
-EfeitoNefasto* efeitoNefastoVertices(Vertice* inicio);
-bool SalvarGrafoEmTxt(Vertice* lista, const char* nomeFicheiro);
-Vertice* CarregarGrafoDeTxt(const char* nomeFicheiro);
-bool SalvarGrafoEmBin(Vertice* lista, const char* nomeFicheiro);
-Vertice* CarregarGrafoDeBin(const char* nomeFicheiro);
-bool MostrarGrid(Vertice* listaVertices);
 void DFS_Recursivo(GR* g, Vertice* v, bool* visitado);
 void ProcuraProfundidade(GR* g, int idOrigem);
 void ProcuraLargura(GR* g, int idOrigem);
 bool DestruirGrafo(GR* g);
+
+// --- Snapshots comprimidos ---
+uint64_t CodigoMorton(uint32_t x, uint32_t y);
+void DescodificarMorton(uint64_t m, uint32_t* x, uint32_t* y);
+int EscreverVarint(uint8_t* buf, uint64_t v);
+const uint8_t* LerVarint(const uint8_t* buf, const uint8_t* fim, uint64_t* v);
+bool SalvarAntenasComprimidas(Antena* lista, const char* nomeFicheiro);
+Antena* CarregarAntenasComprimidas(const char* nomeFicheiro);
+int LerBlocoComprimido(const char* nomeFicheiro, int bloco, char* freq, int* x, int* y);
+bool SalvarColunasComprimidas(const char* nomeFicheiro, const char* freq, const CoordAntena* x, const CoordAntena* y, int n);
+LoteAntenas* CarregarLoteComprimido(const char* nomeFicheiro);
+
+// --- Carregamento paralelo ---
+LoteAntenas* CriarLote(int capacidade);
+bool AcrescentarAoLote(LoteAntenas* lote, char freq, int x, int y);
+bool DestruirLote(LoteAntenas* lote);
+int NumeroProcessadores();
+long long TamanhoFicheiro(FILE* ficheiro);
+LoteAntenas* CarregarLoteParalelo(const char* nomeFicheiro, bool binario, int numThreads);
+Antena* CarregarAntenasDeTxtParalelo(const char* nomeFicheiro, int numThreads);
+Antena* CarregarAntenasDeBinParalelo(const char* nomeFicheiro, int numThreads);
+
+// --- Armazém de antenas ---
+ArmazemAntenas* CriarArmazem(int largura, int altura);
+int InserirAntenaArmazem(ArmazemAntenas* a, char freq, int x, int y);
+int InserirAntenasEmLote(ArmazemAntenas* a, const char* freq, const int* x, const int* y, int n, signed char* estado);
+int ProcurarAntenaArmazem(const ArmazemAntenas* a, int x, int y);
+bool RemoverAntenaArmazem(ArmazemAntenas* a, int slot);
+bool ListarAntenasArmazemModo(ArmazemAntenas* a, int modo);
+bool MostrarJanelaArmazem(ArmazemAntenas* a, FILE* destino, int x0, int y0, int largura, int altura, int fator, int modo);
+bool ExportarImagemArmazem(ArmazemAntenas* a, const char* nomeFicheiro, int formato, int fator, int modo);
+bool SalvarArmazemEmTxt(const ArmazemAntenas* a, const char* nomeFicheiro);
+bool SalvarArmazemEmBin(const ArmazemAntenas* a, const char* nomeFicheiro);
+bool SalvarArmazemComprimido(const ArmazemAntenas* a, const char* nomeFicheiro);
+bool SalvarArmazemComPrefixo(const ArmazemAntenas* a, const char* prefixo);
+ArmazemAntenas* CriarArmazemDeLote(LoteAntenas* lote);
+ArmazemAntenas* CarregarArmazemDeTxt(const char* nomeFicheiro);
+ArmazemAntenas* CarregarArmazemDeBin(const char* nomeFicheiro);
+ArmazemAntenas* CarregarArmazemComprimido(const char* nomeFicheiro);
+ArmazemAntenas* CopiarArmazem(const ArmazemAntenas* a);
+size_t MemoriaArmazem(const ArmazemAntenas* a);
+bool DestruirArmazem(ArmazemAntenas* a);
+int IdFrequencia(const ArmazemAntenas* a, char freq);
+int NumeroFrequencias(const ArmazemAntenas* a);
+
+// --- Baldes em ordem de Morton ---
+bool AtivarOrdemMorton(ArmazemAntenas* a);
+bool InserirNoBalde(ArmazemAntenas* a, int slot);
+void RemoverDoBalde(ArmazemAntenas* a, int slot);
+bool ReconstruirBaldes(ArmazemAntenas* a);
+void DestruirBaldes(ArmazemAntenas* a);
+int ConsultarRetanguloFreq(const ArmazemAntenas* a, char freq, int x0, int y0, int x1, int y1, int* slots, int max);
+int ConsultarRetangulo(const ArmazemAntenas* a, int x0, int y0, int x1, int y1, int* slots, int max);
+int AntenasMaisProximas(const ArmazemAntenas* a, char freq, int x, int y, int k, int* slots);
+
+// --- Conjunto de efeitos e modos do motor ---
+ConjuntoEfeitos* CriarConjuntoEfeitos(int largura, int altura);
+bool DestruirConjuntoEfeitos(ConjuntoEfeitos* c);
+void MarcarEfeito(ConjuntoEfeitos* c, int x, int y);
+bool TemEfeito(const ConjuntoEfeitos* c, int x, int y);
+long long ContarConjuntoEfeitos(const ConjuntoEfeitos* c);
+int RasterizarReta(ConjuntoEfeitos* c, int xa, int ya, int xb, int yb);
+ConjuntoEfeitos* CalcularConjuntoEfeitos(const ArmazemAntenas* a, int modo);
+const ConjuntoEfeitos* EfeitosEmCache(ArmazemAntenas* a, int modo);
+void LimparCacheEfeitos(ArmazemAntenas* a);
+
+int ContarBits(uint64_t v);
+int IndiceBitMenor(uint64_t v);
+
+// --- Motor de bitboards ---
+MotorBitboard* CriarMotorBitboard(const ArmazemAntenas* a);
+bool DestruirMotorBitboard(MotorBitboard* m);
+bool EfeitosBitboard(const MotorBitboard* m, ConjuntoEfeitos* c);
+bool ListarBitboard(const MotorBitboard* m, const ConjuntoEfeitos* c);
+
+// --- Gerador de efeitos ---
+GeradorEfeitos* CriarGeradorEfeitos(const char* freq, const CoordAntena* x, const CoordAntena* y, int n);
+GeradorEfeitos* CriarGeradorEfeitosArmazem(const ArmazemAntenas* a);
+int ProximosEfeitos(GeradorEfeitos* g, int* xs, int* ys, int max);
+bool DestruirGeradorEfeitos(GeradorEfeitos* g);
+bool MarcarEfeitosArmazem(const ArmazemAntenas* a, ConjuntoEfeitos* c, int modo);
+long long ContarEfeitosArmazem(const ArmazemAntenas* a);
+bool ExportarEfeitosArmazem(const ArmazemAntenas* a, const char* nomeFicheiro);
+
+// --- Índice de regiões ---
+IndiceRegioes* CriarIndiceRegioes(ArmazemAntenas* a);
+bool ReconstruirIndiceRegioes(ArmazemAntenas* a);
+bool DestruirIndiceRegioes(ArmazemAntenas* a);
+void RegioesAntenaInserida(ArmazemAntenas* a, int slot);
+void RegioesAntenaRemovida(ArmazemAntenas* a, int slot);
+long long ContarAntenasRegiao(const ArmazemAntenas* a, int x0, int y0, int x1, int y1);
+long long ContarEfeitosRegiao(const ArmazemAntenas* a, int x0, int y0, int x1, int y1);
+bool CelulaComEfeito(const ArmazemAntenas* a, int x, int y);
+int CausasEfeitoFreq(const ArmazemAntenas* a, char freq, int cx, int cy, int* proximas, int* distantes, int max);
+int CausasEfeito(const ArmazemAntenas* a, int cx, int cy, int* proximas, int* distantes, int max);
+
+// --- Grafo sobre o armazém ---
+int IdVertice(const ArmazemAntenas* a, int slot);
+int SlotDoVertice(const ArmazemAntenas* a, int id);
+GR* CriarGrafoSobreArmazem(ArmazemAntenas* a);
+GR* CriarGrafoRaio(ArmazemAntenas* a, int raio);
+GR* CriarGrafoInterferencia(ArmazemAntenas* a);
+GR* CopiarGrafoArmazem(const GR* g, ArmazemAntenas* copia);
+bool ReconstruirInterferencias(GR* g);
+bool LigarInterferencias(GR* g, int slot);
+void DesligarInterferencias(GR* g, int slot);
+int InserirVerticeArmazem(GR* g, char freq, int x, int y);
+bool RemoverVerticeArmazem(GR* g, int id);
+void MostrarVerticesArmazem(GR* g);
+void ProcuraProfundidadeArmazem(GR* g, int idOrigem);
+void ProcuraLarguraArmazem(GR* g, int idOrigem);
+int PercorrerProfundidadeArmazem(const GR* g, int idOrigem, int* ordem);
+int PercorrerLarguraArmazem(const GR* g, int idOrigem, int* ordem);
+
+// --- Estatísticas ---
+bool EstatisticasAtivas();
+unsigned long long RelogioNs();
+void RegistarBytesEscritos(FILE* ficheiro);
+void ContarParesBaldes(const int* inicio, int numBaldes);
+void ReiniciarEstatisticas();
+void MostrarEstatisticas();
+bool ExportarEstatisticasJson(const char* nomeFicheiro);
+
+// --- Rastreios de sessões ---
+Rastreio* CriarRastreio(const char* nomeFicheiro);
+bool RegistarOperacao(Rastreio* r, int tipo, char freq, int a0, int a1, int a2, int a3);
+bool RegistarEstadoInicial(Rastreio* r, const ArmazemAntenas* a);
+bool FecharRastreio(Rastreio* r);
+OperacaoRastreio* CarregarRastreio(const char* nomeFicheiro, int* n);
+const char* NomeOperacaoRastreio(int tipo);
+bool ExecutarOperacaoRastreio(ArmazemAntenas* a, GR** g, const OperacaoRastreio* op, const char* prefixo);
+
+// --- Versões para leitores concorrentes ---
+PublicadorVersoes* CriarPublicadorVersoes();
+bool PublicarVersao(PublicadorVersoes* p, const ArmazemAntenas* a, const GR* g);
+int RegistarLeitor(PublicadorVersoes* p);
+void RemoverLeitor(PublicadorVersoes* p, int leitor);
+const VersaoArmazem* IniciarLeitura(PublicadorVersoes* p, int leitor);
+void TerminarLeitura(PublicadorVersoes* p, int leitor);
+int RecolherVersoes(PublicadorVersoes* p);
+bool DestruirPublicadorVersoes(PublicadorVersoes* p);
+
+// --- Armazém fragmentado ---
+ArmazemFragmentado* CriarArmazemFragmentado(int largura, int altura, int numFragmentos);
+int NumeroFragmentos(const ArmazemFragmentado* f);
+int InserirAntenaFragmentado(ArmazemFragmentado* f, char freq, int x, int y);
+int InserirAntenasEmLoteFragmentado(ArmazemFragmentado* f, const char* freq, const int* x, const int* y, int n, signed char* estado);
+bool RemoverAntenaFragmentado(ArmazemFragmentado* f, int x, int y);
+char ProcurarAntenaFragmentado(ArmazemFragmentado* f, int x, int y);
+int ContarAntenasFragmentado(ArmazemFragmentado* f);
+ArmazemAntenas* CriarVistaGlobal(ArmazemFragmentado* f);
+bool DestruirArmazemFragmentado(ArmazemFragmentado* f);
+
+// --- Protocolo do servidor ---
+int CodificarPedido(uint8_t* buf, const PedidoServidor* p);
+const uint8_t* DescodificarPedido(const uint8_t* buf, const uint8_t* fim, PedidoServidor* p);
+int CodificarResposta(uint8_t* buf, const RespostaServidor* r);
+const uint8_t* DescodificarResposta(const uint8_t* buf, const uint8_t* fim, RespostaServidor* r);
+const char* NomePedido(int tipo);
+int ArgumentosPedido(int tipo);
+ServidorAntenas* CriarServidorAntenas(ArmazemAntenas* a, GR* g, const char* prefixo);
+int RegistarLeitorServidor(ServidorAntenas* s);
+void RemoverLeitorServidor(ServidorAntenas* s, int leitor);
+bool ExecutarPedido(ServidorAntenas* s, int leitor, const PedidoServidor* p, RespostaServidor* r);
+bool DestruirServidorAntenas(ServidorAntenas* s);
+
+// --- Armazém em disco por tiles ---
+ArmazemTiles* CriarArmazemTiles(const char* nomeBase, const char* ficheiroBin, int largura, int altura, int lado);
+ArmazemTiles* AbrirArmazemTiles(const char* nomeBase);
+bool FecharArmazemTiles(ArmazemTiles* t);
+long long NumeroAntenasTiles(const ArmazemTiles* t);
+long long ContarEfeitosTiles(const ArmazemTiles* t);
+char ProcurarAntenaTiles(ArmazemTiles* t, int x, int y);
+bool CelulaComEfeitoTiles(ArmazemTiles* t, int x, int y);
+long long CalcularEfeitosTiles(ArmazemTiles* t);
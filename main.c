@@ -1,6 +1,6 @@
 /*****************************************************************//**
  * \file   main.c
- * \brief  Programa principal para manipulao de antenas e efeitos nefastos.
+ * \brief  Programa principal para manipulação de antenas e efeitos nefastos.
  *
  * \author matos
  * \date   March 2025
@@ -17,43 +17,84 @@
 #include "funcoes.h"
 
 
-int main() {
-    Antena* lista = NULL;
-    EfeitoNefasto* efeitos = NULL;
-    GR* grafo = CriarGrafo();
+/**
+ * \brief Atualiza os ficheiros de antenas (BIN, TXT e snapshot comprimido).
+ *
+ * \param armazem Ponteiro para o armazém de antenas.
+ * \param rastreio Rastreio da sessão (NULL se a captura não estiver ativa).
+ */
+static void SalvarAntenas(ArmazemAntenas* armazem, Rastreio* rastreio) {
+    RegistarOperacao(rastreio, RASTREIO_SALVAR, 0, 0, 0, 0, 0);
+    SalvarArmazemEmBin(armazem, "antenas.bin");
+    SalvarArmazemEmTxt(armazem, "antenas.txt");
+    SalvarArmazemComprimido(armazem, "antenas.zbin");
+}
+
+int main(int argc, char** argv) {
+    ArmazemAntenas* armazem = NULL;
     int opcao;
     int op_antena;
     int op_grafo;
-    int id_counter = 1;
+    int modoEfeitos = EFEITOS_PONTOS;
 
 
-	//Carregar antenas
+	//Carregar antenas (o mesmo armazém serve a lista de antenas e o grafo)
 
-    lista = CarregarAntenasDeBin("antenas.bin");
-    if (lista != NULL) {
-        printf("Antenas carregadas automaticamente do ficheiro BIN.\n");
+    armazem = CarregarArmazemComprimido("antenas.zbin");
+    if (armazem != NULL) {
+        printf("Antenas carregadas automaticamente do snapshot comprimido.\n");
     }
     else {
-        lista = CarregarAntenasDeTxt("antenas.txt");
-        if (lista != NULL) {
-            printf("Antenas carregadas automaticamente do ficheiro TXT.\n");
+        armazem = CarregarArmazemDeBin("antenas.bin");
+        if (armazem != NULL) {
+            printf("Antenas carregadas automaticamente do ficheiro BIN.\n");
         }
         else {
-            printf("Nenhum ficheiro de antenas encontrado. Lista vazia.\n");
+            armazem = CarregarArmazemDeTxt("antenas.txt");
+            if (armazem != NULL) {
+                printf("Antenas carregadas automaticamente do ficheiro TXT.\n");
+            }
+            else {
+                armazem = CriarArmazem(GRID_TAM, GRID_TAM);
+                printf("Nenhum ficheiro de antenas encontrado. Lista vazia.\n");
+            }
         }
     }
-	// Carregar grafo
-    Vertice* vertices = CarregarGrafoDeBin("grafo.bin");
-    if (vertices != NULL) {
-        printf("Grafo carregado automaticamente do ficheiro BIN.\n");
+    AtivarOrdemMorton(armazem);
+    CriarIndiceRegioes(armazem);
+	// O grafo é um índice sobre o armazém
+    GR* grafo = CriarGrafoSobreArmazem(armazem);
+
+    // Exportação de imagem sem menu (programa --imagem ficheiro.ppm|ficheiro.pgm [fator])
+    if (argc > 2 && strcmp(argv[1], "--imagem") == 0) {
+        const char* extensao = strrchr(argv[2], '.');
+        int formato = extensao != NULL && strcmp(extensao, ".pgm") == 0 ? IMAGEM_PGM : IMAGEM_PPM;
+        int fator = argc > 3 ? atoi(argv[3]) : 1;
+        bool exportada = ExportarImagemArmazem(armazem, argv[2], formato, fator, modoEfeitos);
+        printf(exportada ? "Imagem exportada para %s.\n" : "Nao foi possivel exportar %s.\n", argv[2]);
+        DestruirGrafo(grafo);
+        DestruirArmazem(armazem);
+        return exportada ? 0 : 1;
     }
-    else {
-        vertices = CarregarGrafoDeTxt("grafo.txt");
-        if (vertices != NULL) {
-            printf("Grafo carregado automaticamente do ficheiro TXT.\n");
+
+    // Exportação dos efeitos sem menu (programa --efeitos ficheiro.txt), em memória constante
+    if (argc > 2 && strcmp(argv[1], "--efeitos") == 0) {
+        bool exportados = ExportarEfeitosArmazem(armazem, argv[2]);
+        printf(exportados ? "Efeitos exportados para %s.\n" : "Nao foi possivel exportar %s.\n", argv[2]);
+        DestruirGrafo(grafo);
+        DestruirArmazem(armazem);
+        return exportados ? 0 : 1;
+    }
+
+    // Captura da sessão (programa --rastreio ficheiro), para reproduzir offline com benchmark/reproduzir
+    Rastreio* rastreio = NULL;
+    if (argc > 2 && strcmp(argv[1], "--rastreio") == 0) {
+        rastreio = CriarRastreio(argv[2]);
+        if (rastreio != NULL && RegistarEstadoInicial(rastreio, armazem)) {
+            printf("Sessao a ser gravada em %s.\n", argv[2]);
         }
         else {
-            printf("Nenhum ficheiro de grafo encontrado. Grafo vazio.\n");
+            printf("Nao foi possivel criar o rastreio %s.\n", argv[2]);
         }
     }
 
@@ -61,7 +102,8 @@ int main() {
         printf("\n--- MENU PRINCIPAL ---\n");
         printf("1 - Menu Antenas\n");
         printf("2 - Menu Grafo\n");
-        printf("3 - Sair\n");
+        printf("3 - Estatisticas\n");
+        printf("4 - Sair\n");
         printf("Escolha uma opcao: ");
         scanf("%d", &opcao);
 
@@ -71,7 +113,12 @@ int main() {
                 printf("1 - Inserir Antena\n");
                 printf("2 - Remover Antena\n");
                 printf("3 - Listar Antenas\n");
-                printf("4 - Voltar\n");
+                printf("4 - Consultar Regiao\n");
+                printf("5 - Causas de um Efeito\n");
+                printf("6 - Antenas Mais Proximas\n");
+                printf("7 - Modo de Efeitos (%s)\n", modoEfeitos == EFEITOS_HARMONICOS ? "harmonicos" : "pontos");
+                printf("8 - Mostrar Janela\n");
+                printf("9 - Voltar\n");
                 printf("Escolha uma opcao: ");
                 scanf("%d", &op_antena);
 
@@ -85,19 +132,22 @@ int main() {
                     scanf("%d", &x);
                     printf("Coordenada Y: ");
                     scanf("%d", &y);
-                    Antena* resultado = InserirAntena(lista, freq, x, y); 
-                    if (resultado == NULL) {
-                        printf("Coordenadas fora do grid 10x10!\n");
+                    RegistarOperacao(rastreio, RASTREIO_INSERIR_ANTENA, freq, x, y, 0, 0);
+                    int resultado = InserirVerticeArmazem(grafo, freq, x, y);
+                    if (resultado == ARMAZEM_FORA_GRID) {
+                        printf("Coordenadas fora do grid %dx%d!\n", GRID_TAM, GRID_TAM);
                     }
-                    else if (resultado != lista) {
-                        lista = resultado;
-                        printf("\nAntena inserida!\n");
+                    else if (resultado == ARMAZEM_DUPLICADA) {
+                        printf("Ja existe uma antena nas coordenadas (%d, %d).\n", x, y);
+                    }
+                    else if (resultado == ARMAZEM_SEM_MEMORIA) {
+                        printf("Sem memoria para inserir a antena!\n");
                     }
                     else {
-                        printf("Ja existe uma antena nas coordenadas (%d, %d).\n", x, y);
+                        printf("\nAntena inserida!\n");
+                        // Só grava quando o armazém mudou
+                        SalvarAntenas(armazem, rastreio);
                     }
-                    SalvarAntenasEmFicheiroBin(lista);
-                    SalvarAntenasEmTxt(lista, "antenas.txt");
                     break;
                 }
 				case 2: { // Remover Antena
@@ -109,35 +159,115 @@ int main() {
                     scanf("%d", &x);
                     printf("Coordenada Y: ");
                     scanf("%d", &y);
+                    RegistarOperacao(rastreio, RASTREIO_REMOVER_ANTENA, freq, x, y, 0, 0);
+                    int slot = ProcurarAntenaArmazem(armazem, x, y);
                     int removida = 0;
-                    lista = RemoverAntena(lista, freq, x, y, &removida);
-                    SalvarAntenasEmFicheiroBin(lista);
-                    SalvarAntenasEmTxt(lista, "antenas.txt");
+                    if (slot >= 0 && armazem->freq[slot] == freq) {
+                        removida = RemoverVerticeArmazem(grafo, IdVertice(armazem, slot));
+                    }
+                    SalvarAntenas(armazem, rastreio);
                     if (removida != 0)
                         printf("Antena removida.\n");
                     else
-                        printf("Antena no encontrada.\n");
+                        printf("Antena não encontrada.\n");
                     break;
                 }
                 case 3: { // Listar Antenas
                     printf("\nLista de Antenas:\n");
+                    RegistarOperacao(rastreio, RASTREIO_LISTAR, 0, modoEfeitos, 0, 0, 0);
 
-                    // Atualizar efeitos nefastos antes de listar
-                    if (DestruirListaEfeitos(efeitos)) {
-                        printf("Lista de efeitos nefastos destruida com sucesso.\n");
+                    // Os efeitos vêm da cache do armazém: só são recalculados se as antenas mudaram
+                    ListarAntenasArmazemModo(armazem, modoEfeitos);
+                    const ConjuntoEfeitos* conjunto = EfeitosEmCache(armazem, modoEfeitos);
+                    if (conjunto != NULL) {
+                        printf("Celulas com efeitos nefastos: %lld\n", ContarConjuntoEfeitos(conjunto));
+                    }
+                    break;
+                }
+                case 4: { // Consultar Regiao
+                    int x0, y0, x1, y1;
+                    printf("\nCanto superior esquerdo (x y): ");
+                    scanf("%d %d", &x0, &y0);
+                    printf("Canto inferior direito (x y): ");
+                    scanf("%d %d", &x1, &y1);
+                    RegistarOperacao(rastreio, RASTREIO_CONSULTAR_REGIAO, 0, x0, y0, x1, y1);
+                    printf("Antenas na regiao: %lld\n", ContarAntenasRegiao(armazem, x0, y0, x1, y1));
+                    printf("Celulas com efeito nefasto na regiao: %lld\n", ContarEfeitosRegiao(armazem, x0, y0, x1, y1));
+                    break;
+                }
+                case 5: { // Causas de um Efeito
+                    int x, y;
+                    int proximas[16], distantes[16];
+                    printf("\nCoordenada X: ");
+                    scanf("%d", &x);
+                    printf("Coordenada Y: ");
+                    scanf("%d", &y);
+                    RegistarOperacao(rastreio, RASTREIO_CAUSAS, 0, x, y, 0, 0);
+                    int numPares = CausasEfeito(armazem, x, y, proximas, distantes, 16);
+                    if (numPares == 0) {
+                        printf("Nenhum efeito nefasto em (%d, %d).\n", x, y);
+                    }
+                    for (int i = 0; i < numPares && i < 16; i++) {
+                        printf("Freq %c: (%d, %d) e (%d, %d)\n", armazem->freq[proximas[i]],
+                            armazem->x[proximas[i]], armazem->y[proximas[i]],
+                            armazem->x[distantes[i]], armazem->y[distantes[i]]);
+                    }
+                    if (numPares > 16) {
+                        printf("... e mais %d pares.\n", numPares - 16);
+                    }
+                    break;
+                }
+                case 6: { // Antenas Mais Proximas
+                    char freq;
+                    int x, y, k;
+                    int slots[16];
+                    printf("\nFrequencia: ");
+                    scanf(" %c", &freq);
+                    printf("Coordenada X: ");
+                    scanf("%d", &x);
+                    printf("Coordenada Y: ");
+                    scanf("%d", &y);
+                    printf("Quantas antenas (1-16): ");
+                    scanf("%d", &k);
+                    if (k < 1) k = 1;
+                    if (k > 16) k = 16;
+                    RegistarOperacao(rastreio, RASTREIO_MAIS_PROXIMAS, freq, x, y, k, 0);
+                    int encontradas = AntenasMaisProximas(armazem, freq, x, y, k, slots);
+                    if (encontradas <= 0) {
+                        printf("Nenhuma antena com frequencia %c.\n", freq);
+                    }
+                    for (int i = 0; i < encontradas; i++) {
+                        printf("%d - (%d, %d)\n", i + 1, armazem->x[slots[i]], armazem->y[slots[i]]);
                     }
-                    efeitos = efeitoNefasto(lista);
-
-                    // Exibir a lista de antenas e efeitos
-                    ListarAntenas(lista, efeitos);
                     break;
                 }
-                case 4:
+                case 7: // Alterna entre os dois pontos por par e a reta completa (harmónicos)
+                    modoEfeitos = modoEfeitos == EFEITOS_PONTOS ? EFEITOS_HARMONICOS : EFEITOS_PONTOS;
+                    printf("Modo de efeitos: %s\n", modoEfeitos == EFEITOS_HARMONICOS ? "harmonicos" : "pontos");
+                    break;
+                case 8: { // Mostrar Janela
+                    int x0, y0, fator;
+                    printf("\nCanto superior esquerdo (x y): ");
+                    scanf("%d %d", &x0, &y0);
+                    printf("Celulas por caracter (0 = ajustar ao grid): ");
+                    scanf("%d", &fator);
+                    if (fator <= 0) { // Reduz o resto do grid até caber na janela
+                        int fx = (armazem->largura - x0 + JANELA_LARGURA - 1) / JANELA_LARGURA;
+                        int fy = (armazem->altura - y0 + JANELA_ALTURA - 1) / JANELA_ALTURA;
+                        fator = fx > fy ? fx : fy;
+                    }
+                    RegistarOperacao(rastreio, RASTREIO_JANELA, 0, x0, y0, fator, modoEfeitos);
+                    if (!MostrarJanelaArmazem(armazem, stdout, x0, y0, JANELA_LARGURA, JANELA_ALTURA, fator, modoEfeitos)) {
+                        printf("Janela fora do grid.\n");
+                    }
+                    break;
+                }
+                case 9:
                     break;
                 default:
                     printf("\nOpcao invalida\n");
                 }
-            } while (op_antena != 4);
+            } while (op_antena != 9);
         }
         else if (opcao == 2) {
             do {
@@ -145,10 +275,12 @@ int main() {
                 printf("1 - Inserir Vertice\n");
                 printf("2 - Remover Vertice\n");
                 printf("3 - Mostrar Grafo\n");
-                printf("4 - Mostrar vrtices\n");
+                printf("4 - Mostrar vértices\n");
                 printf("5 - Procura em Profundidade(DFS)\n");
                 printf("6 - Procura em Largura (BFS)\n");
-                printf("7 - Voltar\n");
+                printf("7 - Ligar por Raio\n");
+                printf("8 - Grafo de Interferencia\n");
+                printf("9 - Voltar\n");
                 printf("Escolha uma opcao: ");
                 scanf("%d", &op_grafo);
 
@@ -156,25 +288,29 @@ int main() {
                 case 1: {
                     char freq;
                     int x, y;
-                    printf("Frequncia : ");
+                    printf("Frequência : ");
                     scanf(" %c", &freq);
                     printf("Coordenada x: ");
                     scanf("%d", &x);
                     printf("Coordenada y: ");
                     scanf("%d", &y);
+                    RegistarOperacao(rastreio, RASTREIO_INSERIR_VERTICE, freq, x, y, 0, 0);
 
-                    if (InserirVertice(grafo, id_counter, freq, x, y)) {
-                        Vertice* v = EncontrarVerticePorId(grafo, id_counter);
-                        InserirAresta(grafo, v);
-                        printf("Vertice inserido! ID: %d\n", id_counter);
+                    int id = InserirVerticeArmazem(grafo, freq, x, y);
+                    if (id > 0) {
+                        printf("Vertice inserido! ID: %d\n", id);
                         printf("Ligacoes automaticas criadas.\n");
-                        id_counter++;
-                        // Atualiza os ficheiros aps insero
-                        SalvarGrafoEmBin(grafo->inicio, "grafo.bin");
-                        SalvarGrafoEmTxt(grafo->inicio, "grafo.txt");
+                        // Atualiza os ficheiros após inserção
+                        SalvarAntenas(armazem, rastreio);
+                    }
+                    else if (id == ARMAZEM_FORA_GRID) {
+                        printf("Coordenadas fora do grid %dx%d!\n", GRID_TAM, GRID_TAM);
+                    }
+                    else if (id == ARMAZEM_SEM_MEMORIA) {
+                        printf("Sem memoria para inserir o vertice!\n");
                     }
                     else {
-                        printf("J existe vertice nessas coordenadas.\n");
+                        printf("Já existe vertice nessas coordenadas.\n");
                     }
                     break;
                 }
@@ -182,11 +318,11 @@ int main() {
                     int id;
                     printf("ID do vertice a remover: ");
                     scanf("%d", &id);
-                    if (RemoverVertice(grafo, id)) {
+                    RegistarOperacao(rastreio, RASTREIO_REMOVER_VERTICE, 0, id, 0, 0, 0);
+                    if (RemoverVerticeArmazem(grafo, id)) {
                         printf("Vertice removido.\n");
-                        // Atualiza os ficheiros aps remoo
-                        SalvarGrafoEmBin(grafo->inicio, "grafo.bin");
-                        SalvarGrafoEmTxt(grafo->inicio, "grafo.txt");
+                        // Atualiza os ficheiros após remoção
+                        SalvarAntenas(armazem, rastreio);
                     }
                     else {
                         printf("Vertice nao encontrado.\n");
@@ -194,12 +330,17 @@ int main() {
                     break;
                 }
                 case 3: {
-                    if (!MostrarGrid(grafo->inicio)) {
+                    RegistarOperacao(rastreio, RASTREIO_MOSTRAR_GRAFO, 0, modoEfeitos, 0, 0, 0);
+                    if (armazem->numAntenas == 0) {
+                        printf("Grafo vazio.\n");
                         printf("Nao foi possivel mostrar o grafo.\n");
+                        break;
                     }
+                    ListarAntenasArmazemModo(armazem, modoEfeitos);
                     break;
                 }
                 case 4: {
+                    RegistarOperacao(rastreio, RASTREIO_MOSTRAR_VERTICES, 0, 0, 0, 0, 0);
                     MostrarVertices(grafo);
                     break;
                 }
@@ -207,6 +348,7 @@ int main() {
                     int idOrigem;
                     printf("ID da antena de origem para DFS: ");
                     scanf("%d", &idOrigem);
+                    RegistarOperacao(rastreio, RASTREIO_DFS, 0, idOrigem, 0, 0, 0);
                     ProcuraProfundidade(grafo, idOrigem);
                     break;
                 }
@@ -214,24 +356,58 @@ int main() {
                     int idOrigem;
                     printf("ID da antena de origem para BFS: ");
                     scanf("%d", &idOrigem);
+                    RegistarOperacao(rastreio, RASTREIO_BFS, 0, idOrigem, 0, 0, 0);
                     ProcuraLargura(grafo, idOrigem);
                     break;
                 }
-                case 7:
+                case 7: {
+                    int raio;
+                    printf("Raio maximo das ligacoes (0 para ligar ao anterior da mesma frequencia): ");
+                    scanf("%d", &raio);
+                    RegistarOperacao(rastreio, RASTREIO_LIGAR_RAIO, 0, raio, 0, 0, 0);
+                    GR* novo = raio > 0 ? CriarGrafoRaio(armazem, raio) : CriarGrafoSobreArmazem(armazem);
+                    if (novo != NULL) {
+                        DestruirGrafo(grafo);
+                        grafo = novo;
+                        printf("Grafo reconstruido.\n");
+                    }
+                    else {
+                        printf("Nao foi possivel reconstruir o grafo.\n");
+                    }
+                    break;
+                }
+                case 8: {
+                    // Arestas de cada antena de um par para as antenas atingidas pelos seus efeitos
+                    RegistarOperacao(rastreio, RASTREIO_INTERFERENCIA, 0, 0, 0, 0, 0);
+                    GR* novo = CriarGrafoInterferencia(armazem);
+                    if (novo != NULL) {
+                        DestruirGrafo(grafo);
+                        grafo = novo;
+                        printf("Grafo de interferencia criado. Use DFS/BFS para seguir as cascatas.\n");
+                    }
+                    else {
+                        printf("Nao foi possivel criar o grafo de interferencia.\n");
+                    }
+                    break;
+                }
+                case 9:
                     break;
                 default:
                     printf("Opcao invalida.\n");
                 }
-            } while (op_grafo != 7);
+            } while (op_grafo != 9);
+        }
+        else if (opcao == 3) { // Contadores de instrumentação (mostrados e exportados em JSON)
+            MostrarEstatisticas();
+            if (ExportarEstatisticasJson("estatisticas.json")) {
+                printf("Estatisticas exportadas para estatisticas.json.\n");
+            }
         }
-    } while (opcao != 3);
+    } while (opcao != 4);
 
-    if (efeitos != NULL) {
-        DestruirListaEfeitos(efeitos);
-        efeitos = NULL;
-    }
-    DestruirListaAntenas(lista);
+    FecharRastreio(rastreio);
     DestruirGrafo(grafo);
+    DestruirArmazem(armazem);
 
     printf("Programa terminado.\n");
     return 0;
@@ -0,0 +1,448 @@
+/*****************************************************************//**
+ * \file   protocolo.c
+ * \brief  Protocolo binário do servidor de consultas e execução dos pedidos.
+ *
+ * Cada pedido é codificado como nos rastreios: um byte com o tipo, um byte
+ * com a frequência, o id do pedido (varint) e os argumentos do tipo (varints
+ * zigzag). A resposta tem um byte de estado (RESPOSTA_*), o id do pedido, o
+ * número de valores e os valores (varints zigzag). Os ids permitem enviar
+ * vários pedidos sem esperar pelas respostas (pipeline).
+ *
+ * O servidor mantém o armazém e o grafo em memória. As alterações e as
+ * consultas curtas são feitas com um lock; as procuras no grafo leem uma
+ * versão publicada (versoes.c), sem bloquear as restantes threads. As
+ * alterações só são publicadas quando chega uma procura ou uma gravação,
+ * pelo que uma sequência de inserções e remoções custa uma única cópia. As
+ * gravações (PEDIDO_SALVAR) também leem a versão publicada: os ficheiros
+ * são escritos sem o lock de escrita, enquanto as alterações continuam.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+#include <limits.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+static const int ARGUMENTOS_PEDIDO[PEDIDO_TIPOS] = {
+    0, // PEDIDO_INFO
+    2, // PEDIDO_INSERIR (a frequência vai no byte próprio)
+    2, // PEDIDO_REMOVER
+    2, // PEDIDO_PROCURAR
+    0, // PEDIDO_EFEITOS
+    4, // PEDIDO_REGIAO
+    2, // PEDIDO_BFS
+    2, // PEDIDO_DFS
+    0, // PEDIDO_SALVAR
+};
+
+static const char* NOMES_PEDIDO[PEDIDO_TIPOS] = {
+    "info", "inserir", "remover", "procurar", "efeitos", "regiao", "bfs", "dfs", "salvar"
+};
+
+/**
+ * \brief Estado do servidor partilhado pelas threads de atendimento.
+ */
+struct ServidorAntenas {
+    ArmazemAntenas* armazem;   // Estado atual (lido e alterado só com o lock de escrita)
+    GR* grafo;
+    mtx_t escrita;
+    PublicadorVersoes* versoes;
+    atomic_bool pendente;      // Há alterações ainda não publicadas
+    char prefixo[256];         // Ficheiros de PEDIDO_SALVAR (prefixo.bin, .txt e .zbin)
+    mtx_t gravacao;            // Serializa as gravações (não bloqueia as alterações)
+};
+
+#pragma region Codificação
+/**
+ * \brief Nome de um tipo de pedido.
+ */
+const char* NomePedido(int tipo) {
+    return tipo >= 0 && tipo < PEDIDO_TIPOS ? NOMES_PEDIDO[tipo] : "?";
+}
+
+/**
+ * \brief Número de argumentos de um tipo de pedido (-1 se o tipo não existir).
+ */
+int ArgumentosPedido(int tipo) {
+    return tipo >= 0 && tipo < PEDIDO_TIPOS ? ARGUMENTOS_PEDIDO[tipo] : -1;
+}
+
+static uint64_t Zigzag(long long v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); // Negativos pequenos ficam pequenos
+}
+
+static long long Dezigzag(uint64_t v) {
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+/**
+ * \brief Codifica um pedido.
+ *
+ * \param buf Buffer com pelo menos PROTOCOLO_MAX_PEDIDO bytes.
+ * \return Número de bytes escritos ou 0 se o tipo não existir.
+ */
+int CodificarPedido(uint8_t* buf, const PedidoServidor* p) {
+    int numArgs = ArgumentosPedido(p->tipo);
+    if (numArgs < 0) {
+        return 0;
+    }
+    int tam = 0;
+    buf[tam++] = (uint8_t)p->tipo;
+    buf[tam++] = (uint8_t)p->freq;
+    tam += EscreverVarint(buf + tam, p->id);
+    for (int i = 0; i < numArgs; i++) {
+        tam += EscreverVarint(buf + tam, Zigzag(p->args[i]));
+    }
+    return tam;
+}
+
+/**
+ * \brief Descodifica um pedido.
+ *
+ * Um tipo desconhecido é devolvido em p->tipo sem argumentos: o resto da
+ * mensagem não pode ser interpretado e a ligação deve ser terminada. Um
+ * argumento que não cabe num int é lido na mesma (o pedido seguinte continua
+ * alinhado), mas marca o pedido como inválido em p->invalido.
+ *
+ * \return Ponteiro para o byte seguinte ao pedido ou NULL se o pedido estiver incompleto.
+ */
+const uint8_t* DescodificarPedido(const uint8_t* buf, const uint8_t* fim, PedidoServidor* p) {
+    if (fim - buf < 3) {
+        return NULL;
+    }
+    memset(p, 0, sizeof(*p));
+    p->tipo = buf[0];
+    p->freq = (char)buf[1];
+    uint64_t v;
+    const uint8_t* pos = LerVarint(buf + 2, fim, &v);
+    if (pos == NULL) {
+        return NULL;
+    }
+    p->id = (uint32_t)v;
+    for (int i = 0; i < ArgumentosPedido(p->tipo); i++) {
+        pos = LerVarint(pos, fim, &v);
+        if (pos == NULL) {
+            return NULL;
+        }
+        long long arg = Dezigzag(v);
+        if (arg < INT_MIN || arg > INT_MAX) {
+            p->invalido = true;
+            arg = 0;
+        }
+        p->args[i] = (int)arg;
+    }
+    return pos;
+}
+
+/**
+ * \brief Codifica uma resposta.
+ *
+ * \param buf Buffer com pelo menos PROTOCOLO_MAX_RESPOSTA bytes.
+ * \return Número de bytes escritos.
+ */
+int CodificarResposta(uint8_t* buf, const RespostaServidor* r) {
+    int n = r->numValores < 0 ? 0 : r->numValores > PROTOCOLO_MAX_VALORES ? PROTOCOLO_MAX_VALORES : r->numValores;
+    int tam = 0;
+    buf[tam++] = (uint8_t)r->estado;
+    tam += EscreverVarint(buf + tam, r->id);
+    tam += EscreverVarint(buf + tam, (uint64_t)n);
+    for (int i = 0; i < n; i++) {
+        tam += EscreverVarint(buf + tam, Zigzag(r->valores[i]));
+    }
+    return tam;
+}
+
+/**
+ * \brief Descodifica uma resposta.
+ *
+ * \return Ponteiro para o byte seguinte à resposta, NULL se estiver incompleta
+ *         ou fim se tiver mais valores do que PROTOCOLO_MAX_VALORES (inválida).
+ */
+const uint8_t* DescodificarResposta(const uint8_t* buf, const uint8_t* fim, RespostaServidor* r) {
+    if (fim - buf < 3) {
+        return NULL;
+    }
+    r->estado = buf[0];
+    uint64_t v;
+    const uint8_t* pos = LerVarint(buf + 1, fim, &v);
+    if (pos == NULL) {
+        return NULL;
+    }
+    r->id = (uint32_t)v;
+    pos = LerVarint(pos, fim, &v);
+    if (pos == NULL) {
+        return NULL;
+    }
+    if (v > PROTOCOLO_MAX_VALORES) {
+        r->estado = RESPOSTA_INVALIDO;
+        r->numValores = 0;
+        return fim;
+    }
+    r->numValores = (int)v;
+    for (int i = 0; i < r->numValores; i++) {
+        pos = LerVarint(pos, fim, &v);
+        if (pos == NULL) {
+            return NULL;
+        }
+        r->valores[i] = Dezigzag(v);
+    }
+    return pos;
+}
+#pragma endregion
+
+#pragma region Servidor
+/**
+ * \brief Cria o estado do servidor e publica a primeira versão.
+ *
+ * Cria também o índice de regiões do armazém (se ainda não existir), usado
+ * por PEDIDO_EFEITOS e PEDIDO_REGIAO.
+ *
+ * \param a Armazém com as antenas (passa a pertencer ao servidor).
+ * \param g Grafo sobre o armazém (passa a pertencer ao servidor).
+ * \param prefixo Caminho dos ficheiros gravados por PEDIDO_SALVAR, sem a extensão (NULL para "antenas").
+ * \return Ponteiro para o servidor ou NULL se faltar memória.
+ */
+ServidorAntenas* CriarServidorAntenas(ArmazemAntenas* a, GR* g, const char* prefixo) {
+    if (a == NULL || g == NULL || g->armazem != a || CriarIndiceRegioes(a) == NULL) {
+        return NULL;
+    }
+    ServidorAntenas* s = (ServidorAntenas*)malloc(sizeof(ServidorAntenas));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->versoes = CriarPublicadorVersoes();
+    if (s->versoes == NULL || mtx_init(&s->escrita, mtx_plain) != thrd_success) {
+        DestruirPublicadorVersoes(s->versoes);
+        free(s);
+        return NULL;
+    }
+    if (mtx_init(&s->gravacao, mtx_plain) != thrd_success) {
+        DestruirPublicadorVersoes(s->versoes);
+        mtx_destroy(&s->escrita);
+        free(s);
+        return NULL;
+    }
+    s->armazem = a;
+    s->grafo = g;
+    snprintf(s->prefixo, sizeof(s->prefixo), "%s", prefixo != NULL ? prefixo : "antenas");
+    atomic_init(&s->pendente, false);
+    if (!PublicarVersao(s->versoes, a, g)) {
+        DestruirPublicadorVersoes(s->versoes);
+        mtx_destroy(&s->escrita);
+        mtx_destroy(&s->gravacao);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+/**
+ * \brief Atribui uma posição de leitor a uma thread de atendimento.
+ *
+ * \return Posição do leitor ou -1 se já houver VERSOES_MAX_LEITORES threads.
+ */
+int RegistarLeitorServidor(ServidorAntenas* s) {
+    return RegistarLeitor(s->versoes);
+}
+
+/**
+ * \brief Liberta a posição de leitor de uma thread de atendimento.
+ */
+void RemoverLeitorServidor(ServidorAntenas* s, int leitor) {
+    RemoverLeitor(s->versoes, leitor);
+}
+
+/**
+ * \brief Publica as alterações pendentes (antes de uma procura no grafo ou de uma gravação).
+ */
+static bool PublicarPendentes(ServidorAntenas* s) {
+    if (!atomic_load(&s->pendente)) {
+        return true;
+    }
+    bool publicada = true;
+    mtx_lock(&s->escrita);
+    if (atomic_load(&s->pendente)) {
+        publicada = PublicarVersao(s->versoes, s->armazem, s->grafo);
+        if (publicada) atomic_store(&s->pendente, false);
+    }
+    mtx_unlock(&s->escrita);
+    return publicada;
+}
+
+/**
+ * \brief Converte um código ARMAZEM_* num estado de resposta.
+ */
+static int EstadoArmazem(int codigo) {
+    switch (codigo) {
+    case ARMAZEM_FORA_GRID: return RESPOSTA_FORA_GRID;
+    case ARMAZEM_DUPLICADA: return RESPOSTA_DUPLICADA;
+    default: return RESPOSTA_SEM_MEMORIA;
+    }
+}
+
+/**
+ * \brief Executa as alterações e as consultas curtas (com o lock de escrita).
+ */
+static void ExecutarNoArmazem(ServidorAntenas* s, const PedidoServidor* p, RespostaServidor* r) {
+    const ArmazemAntenas* a = s->armazem;
+    switch (p->tipo) {
+    case PEDIDO_INFO:
+        r->valores[r->numValores++] = a->numAntenas;
+        r->valores[r->numValores++] = a->largura;
+        r->valores[r->numValores++] = a->altura;
+        r->valores[r->numValores++] = (long long)a->versao;
+        break;
+    case PEDIDO_INSERIR: {
+        int id = p->freq == '\0' ? ARMAZEM_FORA_GRID : InserirVerticeArmazem(s->grafo, p->freq, p->args[0], p->args[1]);
+        if (id > 0) {
+            r->valores[r->numValores++] = id;
+            atomic_store(&s->pendente, true);
+        }
+        else {
+            r->estado = EstadoArmazem(id);
+        }
+        break;
+    }
+    case PEDIDO_REMOVER: {
+        int slot = ProcurarAntenaArmazem(a, p->args[0], p->args[1]);
+        if (slot >= 0 && RemoverVerticeArmazem(s->grafo, IdVertice(a, slot))) {
+            atomic_store(&s->pendente, true);
+        }
+        else {
+            r->estado = RESPOSTA_NAO_EXISTE;
+        }
+        break;
+    }
+    case PEDIDO_PROCURAR: {
+        int slot = ProcurarAntenaArmazem(a, p->args[0], p->args[1]);
+        if (slot < 0) r->estado = RESPOSTA_NAO_EXISTE;
+        else r->valores[r->numValores++] = a->freq[slot];
+        break;
+    }
+    case PEDIDO_EFEITOS:
+    case PEDIDO_REGIAO: {
+        bool tudo = p->tipo == PEDIDO_EFEITOS;
+        int x0 = tudo ? 0 : p->args[0], y0 = tudo ? 0 : p->args[1];
+        int x1 = tudo ? a->largura - 1 : p->args[2], y1 = tudo ? a->altura - 1 : p->args[3];
+        // O índice de regiões é criado em CriarServidorAntenas
+        long long antenas = ContarAntenasRegiao(a, x0, y0, x1, y1);
+        long long efeitos = ContarEfeitosRegiao(a, x0, y0, x1, y1);
+        r->valores[r->numValores++] = tudo ? efeitos : antenas;
+        r->valores[r->numValores++] = tudo ? antenas : efeitos;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/**
+ * \brief Grava uma versão publicada com o prefixo do servidor (sem o lock de escrita).
+ *
+ * As gravações são serializadas entre si para não escreverem nos mesmos ficheiros ao mesmo tempo.
+ */
+static void ExecutarGravacao(ServidorAntenas* s, const VersaoArmazem* v, RespostaServidor* r) {
+    mtx_lock(&s->gravacao);
+    bool salvo = SalvarArmazemComPrefixo(v->armazem, s->prefixo);
+    mtx_unlock(&s->gravacao);
+    if (salvo) r->valores[r->numValores++] = v->armazem->numAntenas;
+    else r->estado = RESPOSTA_SEM_MEMORIA;
+}
+
+/**
+ * \brief Executa uma procura no grafo de uma versão publicada.
+ */
+static void ExecutarProcura(const VersaoArmazem* v, const PedidoServidor* p, RespostaServidor* r) {
+    const ArmazemAntenas* a = v->armazem;
+    int slot = ProcurarAntenaArmazem(a, p->args[0], p->args[1]);
+    if (slot < 0 || v->grafo == NULL) {
+        r->estado = RESPOSTA_NAO_EXISTE;
+        return;
+    }
+    int* ordem = (int*)malloc(((size_t)a->numSlots + 1) * sizeof(int));
+    int n = ordem == NULL ? -1 : p->tipo == PEDIDO_BFS ?
+        PercorrerLarguraArmazem(v->grafo, IdVertice(a, slot), ordem) : PercorrerProfundidadeArmazem(v->grafo, IdVertice(a, slot), ordem);
+    if (n < 0) {
+        r->estado = RESPOSTA_SEM_MEMORIA;
+    }
+    else {
+        r->valores[r->numValores++] = n;
+        for (int i = 0; i < n && i < PROTOCOLO_MAX_VISITADOS; i++) {
+            r->valores[r->numValores++] = ordem[i];
+        }
+    }
+    free(ordem);
+}
+
+/**
+ * \brief Executa um pedido.
+ *
+ * As alterações e as consultas que só tocam no índice de regiões ou na
+ * tabela de dispersão (microssegundos) são feitas com o lock de escrita. As
+ * procuras no grafo, que percorrem todo o componente, e as gravações leem
+ * uma versão publicada sem locks; as alterações pendentes são publicadas
+ * antes, pelo que cada procura ou gravação vê todas as alterações já respondidas.
+ *
+ * \param s Ponteiro para o servidor.
+ * \param leitor Posição de leitor da thread (RegistarLeitorServidor).
+ * \param p Pedido a executar.
+ * \param r Recebe a resposta (com o id do pedido).
+ * \return false se o pedido tiver um tipo desconhecido (a ligação deve ser terminada).
+ */
+bool ExecutarPedido(ServidorAntenas* s, int leitor, const PedidoServidor* p, RespostaServidor* r) {
+    r->estado = RESPOSTA_OK;
+    r->id = p->id;
+    r->numValores = 0;
+    if (p->tipo < 0 || p->tipo >= PEDIDO_TIPOS) {
+        r->estado = RESPOSTA_INVALIDO;
+        return false;
+    }
+    if (p->invalido) {
+        r->estado = RESPOSTA_INVALIDO;
+        return true;
+    }
+    if (p->tipo != PEDIDO_BFS && p->tipo != PEDIDO_DFS && p->tipo != PEDIDO_SALVAR) {
+        mtx_lock(&s->escrita);
+        ExecutarNoArmazem(s, p, r);
+        mtx_unlock(&s->escrita);
+        return true;
+    }
+    if (!PublicarPendentes(s)) {
+        r->estado = RESPOSTA_SEM_MEMORIA;
+        return true;
+    }
+    const VersaoArmazem* v = IniciarLeitura(s->versoes, leitor);
+    if (v == NULL) {
+        r->estado = RESPOSTA_SEM_MEMORIA;
+    }
+    else if (p->tipo == PEDIDO_SALVAR) {
+        ExecutarGravacao(s, v, r);
+    }
+    else {
+        ExecutarProcura(v, p, r);
+    }
+    TerminarLeitura(s->versoes, leitor);
+    return true;
+}
+
+/**
+ * \brief Destrói o servidor, o armazém e o grafo (as threads de atendimento já terminaram).
+ *
+ * \return true se o servidor foi destruído, false se era NULL.
+ */
+bool DestruirServidorAntenas(ServidorAntenas* s) {
+    if (s == NULL) {
+        return false;
+    }
+    DestruirPublicadorVersoes(s->versoes);
+    DestruirGrafo(s->grafo);
+    DestruirArmazem(s->armazem);
+    mtx_destroy(&s->escrita);
+    mtx_destroy(&s->gravacao);
+    free(s);
+    return true;
+}
+#pragma endregion
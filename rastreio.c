@@ -0,0 +1,293 @@
+/*****************************************************************//**
+ * \file   rastreio.c
+ * \brief  Captura e reprodução de sessões (rastreios de operações).
+ *
+ * Um rastreio guarda, pela ordem em que aconteceram, as operações feitas no
+ * menu do programa, precedidas do conteúdo inicial do armazém. Cada registo
+ * ocupa um byte de tipo, um byte de frequência e os argumentos inteiros do
+ * tipo em varints zigzag, pelo que uma sessão típica fica com poucos bytes
+ * por operação.
+ *
+ * Formato: cabeçalho de três uint32 (magia, versão, GRID_TAM) seguido dos registos.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#define RASTREIO_MAGIA 0x52544E41u // "ANTR" em little-endian
+#define RASTREIO_VERSAO 1u
+
+#pragma region Rastreios
+/**
+ * \brief Número de argumentos inteiros de cada tipo de operação (a frequência vai sempre à parte).
+ */
+static const int ARGUMENTOS_OPERACAO[RASTREIO_TIPOS] = {
+    2, // RASTREIO_ANTENA_INICIAL
+    2, // RASTREIO_INSERIR_ANTENA
+    2, // RASTREIO_REMOVER_ANTENA
+    1, // RASTREIO_LISTAR
+    4, // RASTREIO_CONSULTAR_REGIAO
+    2, // RASTREIO_CAUSAS
+    3, // RASTREIO_MAIS_PROXIMAS
+    2, // RASTREIO_INSERIR_VERTICE
+    1, // RASTREIO_REMOVER_VERTICE
+    1, // RASTREIO_MOSTRAR_GRAFO
+    0, // RASTREIO_MOSTRAR_VERTICES
+    1, // RASTREIO_DFS
+    1, // RASTREIO_BFS
+    1, // RASTREIO_LIGAR_RAIO
+    0, // RASTREIO_INTERFERENCIA
+    0, // RASTREIO_SALVAR
+    4, // RASTREIO_JANELA
+};
+
+static const char* NOMES_OPERACAO[RASTREIO_TIPOS] = {
+    "antena_inicial", "inserir_antena", "remover_antena", "listar", "consultar_regiao",
+    "causas", "mais_proximas", "inserir_vertice", "remover_vertice", "mostrar_grafo",
+    "mostrar_vertices", "dfs", "bfs", "ligar_raio", "interferencia", "salvar", "janela",
+};
+
+/**
+ * \brief Nome de um tipo de operação (para relatórios).
+ */
+const char* NomeOperacaoRastreio(int tipo) {
+    if (tipo < 0 || tipo >= RASTREIO_TIPOS) {
+        return "desconhecida";
+    }
+    return NOMES_OPERACAO[tipo];
+}
+
+/**
+ * \brief Cria um ficheiro de rastreio e escreve o cabeçalho.
+ *
+ * \param nomeFicheiro Nome do ficheiro.
+ * \return Ponteiro para o rastreio ou NULL se o ficheiro não puder ser criado.
+ */
+Rastreio* CriarRastreio(const char* nomeFicheiro) {
+    Rastreio* r = (Rastreio*)malloc(sizeof(Rastreio));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->ficheiro = fopen(nomeFicheiro, "wb");
+    if (r->ficheiro == NULL) {
+        free(r);
+        return NULL;
+    }
+    uint32_t cabecalho[3] = { RASTREIO_MAGIA, RASTREIO_VERSAO, (uint32_t)GRID_TAM };
+    if (fwrite(cabecalho, sizeof(uint32_t), 3, r->ficheiro) != 3) {
+        fclose(r->ficheiro);
+        free(r);
+        return NULL;
+    }
+    r->numOperacoes = 0;
+    return r;
+}
+
+/**
+ * \brief Acrescenta uma operação ao rastreio.
+ *
+ * Os argumentos a mais para o tipo são ignorados. Com r a NULL não faz nada,
+ * para que o chamador não precise de verificar se a captura está ativa.
+ *
+ * \return true se a operação foi escrita, false se r for NULL, o tipo for inválido ou a escrita falhar.
+ */
+bool RegistarOperacao(Rastreio* r, int tipo, char freq, int a0, int a1, int a2, int a3) {
+    if (r == NULL || tipo < 0 || tipo >= RASTREIO_TIPOS) {
+        return false;
+    }
+    int args[4] = { a0, a1, a2, a3 };
+    uint8_t buf[2 + 4 * 10];
+    int tam = 0;
+    buf[tam++] = (uint8_t)tipo;
+    buf[tam++] = (uint8_t)freq;
+    for (int i = 0; i < ARGUMENTOS_OPERACAO[tipo]; i++) {
+        uint32_t zigzag = ((uint32_t)args[i] << 1) ^ (uint32_t)(args[i] >> 31); // Negativos pequenos ficam pequenos
+        tam += EscreverVarint(buf + tam, zigzag);
+    }
+    if (fwrite(buf, 1, (size_t)tam, r->ficheiro) != (size_t)tam) {
+        return false;
+    }
+    r->numOperacoes++;
+    return true;
+}
+
+/**
+ * \brief Regista o conteúdo atual do armazém como estado inicial da sessão.
+ *
+ * \return true se todas as antenas foram registadas.
+ */
+bool RegistarEstadoInicial(Rastreio* r, const ArmazemAntenas* a) {
+    if (r == NULL || a == NULL) {
+        return false;
+    }
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        if (!RegistarOperacao(r, RASTREIO_ANTENA_INICIAL, a->freq[s], a->x[s], a->y[s], 0, 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Fecha o rastreio.
+ *
+ * \return true se o ficheiro foi fechado sem erros, false se r for NULL ou a escrita falhar.
+ */
+bool FecharRastreio(Rastreio* r) {
+    if (r == NULL) {
+        return false;
+    }
+    bool ok = fclose(r->ficheiro) == 0;
+    free(r);
+    return ok;
+}
+
+/**
+ * \brief Carrega todas as operações de um ficheiro de rastreio.
+ *
+ * \param nomeFicheiro Nome do ficheiro.
+ * \param n Recebe o número de operações.
+ * \return Vetor de operações (a libertar pelo chamador) ou NULL se o ficheiro não existir,
+ *         for inválido ou tiver sido gravado com outro GRID_TAM.
+ */
+OperacaoRastreio* CarregarRastreio(const char* nomeFicheiro, int* n) {
+    *n = 0;
+    FILE* ficheiro = fopen(nomeFicheiro, "rb");
+    if (ficheiro == NULL) {
+        return NULL;
+    }
+    uint32_t cabecalho[3];
+    if (fread(cabecalho, sizeof(uint32_t), 3, ficheiro) != 3 || cabecalho[0] != RASTREIO_MAGIA ||
+        cabecalho[1] != RASTREIO_VERSAO || cabecalho[2] != (uint32_t)GRID_TAM) { // Coordenadas de outro grid não são comparáveis
+        fclose(ficheiro);
+        return NULL;
+    }
+    long long fimFicheiro = TamanhoFicheiro(ficheiro); // O ficheiro continua logo a seguir ao cabeçalho
+    long long inicio = (long long)sizeof(cabecalho);
+    if (fimFicheiro < inicio || (unsigned long long)(fimFicheiro - inicio) >= SIZE_MAX) {
+        fclose(ficheiro);
+        return NULL;
+    }
+    size_t tam = (size_t)(fimFicheiro - inicio);
+    uint8_t* dados = (uint8_t*)malloc(tam + 1);
+    if (dados == NULL || fread(dados, 1, tam, ficheiro) != tam) {
+        free(dados);
+        fclose(ficheiro);
+        return NULL;
+    }
+    fclose(ficheiro);
+
+    int capacidade = 0;
+    OperacaoRastreio* ops = NULL;
+    const uint8_t* p = dados;
+    const uint8_t* fim = dados + tam;
+    while (p + 2 <= fim) {
+        OperacaoRastreio op = { 0 };
+        op.tipo = p[0];
+        op.freq = (char)p[1];
+        p += 2;
+        if (op.tipo >= RASTREIO_TIPOS) {
+            break; // Registo corrompido: fica o que foi lido até aqui
+        }
+        for (int i = 0; i < ARGUMENTOS_OPERACAO[op.tipo] && p != NULL; i++) {
+            uint64_t v;
+            p = LerVarint(p, fim, &v);
+            if (p != NULL) op.args[i] = (int)((uint32_t)(v >> 1) ^ (0u - (uint32_t)(v & 1)));
+        }
+        if (p == NULL) {
+            break; // Registo truncado (sessão interrompida)
+        }
+        if (*n == capacidade) {
+            capacidade = capacidade < 64 ? 64 : capacidade * 2;
+            OperacaoRastreio* novas = (OperacaoRastreio*)realloc(ops, capacidade * sizeof(OperacaoRastreio));
+            if (novas == NULL) {
+                break;
+            }
+            ops = novas;
+        }
+        ops[(*n)++] = op;
+    }
+    free(dados);
+    if (ops == NULL) {
+        ops = (OperacaoRastreio*)malloc(sizeof(OperacaoRastreio)); // Rastreio vazio mas válido
+    }
+    return ops;
+}
+
+/**
+ * \brief Executa uma operação de um rastreio com as mesmas chamadas que o menu do programa.
+ *
+ * As operações RASTREIO_ANTENA_INICIAL só inserem no armazém: o grafo deve ser
+ * criado (CriarGrafoSobreArmazem) depois delas, tal como no arranque do programa.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param g Ponteiro para o grafo (pode ser substituído em RASTREIO_LIGAR_RAIO e RASTREIO_INTERFERENCIA).
+ * \param op Operação a executar.
+ * \param prefixo Prefixo dos ficheiros de RASTREIO_SALVAR (NULL para não gravar).
+ * \return true se a operação teve efeito, false se foi rejeitada (como no menu) ou o tipo for inválido.
+ */
+bool ExecutarOperacaoRastreio(ArmazemAntenas* a, GR** g, const OperacaoRastreio* op, const char* prefixo) {
+    const int* v = op->args;
+    switch (op->tipo) {
+    case RASTREIO_ANTENA_INICIAL:
+        return InserirAntenaArmazem(a, op->freq, v[0], v[1]) >= 0;
+    case RASTREIO_INSERIR_ANTENA:
+    case RASTREIO_INSERIR_VERTICE:
+        return InserirVerticeArmazem(*g, op->freq, v[0], v[1]) > 0;
+    case RASTREIO_REMOVER_ANTENA: {
+        int slot = ProcurarAntenaArmazem(a, v[0], v[1]);
+        return slot >= 0 && a->freq[slot] == op->freq && RemoverVerticeArmazem(*g, IdVertice(a, slot));
+    }
+    case RASTREIO_LISTAR: {
+        bool ok = ListarAntenasArmazemModo(a, v[0]);
+        return EfeitosEmCache(a, v[0]) != NULL && ok;
+    }
+    case RASTREIO_CONSULTAR_REGIAO:
+        return ContarAntenasRegiao(a, v[0], v[1], v[2], v[3]) >= 0 && ContarEfeitosRegiao(a, v[0], v[1], v[2], v[3]) >= 0;
+    case RASTREIO_CAUSAS: {
+        int proximas[16], distantes[16];
+        return CausasEfeito(a, v[0], v[1], proximas, distantes, 16) > 0;
+    }
+    case RASTREIO_MAIS_PROXIMAS: {
+        int slots[16];
+        int k = v[2] < 1 ? 1 : (v[2] > 16 ? 16 : v[2]);
+        return AntenasMaisProximas(a, op->freq, v[0], v[1], k, slots) > 0;
+    }
+    case RASTREIO_REMOVER_VERTICE:
+        return RemoverVerticeArmazem(*g, v[0]);
+    case RASTREIO_MOSTRAR_GRAFO:
+        return a->numAntenas > 0 && ListarAntenasArmazemModo(a, v[0]);
+    case RASTREIO_MOSTRAR_VERTICES:
+        MostrarVertices(*g);
+        return true;
+    case RASTREIO_DFS:
+        ProcuraProfundidade(*g, v[0]);
+        return true;
+    case RASTREIO_BFS:
+        ProcuraLargura(*g, v[0]);
+        return true;
+    case RASTREIO_LIGAR_RAIO:
+    case RASTREIO_INTERFERENCIA: {
+        GR* novo;
+        if (op->tipo == RASTREIO_INTERFERENCIA) novo = CriarGrafoInterferencia(a);
+        else novo = v[0] > 0 ? CriarGrafoRaio(a, v[0]) : CriarGrafoSobreArmazem(a);
+        if (novo == NULL) {
+            return false;
+        }
+        DestruirGrafo(*g);
+        *g = novo;
+        return true;
+    }
+    case RASTREIO_SALVAR:
+        return prefixo == NULL || SalvarArmazemComPrefixo(a, prefixo);
+    case RASTREIO_JANELA:
+        return MostrarJanelaArmazem(a, stdout, v[0], v[1], JANELA_LARGURA, JANELA_ALTURA, v[2], v[3]);
+    default:
+        return false;
+    }
+}
+#pragma endregion
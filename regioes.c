@@ -0,0 +1,527 @@
+/*****************************************************************//**
+ * \file   regioes.c
+ * \brief  Índice de regiões: contagem de antenas e de efeitos num retângulo.
+ *
+ * O grid é dividido em tiles de REGIAO_TILE x REGIAO_TILE células. Para cada
+ * tile são mantidas as contagens de antenas e de células com efeito nefasto
+ * em duas árvores de Fenwick 2D, e os efeitos são guardados num mapa
+ * célula -> multiplicidade (quantos pares geram efeito nessa célula).
+ * Cada célula tem ainda um bit num mapa de antenas e num mapa de efeitos.
+ * Uma consulta soma os tiles totalmente cobertos pela árvore de Fenwick e
+ * conta as bordas parciais nos mapas de bits, uma palavra de 64 células de
+ * cada vez (popcount), em vez de sondar célula a célula.
+ *
+ * O índice é atualizado pelo armazém em cada inserção e remoção: uma nova
+ * antena de frequência f gera os efeitos dos seus pares com as restantes
+ * antenas de f, em O(k_f).
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+
+#pragma region Mapa de efeitos
+/**
+ * \brief Chave de uma célula no mapa de efeitos (0 indica entrada vazia).
+ */
+static uint64_t ChaveCelula(int x, int y) {
+    return (((uint64_t)(uint32_t)y << 32) | (uint32_t)x) + 1;
+}
+
+static uint32_t DispersaoChave(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return (uint32_t)k;
+}
+
+/**
+ * \brief Multiplicidade do efeito numa célula (0 se não houver efeito).
+ */
+static uint32_t LerMultiplicidade(const IndiceRegioes* r, int x, int y) {
+    if (r->tamMapa == 0) {
+        return 0;
+    }
+    uint64_t k = ChaveCelula(x, y);
+    uint32_t h = DispersaoChave(k) & (r->tamMapa - 1);
+    while (r->chaves[h] != 0) {
+        if (r->chaves[h] == k) return r->contagens[h];
+        h = (h + 1) & (r->tamMapa - 1);
+    }
+    return 0;
+}
+
+/**
+ * \brief Aumenta o mapa de efeitos para o dobro.
+ */
+static bool AumentarMapa(IndiceRegioes* r) {
+    int novoTam = r->tamMapa < 64 ? 64 : r->tamMapa * 2;
+    uint64_t* chaves = (uint64_t*)calloc(novoTam, sizeof(uint64_t));
+    uint32_t* contagens = (uint32_t*)malloc(novoTam * sizeof(uint32_t));
+    if (chaves == NULL || contagens == NULL) {
+        free(chaves);
+        free(contagens);
+        return false;
+    }
+    for (int i = 0; i < r->tamMapa; i++) {
+        if (r->chaves[i] == 0) continue;
+        uint32_t h = DispersaoChave(r->chaves[i]) & (novoTam - 1);
+        while (chaves[h] != 0) h = (h + 1) & (novoTam - 1);
+        chaves[h] = r->chaves[i];
+        contagens[h] = r->contagens[i];
+    }
+    free(r->chaves);
+    free(r->contagens);
+    r->chaves = chaves;
+    r->contagens = contagens;
+    r->tamMapa = novoTam;
+    return true;
+}
+
+/**
+ * \brief Soma delta à multiplicidade de uma célula.
+ *
+ * \return Multiplicidade anterior da célula.
+ */
+static uint32_t SomarMultiplicidade(IndiceRegioes* r, int x, int y, int delta) {
+    if (delta > 0 && (r->numEfeitos + 1) * 2 > r->tamMapa && !AumentarMapa(r)) {
+        return 0;
+    }
+    if (r->tamMapa == 0) {
+        return 0;
+    }
+    uint64_t k = ChaveCelula(x, y);
+    uint32_t mascara = (uint32_t)r->tamMapa - 1;
+    uint32_t h = DispersaoChave(k) & mascara;
+    while (r->chaves[h] != 0 && r->chaves[h] != k) h = (h + 1) & mascara;
+    if (r->chaves[h] == 0) { // Célula sem efeito
+        if (delta > 0) {
+            r->chaves[h] = k;
+            r->contagens[h] = (uint32_t)delta;
+            r->numEfeitos++;
+        }
+        return 0;
+    }
+    uint32_t anterior = r->contagens[h];
+    if ((int64_t)anterior + delta > 0) {
+        r->contagens[h] = (uint32_t)((int64_t)anterior + delta);
+        return anterior;
+    }
+    // Remoção com deslocamento para trás (mantém as sequências de sondagem sem marcas)
+    r->numEfeitos--;
+    uint32_t vazio = h;
+    uint32_t j = h;
+    while (true) {
+        j = (j + 1) & mascara;
+        if (r->chaves[j] == 0) break;
+        uint32_t ideal = DispersaoChave(r->chaves[j]) & mascara;
+        if (((j - ideal) & mascara) >= ((j - vazio) & mascara)) {
+            r->chaves[vazio] = r->chaves[j];
+            r->contagens[vazio] = r->contagens[j];
+            vazio = j;
+        }
+    }
+    r->chaves[vazio] = 0;
+    return anterior;
+}
+#pragma endregion
+
+#pragma region Fenwick
+/**
+ * \brief Soma delta ao tile (tx, ty) numa árvore de Fenwick 2D.
+ */
+static void FenwickSomar(int* arvore, int tilesX, int tilesY, int tx, int ty, int delta) {
+    for (int i = tx + 1; i <= tilesX; i += i & -i) {
+        for (int j = ty + 1; j <= tilesY; j += j & -j) {
+            arvore[(size_t)(j - 1) * tilesX + (i - 1)] += delta;
+        }
+    }
+}
+
+/**
+ * \brief Soma dos tiles [0, tx] x [0, ty].
+ */
+static long long FenwickPrefixo(const int* arvore, int tilesX, int tx, int ty) {
+    long long soma = 0;
+    for (int i = tx + 1; i > 0; i -= i & -i) {
+        for (int j = ty + 1; j > 0; j -= j & -j) {
+            soma += arvore[(size_t)(j - 1) * tilesX + (i - 1)];
+        }
+    }
+    return soma;
+}
+
+/**
+ * \brief Soma dos tiles [tx0, tx1] x [ty0, ty1].
+ */
+static long long FenwickRetangulo(const int* arvore, int tilesX, int tx0, int ty0, int tx1, int ty1) {
+    if (tx0 > tx1 || ty0 > ty1) {
+        return 0;
+    }
+    return FenwickPrefixo(arvore, tilesX, tx1, ty1) - FenwickPrefixo(arvore, tilesX, tx0 - 1, ty1)
+        - FenwickPrefixo(arvore, tilesX, tx1, ty0 - 1) + FenwickPrefixo(arvore, tilesX, tx0 - 1, ty0 - 1);
+}
+#pragma endregion
+
+#pragma region Mapas de bits
+/**
+ * \brief Liga ou desliga o bit de uma célula num mapa de bits do índice.
+ */
+static void AlterarBit(const IndiceRegioes* r, uint64_t* bits, int x, int y, bool ativo) {
+    uint64_t* palavra = bits + (size_t)y * r->palavrasLinha + x / 64;
+    if (ativo) *palavra |= 1ull << (x % 64);
+    else *palavra &= ~(1ull << (x % 64));
+}
+
+/**
+ * \brief Conta os bits ativos de um retângulo de um mapa de bits, uma palavra de cada vez.
+ */
+static long long ContarBitsRetangulo(const IndiceRegioes* r, const uint64_t* bits, int x0, int y0, int x1, int y1) {
+    if (x0 > x1 || y0 > y1) {
+        return 0;
+    }
+    int p0 = x0 / 64, p1 = x1 / 64;
+    uint64_t mascara0 = ~0ull << (x0 % 64);
+    uint64_t mascara1 = ~0ull >> (63 - x1 % 64);
+    long long total = 0;
+    for (int y = y0; y <= y1; y++) {
+        const uint64_t* linha = bits + (size_t)y * r->palavrasLinha;
+        for (int p = p0; p <= p1; p++) {
+            uint64_t m = ~0ull;
+            if (p == p0) m &= mascara0;
+            if (p == p1) m &= mascara1;
+            total += ContarBits(linha[p] & m);
+        }
+    }
+    return total;
+}
+#pragma endregion
+
+#pragma region Índice de regiões
+/**
+ * \brief Regista (delta = +1) ou retira (delta = -1) um efeito numa célula.
+ */
+static void RegistarEfeito(IndiceRegioes* r, int x, int y, int delta) {
+    if (x < 0 || x >= r->largura || y < 0 || y >= r->altura) {
+        return; // Efeitos fora do grid não são contados
+    }
+    uint32_t anterior = SomarMultiplicidade(r, x, y, delta);
+    if (delta > 0 && anterior == 0) {
+        FenwickSomar(r->fenwickEfeitos, r->tilesX, r->tilesY, x / REGIAO_TILE, y / REGIAO_TILE, 1);
+        AlterarBit(r, r->bitsEfeitos, x, y, true);
+    }
+    else if (delta < 0 && anterior == 1) {
+        FenwickSomar(r->fenwickEfeitos, r->tilesX, r->tilesY, x / REGIAO_TILE, y / REGIAO_TILE, -1);
+        AlterarBit(r, r->bitsEfeitos, x, y, false);
+    }
+}
+
+/**
+ * \brief Aplica (delta = +1) ou retira (delta = -1) a antena de um slot e os efeitos dos seus pares.
+ */
+static void AplicarAntena(IndiceRegioes* r, const ArmazemAntenas* a, int slot, int delta) {
+    int xa = a->x[slot], ya = a->y[slot];
+    char f = a->freq[slot];
+    FenwickSomar(r->fenwickAntenas, r->tilesX, r->tilesY, xa / REGIAO_TILE, ya / REGIAO_TILE, delta);
+    AlterarBit(r, r->bitsAntenas, xa, ya, delta > 0);
+    const BaldeMorton* b = a->ordemMorton ? a->baldes[ID_FREQ(a, f)] : NULL;
+    int n = b != NULL ? b->numAntenas : a->numSlots;
+    for (int i = 0; i < n; i++) {
+        int s = b != NULL ? b->slot[i] : i;
+        if (s == slot || a->freq[s] != f) continue;
+        int xb = a->x[s], yb = a->y[s];
+        RegistarEfeito(r, 2 * xa - xb, 2 * ya - yb, delta);
+        RegistarEfeito(r, 2 * xb - xa, 2 * yb - ya, delta);
+    }
+}
+
+/**
+ * \brief Atualiza o índice de regiões depois de uma antena ser inserida no armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da nova antena.
+ */
+void RegioesAntenaInserida(ArmazemAntenas* a, int slot) {
+    if (a->regioes != NULL) {
+        AplicarAntena(a->regioes, a, slot, 1);
+    }
+}
+
+/**
+ * \brief Atualiza o índice de regiões antes de uma antena ser removida do armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param slot Slot da antena a remover.
+ */
+void RegioesAntenaRemovida(ArmazemAntenas* a, int slot) {
+    if (a->regioes != NULL) {
+        AplicarAntena(a->regioes, a, slot, -1);
+    }
+}
+
+/**
+ * \brief Recalcula o índice de regiões a partir do armazém.
+ *
+ * \param a Ponteiro para o armazém com índice de regiões.
+ * \return true se o índice foi recalculado, false caso contrário.
+ */
+bool ReconstruirIndiceRegioes(ArmazemAntenas* a) {
+    IndiceRegioes* r = a != NULL ? a->regioes : NULL;
+    if (r == NULL) {
+        return false;
+    }
+    size_t numTiles = (size_t)r->tilesX * r->tilesY;
+    memset(r->fenwickAntenas, 0, numTiles * sizeof(int));
+    memset(r->fenwickEfeitos, 0, numTiles * sizeof(int));
+    size_t numPalavras = (size_t)r->palavrasLinha * r->altura;
+    memset(r->bitsAntenas, 0, numPalavras * sizeof(uint64_t));
+    memset(r->bitsEfeitos, 0, numPalavras * sizeof(uint64_t));
+    if (r->tamMapa > 0) memset(r->chaves, 0, (size_t)r->tamMapa * sizeof(uint64_t));
+    r->numEfeitos = 0;
+
+    // Agrupa os slots por frequência (contagem) para só comparar antenas da mesma frequência
+    int inicio[FREQ_IDS + 1] = { 0 };
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') inicio[a->idDaFreq[(unsigned char)a->freq[s]]]++; // Id + 1
+    }
+    for (int f = 0; f < a->numFreqs; f++) inicio[f + 1] += inicio[f];
+    int* ordem = (int*)malloc(((size_t)inicio[a->numFreqs] + 1) * sizeof(int));
+    if (ordem == NULL) {
+        return false;
+    }
+    int pos[FREQ_IDS];
+    memcpy(pos, inicio, sizeof(pos));
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') ordem[pos[ID_FREQ(a, a->freq[s])]++] = s;
+    }
+
+    // Cada par é contado uma vez: a antena i só gera efeitos com as anteriores da sua frequência
+    for (int f = 0; f < a->numFreqs; f++) {
+        for (int i = inicio[f]; i < inicio[f + 1]; i++) {
+            int xa = a->x[ordem[i]], ya = a->y[ordem[i]];
+            FenwickSomar(r->fenwickAntenas, r->tilesX, r->tilesY, xa / REGIAO_TILE, ya / REGIAO_TILE, 1);
+            AlterarBit(r, r->bitsAntenas, xa, ya, true);
+            for (int k = inicio[f]; k < i; k++) {
+                int xb = a->x[ordem[k]], yb = a->y[ordem[k]];
+                RegistarEfeito(r, 2 * xa - xb, 2 * ya - yb, 1);
+                RegistarEfeito(r, 2 * xb - xa, 2 * yb - ya, 1);
+            }
+        }
+    }
+    free(ordem);
+    return true;
+}
+
+/**
+ * \brief Cria o índice de regiões de um armazém e associa-o ao armazém.
+ *
+ * A partir daqui o índice é atualizado em cada inserção e remoção.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return Ponteiro para o índice ou NULL se faltar memória.
+ */
+IndiceRegioes* CriarIndiceRegioes(ArmazemAntenas* a) {
+    if (a == NULL) {
+        return NULL;
+    }
+    if (a->regioes != NULL) {
+        return a->regioes;
+    }
+    IndiceRegioes* r = (IndiceRegioes*)calloc(1, sizeof(IndiceRegioes));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->largura = a->largura;
+    r->altura = a->altura;
+    r->tilesX = (a->largura + REGIAO_TILE - 1) / REGIAO_TILE;
+    r->tilesY = (a->altura + REGIAO_TILE - 1) / REGIAO_TILE;
+    r->fenwickAntenas = (int*)calloc((size_t)r->tilesX * r->tilesY, sizeof(int));
+    r->fenwickEfeitos = (int*)calloc((size_t)r->tilesX * r->tilesY, sizeof(int));
+    r->palavrasLinha = (a->largura + 63) / 64;
+    r->bitsAntenas = (uint64_t*)calloc((size_t)r->palavrasLinha * r->altura, sizeof(uint64_t));
+    r->bitsEfeitos = (uint64_t*)calloc((size_t)r->palavrasLinha * r->altura, sizeof(uint64_t));
+    if (r->fenwickAntenas == NULL || r->fenwickEfeitos == NULL || r->bitsAntenas == NULL || r->bitsEfeitos == NULL) {
+        free(r->fenwickAntenas);
+        free(r->fenwickEfeitos);
+        free(r->bitsAntenas);
+        free(r->bitsEfeitos);
+        free(r);
+        return NULL;
+    }
+    a->regioes = r;
+    ReconstruirIndiceRegioes(a);
+    return r;
+}
+
+/**
+ * \brief Destrói o índice de regiões de um armazém.
+ *
+ * \param a Ponteiro para o armazém.
+ * \return true se existia um índice, false caso contrário.
+ */
+bool DestruirIndiceRegioes(ArmazemAntenas* a) {
+    if (a == NULL || a->regioes == NULL) {
+        return false;
+    }
+    IndiceRegioes* r = a->regioes;
+    free(r->fenwickAntenas);
+    free(r->fenwickEfeitos);
+    free(r->bitsAntenas);
+    free(r->bitsEfeitos);
+    free(r->chaves);
+    free(r->contagens);
+    free(r);
+    a->regioes = NULL;
+    return true;
+}
+
+/**
+ * \brief Soma as contagens de um retângulo (Fenwick nos tiles completos, mapas de bits nas bordas).
+ */
+static long long ContarRegiao(const ArmazemAntenas* a, bool efeitos, int x0, int y0, int x1, int y1) {
+    const IndiceRegioes* r = a != NULL ? a->regioes : NULL;
+    if (r == NULL) {
+        return -1;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= r->largura) x1 = r->largura - 1;
+    if (y1 >= r->altura) y1 = r->altura - 1;
+    if (x0 > x1 || y0 > y1) {
+        return 0;
+    }
+    // Tiles totalmente cobertos pelo retângulo
+    int fx0 = (x0 + REGIAO_TILE - 1) / REGIAO_TILE;
+    int fy0 = (y0 + REGIAO_TILE - 1) / REGIAO_TILE;
+    int fx1 = (x1 == r->largura - 1) ? x1 / REGIAO_TILE : (x1 + 1) / REGIAO_TILE - 1;
+    int fy1 = (y1 == r->altura - 1) ? y1 / REGIAO_TILE : (y1 + 1) / REGIAO_TILE - 1;
+    const uint64_t* bits = efeitos ? r->bitsEfeitos : r->bitsAntenas;
+    if (fx0 > fx1 || fy0 > fy1) {
+        return ContarBitsRetangulo(r, bits, x0, y0, x1, y1);
+    }
+    long long total = FenwickRetangulo(efeitos ? r->fenwickEfeitos : r->fenwickAntenas, r->tilesX, fx0, fy0, fx1, fy1);
+    // Bordas fora dos tiles completos: faixas de cima e de baixo, e as partes laterais das linhas dos tiles completos
+    int cy0 = fy0 * REGIAO_TILE;
+    int cy1 = (fy1 + 1) * REGIAO_TILE - 1 < y1 ? (fy1 + 1) * REGIAO_TILE - 1 : y1;
+    total += ContarBitsRetangulo(r, bits, x0, y0, x1, cy0 - 1);
+    total += ContarBitsRetangulo(r, bits, x0, cy1 + 1, x1, y1);
+    total += ContarBitsRetangulo(r, bits, x0, cy0, fx0 * REGIAO_TILE - 1, cy1);
+    total += ContarBitsRetangulo(r, bits, (fx1 + 1) * REGIAO_TILE, cy0, x1, cy1);
+    return total;
+}
+
+/**
+ * \brief Conta as antenas dentro de um retângulo.
+ *
+ * \param a Ponteiro para o armazém (com índice de regiões).
+ * \param x0 Coordenada x mínima (inclusive).
+ * \param y0 Coordenada y mínima (inclusive).
+ * \param x1 Coordenada x máxima (inclusive).
+ * \param y1 Coordenada y máxima (inclusive).
+ * \return Número de antenas ou -1 se o armazém não tiver índice de regiões.
+ */
+long long ContarAntenasRegiao(const ArmazemAntenas* a, int x0, int y0, int x1, int y1) {
+    return ContarRegiao(a, false, x0, y0, x1, y1);
+}
+
+/**
+ * \brief Conta as células com efeito nefasto dentro de um retângulo.
+ *
+ * \param a Ponteiro para o armazém (com índice de regiões).
+ * \param x0 Coordenada x mínima (inclusive).
+ * \param y0 Coordenada y mínima (inclusive).
+ * \param x1 Coordenada x máxima (inclusive).
+ * \param y1 Coordenada y máxima (inclusive).
+ * \return Número de células com efeito ou -1 se o armazém não tiver índice de regiões.
+ */
+long long ContarEfeitosRegiao(const ArmazemAntenas* a, int x0, int y0, int x1, int y1) {
+    return ContarRegiao(a, true, x0, y0, x1, y1);
+}
+
+/**
+ * \brief Indica se uma célula tem efeito nefasto, segundo o índice de regiões.
+ *
+ * \return true se algum par de antenas gera efeito na célula.
+ */
+bool CelulaComEfeito(const ArmazemAntenas* a, int x, int y) {
+    return a != NULL && a->regioes != NULL && LerMultiplicidade(a->regioes, x, y) > 0;
+}
+#pragma endregion
+
+#pragma region Causas dos efeitos
+/**
+ * \brief Procura os pares de uma frequência que geram efeito nefasto numa célula.
+ *
+ * O par (p, q) gera efeito em c = 2p - q, logo para cada antena p da frequência
+ * basta procurar q = 2p - c na tabela de dispersão: O(k_f) sondagens.
+ *
+ * \param a Ponteiro para o armazém.
+ * \param freq Frequência.
+ * \param cx Coordenada x da célula.
+ * \param cy Coordenada y da célula.
+ * \param proximas Vetor de saída com o slot da antena mais próxima da célula (pode ser NULL).
+ * \param distantes Vetor de saída com o slot da outra antena do par (pode ser NULL).
+ * \param max Capacidade dos vetores de saída.
+ * \return Número de pares que geram o efeito (pode ser maior que max).
+ */
+int CausasEfeitoFreq(const ArmazemAntenas* a, char freq, int cx, int cy, int* proximas, int* distantes, int max) {
+    if (a == NULL || freq == '\0') {
+        return 0;
+    }
+    int id = ID_FREQ(a, freq);
+    const BaldeMorton* b = a->ordemMorton && id >= 0 ? a->baldes[id] : NULL;
+    if (a->ordemMorton && b == NULL) {
+        return 0;
+    }
+    int n = b != NULL ? b->numAntenas : a->numSlots;
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int p = b != NULL ? b->slot[i] : i;
+        if (a->freq[p] != freq) continue;
+        int qx = 2 * a->x[p] - cx, qy = 2 * a->y[p] - cy;
+        if (qx == a->x[p] && qy == a->y[p]) continue; // A antena está na própria célula
+        int q = ProcurarAntenaArmazem(a, qx, qy);
+        if (q < 0 || a->freq[q] != freq) continue;
+        if (total < max) {
+            if (proximas != NULL) proximas[total] = p;
+            if (distantes != NULL) distantes[total] = q;
+        }
+        total++;
+    }
+    return total;
+}
+
+/**
+ * \brief Procura os pares de todas as frequências que geram efeito nefasto numa célula.
+ *
+ * Com o índice de regiões ativo, uma célula sem efeito (ou fora do grid) é
+ * respondida sem sondagens.
+ *
+ * \return Número de pares que geram o efeito (pode ser maior que max).
+ */
+int CausasEfeito(const ArmazemAntenas* a, int cx, int cy, int* proximas, int* distantes, int max) {
+    if (a == NULL || (a->regioes != NULL && !CelulaComEfeito(a, cx, cy))) {
+        return 0;
+    }
+    bool presente[FREQ_IDS] = { false };
+    if (a->ordemMorton) {
+        for (int f = 0; f < a->numFreqs; f++) presente[f] = a->baldes[f] != NULL && a->baldes[f]->numAntenas > 1;
+    }
+    else {
+        for (int s = 0; s < a->numSlots; s++) {
+            if (a->freq[s] != '\0') presente[ID_FREQ(a, a->freq[s])] = true;
+        }
+    }
+    int total = 0;
+    for (int f = 0; f < a->numFreqs; f++) {
+        if (!presente[f]) continue;
+        int livre = total < max ? max - total : 0;
+        total += CausasEfeitoFreq(a, a->freqDoId[f], cx, cy,
+            proximas != NULL && livre > 0 ? proximas + total : NULL,
+            distantes != NULL && livre > 0 ? distantes + total : NULL, livre);
+    }
+    return total;
+}
+#pragma endregion
@@ -0,0 +1,355 @@
+/*****************************************************************//**
+ * \file   carga.c
+ * \brief  Gerador de carga para o servidor de consultas.
+ *
+ * Abre várias ligações (uma thread por ligação) e envia pedidos aleatórios
+ * com semente fixa, mantendo em cada ligação até --profundidade pedidos sem
+ * resposta (pipeline). No fim mostra o débito total no stderr e, por tipo de
+ * pedido, o número de pedidos e as latências p50, p99 e máxima (CSV ou JSON).
+ *
+ * Compilação (Linux, a partir da pasta servidor):
+ *
+ *   gcc -std=c11 -O2 -o carga carga.c ../compressao.c ../protocolo.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../efeitos.c ../estatisticas.c ../funcoes.c ../regioes.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * Utilização:
+ *
+ *   ./carga [--socket /tmp/antenas.sock] [--ligacoes 4] [--pedidos 100000]
+ *           [--profundidade 32] [--escritas 10] [--semente 1] [--formato csv|json]
+ *
+ * --pedidos é o número de pedidos por ligação e --escritas a percentagem de
+ * inserções e remoções (o resto são procuras, regiões, efeitos e procuras
+ * no grafo).
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../dados.h"
+#include "../funcoes.h"
+#include <threads.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_LIGACOES 64
+#define MAX_PROFUNDIDADE 4096
+
+static const char ALFABETO[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+/**
+ * \brief Parâmetros da carga.
+ */
+typedef struct Configuracao {
+    const char* caminho;
+    int numLigacoes;
+    int numPedidos;    // Por ligação
+    int profundidade;  // Pedidos sem resposta por ligação
+    int escritas;      // Percentagem de inserções e remoções
+    unsigned long long semente;
+    bool json;
+} Configuracao;
+
+/**
+ * \brief Trabalho de cada ligação.
+ */
+typedef struct Ligacao {
+    const Configuracao* c;
+    int indice;
+    int largura, altura;
+    unsigned char* tipos;  // Tipo de cada pedido
+    double* latencias;     // Latência de cada pedido, em segundos
+    int respondidos;
+    int erros;             // Respostas RESPOSTA_INVALIDO ou RESPOSTA_SEM_MEMORIA
+    bool falhou;
+} Ligacao;
+
+#pragma region Medição
+static double Agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int CompararDuplos(const void* p, const void* q) {
+    double a = *(const double*)p, b = *(const double*)q;
+    return (a > b) - (a < b);
+}
+
+/**
+ * \brief Percentil (0-100) de um vetor já ordenado, pelo método do posto mais próximo.
+ */
+static double Percentil(const double* v, int n, double p) {
+    if (n == 0) {
+        return 0;
+    }
+    int k = (int)(p / 100.0 * n + 0.999999);
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    return v[k - 1];
+}
+
+/**
+ * \brief Próximo número do gerador xorshift64*.
+ */
+static unsigned long long Aleatorio(unsigned long long* estado) {
+    unsigned long long x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+#pragma endregion
+
+#pragma region Ligações
+static int Ligar(const char* caminho) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&endereco, sizeof(endereco)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * \brief Gera um pedido aleatório segundo a mistura configurada.
+ */
+static void GerarPedido(const Ligacao* l, unsigned long long* estado, PedidoServidor* p) {
+    memset(p, 0, sizeof(*p));
+    int x = (int)(Aleatorio(estado) % (unsigned)l->largura);
+    int y = (int)(Aleatorio(estado) % (unsigned)l->altura);
+    int r = (int)(Aleatorio(estado) % 100);
+    p->args[0] = x;
+    p->args[1] = y;
+    if (r < l->c->escritas) {
+        p->tipo = (r & 1) ? PEDIDO_REMOVER : PEDIDO_INSERIR;
+        p->freq = ALFABETO[Aleatorio(estado) % 8];
+        return;
+    }
+    r = (int)(Aleatorio(estado) % 100);
+    if (r < 50) p->tipo = PEDIDO_PROCURAR;
+    else if (r < 85) {
+        p->tipo = PEDIDO_REGIAO;
+        p->args[2] = x + (int)(Aleatorio(estado) % 64);
+        p->args[3] = y + (int)(Aleatorio(estado) % 64);
+    }
+    else if (r < 90) p->tipo = PEDIDO_EFEITOS;
+    else if (r < 95) p->tipo = PEDIDO_BFS;
+    else p->tipo = PEDIDO_DFS;
+}
+
+/**
+ * \brief Pede as dimensões do grid (PEDIDO_INFO) antes de gerar pedidos.
+ */
+static bool PedirDimensoes(int fd, Ligacao* l) {
+    PedidoServidor p = { PEDIDO_INFO, 0, 0, { 0 }, false };
+    uint8_t buf[PROTOCOLO_MAX_RESPOSTA];
+    int tam = CodificarPedido(buf, &p);
+    if (send(fd, buf, (size_t)tam, MSG_NOSIGNAL) != tam) {
+        return false;
+    }
+    static _Thread_local RespostaServidor r;
+    size_t usados = 0;
+    while (usados < sizeof(buf)) {
+        ssize_t n = recv(fd, buf + usados, sizeof(buf) - usados, 0);
+        if (n <= 0) return false;
+        usados += (size_t)n;
+        if (DescodificarResposta(buf, buf + usados, &r) != NULL) break;
+    }
+    if (r.estado != RESPOSTA_OK || r.numValores < 3 || r.valores[1] <= 0 || r.valores[2] <= 0) {
+        return false;
+    }
+    l->largura = (int)r.valores[1];
+    l->altura = (int)r.valores[2];
+    return true;
+}
+
+static int ThreadLigacao(void* arg) {
+    Ligacao* l = (Ligacao*)arg;
+    const Configuracao* c = l->c;
+    int fd = Ligar(c->caminho);
+    if (fd < 0 || !PedirDimensoes(fd, l)) {
+        l->falhou = true;
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    unsigned long long estado = c->semente * 0x9E3779B97F4A7C15ull + (unsigned long long)l->indice + 1;
+    double* envio = (double*)malloc(((size_t)c->numPedidos + 1) * sizeof(double));
+    uint8_t* saida = (uint8_t*)malloc((size_t)MAX_PROFUNDIDADE * PROTOCOLO_MAX_PEDIDO);
+    uint8_t* entrada = (uint8_t*)malloc(1 << 16);
+    RespostaServidor* r = (RespostaServidor*)malloc(sizeof(RespostaServidor));
+    if (envio == NULL || saida == NULL || entrada == NULL || r == NULL) {
+        l->falhou = true;
+        free(envio);
+        free(saida);
+        free(entrada);
+        free(r);
+        close(fd);
+        return 1;
+    }
+
+    int gerados = 0;
+    size_t tamSaida = 0, enviados = 0, usados = 0;
+    while (l->respondidos < c->numPedidos) {
+        // Completa a janela de pedidos sem resposta
+        if (enviados == tamSaida) {
+            tamSaida = enviados = 0;
+            while (gerados < c->numPedidos && gerados - l->respondidos < c->profundidade) {
+                PedidoServidor p;
+                GerarPedido(l, &estado, &p);
+                p.id = (uint32_t)gerados;
+                l->tipos[gerados] = (unsigned char)p.tipo;
+                envio[gerados] = Agora();
+                tamSaida += CodificarPedido(saida + tamSaida, &p);
+                gerados++;
+            }
+        }
+        struct pollfd pfd = { fd, (short)(POLLIN | (enviados < tamSaida ? POLLOUT : 0)), 0 };
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if ((pfd.revents & POLLOUT) && enviados < tamSaida) {
+            ssize_t n = send(fd, saida + enviados, tamSaida - enviados, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) enviados += (size_t)n;
+            else if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+        }
+        if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        ssize_t n = recv(fd, entrada + usados, (1 << 16) - usados, MSG_DONTWAIT);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (n <= 0) break;
+        usados += (size_t)n;
+        double agora = Agora();
+        const uint8_t* pos = entrada;
+        const uint8_t* prox;
+        while ((prox = DescodificarResposta(pos, entrada + usados, r)) != NULL) {
+            if (r->id < (uint32_t)gerados) l->latencias[r->id] = agora - envio[r->id];
+            if (r->estado == RESPOSTA_INVALIDO || r->estado == RESPOSTA_SEM_MEMORIA) l->erros++;
+            l->respondidos++;
+            pos = prox;
+        }
+        usados = (size_t)(entrada + usados - pos);
+        memmove(entrada, pos, usados);
+    }
+    if (l->respondidos < c->numPedidos) l->falhou = true;
+    close(fd);
+    free(envio);
+    free(saida);
+    free(entrada);
+    free(r);
+    return 0;
+}
+#pragma endregion
+
+/**
+ * \brief Mostra as latências por tipo de pedido de todas as ligações.
+ */
+static void ReportarLatencias(const Configuracao* c, const Ligacao* ligacoes) {
+    size_t total = (size_t)c->numLigacoes * c->numPedidos;
+    double* amostras = (double*)malloc((total + 1) * sizeof(double));
+    if (amostras == NULL) {
+        return;
+    }
+    if (c->json) printf("[");
+    else printf("pedido,n,p50_us,p99_us,max_us\n");
+    bool primeiro = true;
+    for (int tipo = 0; tipo < PEDIDO_TIPOS; tipo++) {
+        int k = 0;
+        for (int i = 0; i < c->numLigacoes; i++) {
+            for (int j = 0; j < ligacoes[i].respondidos; j++) {
+                if (ligacoes[i].tipos[j] == tipo) amostras[k++] = ligacoes[i].latencias[j];
+            }
+        }
+        if (k == 0) continue;
+        qsort(amostras, k, sizeof(double), CompararDuplos);
+        double p50 = Percentil(amostras, k, 50) * 1e6;
+        double p99 = Percentil(amostras, k, 99) * 1e6;
+        double max = amostras[k - 1] * 1e6;
+        if (c->json) {
+            printf("%s\n  {\"pedido\": \"%s\", \"n\": %d, \"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f}",
+                primeiro ? "" : ",", NomePedido(tipo), k, p50, p99, max);
+        }
+        else {
+            printf("%s,%d,%.3f,%.3f,%.3f\n", NomePedido(tipo), k, p50, p99, max);
+        }
+        primeiro = false;
+    }
+    if (c->json) printf("\n]\n");
+    free(amostras);
+}
+
+int main(int argc, char** argv) {
+    Configuracao c = { "/tmp/antenas.sock", 4, 100000, 32, 10, 1, false };
+    for (int i = 1; i < argc; i++) {
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+        if (valor == NULL) {
+            fprintf(stderr, "Argumento sem valor: %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--socket") == 0) c.caminho = valor;
+        else if (strcmp(argv[i], "--ligacoes") == 0) c.numLigacoes = atoi(valor);
+        else if (strcmp(argv[i], "--pedidos") == 0) c.numPedidos = atoi(valor);
+        else if (strcmp(argv[i], "--profundidade") == 0) c.profundidade = atoi(valor);
+        else if (strcmp(argv[i], "--escritas") == 0) c.escritas = atoi(valor);
+        else if (strcmp(argv[i], "--semente") == 0) c.semente = strtoull(valor, NULL, 10);
+        else if (strcmp(argv[i], "--formato") == 0) c.json = strcmp(valor, "json") == 0;
+        else {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (c.numLigacoes < 1) c.numLigacoes = 1;
+    if (c.numLigacoes > MAX_LIGACOES) c.numLigacoes = MAX_LIGACOES;
+    if (c.numPedidos < 1) c.numPedidos = 1;
+    if (c.profundidade < 1) c.profundidade = 1;
+    if (c.profundidade > MAX_PROFUNDIDADE) c.profundidade = MAX_PROFUNDIDADE;
+
+    Ligacao ligacoes[MAX_LIGACOES];
+    thrd_t threads[MAX_LIGACOES];
+    for (int i = 0; i < c.numLigacoes; i++) {
+        ligacoes[i] = (Ligacao){ &c, i, 0, 0, NULL, NULL, 0, 0, false };
+        ligacoes[i].tipos = (unsigned char*)malloc((size_t)c.numPedidos);
+        ligacoes[i].latencias = (double*)calloc((size_t)c.numPedidos, sizeof(double));
+        if (ligacoes[i].tipos == NULL || ligacoes[i].latencias == NULL) {
+            fprintf(stderr, "Sem memoria para as latencias\n");
+            return 1;
+        }
+    }
+    double inicio = Agora();
+    for (int i = 0; i < c.numLigacoes; i++) {
+        thrd_create(&threads[i], ThreadLigacao, &ligacoes[i]);
+    }
+    long long respondidos = 0, erros = 0;
+    int falhadas = 0;
+    for (int i = 0; i < c.numLigacoes; i++) {
+        thrd_join(threads[i], NULL);
+        respondidos += ligacoes[i].respondidos;
+        erros += ligacoes[i].erros;
+        if (ligacoes[i].falhou) falhadas++;
+    }
+    double duracao = Agora() - inicio;
+    fprintf(stderr, "%d ligacoes, %lld pedidos em %.3f s (%.0f pedidos/s), %lld erros, %d ligacoes falhadas\n",
+        c.numLigacoes, respondidos, duracao, duracao > 0 ? respondidos / duracao : 0, erros, falhadas);
+    ReportarLatencias(&c, ligacoes);
+    for (int i = 0; i < c.numLigacoes; i++) {
+        free(ligacoes[i].tipos);
+        free(ligacoes[i].latencias);
+    }
+    return falhadas > 0 ? 1 : 0;
+}
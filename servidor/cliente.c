@@ -0,0 +1,201 @@
+/*****************************************************************//**
+ * \file   cliente.c
+ * \brief  Cliente de linha de comandos do servidor de consultas.
+ *
+ * Envia um pedido indicado nos argumentos ou, sem argumentos, um pedido por
+ * linha do stdin. Os pedidos do stdin são enviados sem esperar pelas
+ * respostas (pipeline) e as respostas são mostradas pela mesma ordem.
+ *
+ * Compilação (Linux, a partir da pasta servidor):
+ *
+ *   gcc -std=c11 -O2 -o cliente cliente.c ../compressao.c ../protocolo.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../efeitos.c ../estatisticas.c ../funcoes.c ../regioes.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * Utilização:
+ *
+ *   ./cliente [--socket /tmp/antenas.sock] info
+ *   ./cliente inserir A 3 4 | remover 3 4 | procurar 3 4 | efeitos
+ *   ./cliente regiao 0 0 9 9 | bfs 3 4 | dfs 3 4 | salvar
+ *   ./cliente < pedidos.txt
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../dados.h"
+#include "../funcoes.h"
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_PEDIDOS 65536
+
+static const char* NOMES_ESTADO[] = { "ok", "invalido", "nao_existe", "duplicada", "fora_grid", "sem_memoria" };
+
+/**
+ * \brief Liga ao socket do servidor.
+ *
+ * \return Descritor da ligação ou -1 em caso de erro.
+ */
+static int Ligar(const char* caminho) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&endereco, sizeof(endereco)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * \brief Interpreta um pedido escrito como "tipo [freq] args...".
+ *
+ * \return true se o pedido é válido.
+ */
+static bool LerPedido(char** palavras, int n, PedidoServidor* p) {
+    memset(p, 0, sizeof(*p));
+    p->tipo = -1;
+    for (int t = 0; t < PEDIDO_TIPOS; t++) {
+        if (n > 0 && strcmp(palavras[0], NomePedido(t)) == 0) p->tipo = t;
+    }
+    if (p->tipo < 0) {
+        return false;
+    }
+    int i = 1;
+    if (p->tipo == PEDIDO_INSERIR) {
+        if (n < 2 || strlen(palavras[1]) != 1) return false;
+        p->freq = palavras[i++][0];
+    }
+    if (n - i != ArgumentosPedido(p->tipo)) {
+        return false;
+    }
+    for (int k = 0; i < n; k++, i++) {
+        p->args[k] = atoi(palavras[i]);
+    }
+    return true;
+}
+
+/**
+ * \brief Divide uma linha em palavras (altera a linha).
+ */
+static int DividirLinha(char* linha, char** palavras, int max) {
+    int n = 0;
+    for (char* t = strtok(linha, " \t\r\n"); t != NULL && n < max; t = strtok(NULL, " \t\r\n")) {
+        palavras[n++] = t;
+    }
+    return n;
+}
+
+static void MostrarResposta(const PedidoServidor* p, const RespostaServidor* r) {
+    const char* estado = r->estado >= 0 && r->estado <= RESPOSTA_SEM_MEMORIA ? NOMES_ESTADO[r->estado] : "?";
+    printf("%u %s %s", r->id, NomePedido(p->tipo), estado);
+    for (int i = 0; i < r->numValores; i++) {
+        if (p->tipo == PEDIDO_PROCURAR) printf(" %c", (char)r->valores[i]);
+        else printf(" %lld", r->valores[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    const char* caminho = "/tmp/antenas.sock";
+    int primeiro = 1;
+    if (argc > 2 && strcmp(argv[1], "--socket") == 0) {
+        caminho = argv[2];
+        primeiro = 3;
+    }
+
+    // Pedidos: dos argumentos ou do stdin (uma linha por pedido)
+    PedidoServidor* pedidos = (PedidoServidor*)malloc(MAX_PEDIDOS * sizeof(PedidoServidor));
+    uint8_t* envio = (uint8_t*)malloc((size_t)MAX_PEDIDOS * PROTOCOLO_MAX_PEDIDO);
+    if (pedidos == NULL || envio == NULL) {
+        fprintf(stderr, "Sem memoria\n");
+        return 1;
+    }
+    int numPedidos = 0;
+    if (primeiro < argc) {
+        if (!LerPedido(argv + primeiro, argc - primeiro, &pedidos[0])) {
+            fprintf(stderr, "Pedido invalido\n");
+            return 1;
+        }
+        numPedidos = 1;
+    }
+    else {
+        char linha[256];
+        char* palavras[8];
+        int numLinha = 0;
+        while (numPedidos < MAX_PEDIDOS && fgets(linha, sizeof(linha), stdin) != NULL) {
+            numLinha++;
+            int n = DividirLinha(linha, palavras, 8);
+            if (n == 0 || palavras[0][0] == '#') continue;
+            if (!LerPedido(palavras, n, &pedidos[numPedidos])) {
+                fprintf(stderr, "Linha %d: pedido invalido\n", numLinha);
+                continue;
+            }
+            numPedidos++;
+        }
+    }
+    size_t tamEnvio = 0;
+    for (int i = 0; i < numPedidos; i++) {
+        pedidos[i].id = (uint32_t)i;
+        tamEnvio += CodificarPedido(envio + tamEnvio, &pedidos[i]);
+    }
+
+    int fd = Ligar(caminho);
+    if (fd < 0) {
+        fprintf(stderr, "Nao foi possivel ligar a %s\n", caminho);
+        return 1;
+    }
+
+    // Envia e recebe ao mesmo tempo: com muitos pedidos os buffers do socket enchem nos dois sentidos
+    static uint8_t buf[1 << 16];
+    static RespostaServidor resposta;
+    size_t enviado = 0;
+    size_t usados = 0;
+    int recebidas = 0;
+    while (recebidas < numPedidos) {
+        struct pollfd pfd = { fd, (short)(POLLIN | (enviado < tamEnvio ? POLLOUT : 0)), 0 };
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if ((pfd.revents & POLLOUT) && enviado < tamEnvio) {
+            ssize_t n = send(fd, envio + enviado, tamEnvio - enviado, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) enviado += (size_t)n;
+            else if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+        }
+        if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        ssize_t n = recv(fd, buf + usados, sizeof(buf) - usados, MSG_DONTWAIT);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (n <= 0) break;
+        usados += (size_t)n;
+        const uint8_t* pos = buf;
+        const uint8_t* prox;
+        while ((prox = DescodificarResposta(pos, buf + usados, &resposta)) != NULL) {
+            if (resposta.id < (uint32_t)numPedidos) MostrarResposta(&pedidos[resposta.id], &resposta);
+            recebidas++;
+            pos = prox;
+        }
+        usados = (size_t)(buf + usados - pos);
+        memmove(buf, pos, usados);
+    }
+    close(fd);
+    free(pedidos);
+    free(envio);
+    if (recebidas < numPedidos) {
+        fprintf(stderr, "%d respostas em falta\n", numPedidos - recebidas);
+        return 1;
+    }
+    return 0;
+}
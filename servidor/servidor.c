@@ -0,0 +1,383 @@
+/*****************************************************************//**
+ * \file   servidor.c
+ * \brief  Servidor de consultas sobre um socket Unix, com o armazém sempre em memória.
+ *
+ * Carrega as antenas uma vez (como o programa principal) e atende pedidos
+ * de inserção, remoção, procura, efeitos, regiões e procuras no grafo com o
+ * protocolo de protocolo.c. A thread principal espera por dados em todas as
+ * ligações com poll e entrega cada ligação com dados a um conjunto fixo de
+ * threads; a thread executa os pedidos já recebidos dessa ligação, envia as
+ * respostas de uma só vez e devolve a ligação ao poll. Nenhuma thread fica
+ * presa a um cliente, pelo que muitas ligações partilham poucas threads e os
+ * clientes podem enviar pedidos em pipeline.
+ *
+ * Compilação (Linux, a partir da pasta servidor):
+ *
+ *   gcc -std=c11 -O2 -o servidor servidor.c ../armazem.c ../baldes.c \
+ *       ../bitboard.c ../carregamento.c ../compressao.c ../efeitos.c \
+ *       ../estatisticas.c ../funcoes.c ../protocolo.c ../regioes.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * Utilização (na pasta dos ficheiros antenas.*):
+ *
+ *   ./servidor [--socket /tmp/antenas.sock] [--threads 0] [--prefixo antenas]
+ *
+ * As antenas são carregadas de prefixo.zbin, prefixo.bin ou prefixo.txt, e
+ * é aí que PEDIDO_SALVAR grava. Termina com SIGINT ou SIGTERM e, se houve
+ * alterações, grava prefixo.bin, prefixo.txt e prefixo.zbin.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../dados.h"
+#include "../funcoes.h"
+#include <threads.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_THREADS 32       // Abaixo de VERSOES_MAX_LEITORES
+#define MAX_LIGACOES 256     // Ligações abertas em simultâneo
+#define TAM_ENTRADA 65536
+#define TAM_SAIDA (1 << 20)
+
+static volatile sig_atomic_t terminar = 0;
+
+#define LIGACAO_LIVRE 0      // Posição sem ligação
+#define LIGACAO_ESPERA 1     // À espera de dados, no poll da thread principal
+#define LIGACAO_PRONTA 2     // Com dados, na fila das threads de atendimento
+#define LIGACAO_ATENDIDA 3   // A ser atendida por uma thread
+
+/**
+ * \brief Ligação aberta, com os pedidos recebidos e ainda incompletos.
+ */
+typedef struct Ligacao {
+    int fd;
+    int estado;
+    uint8_t* entrada;
+    size_t usados;
+} Ligacao;
+
+/**
+ * \brief Ligações abertas e fila das que têm dados, partilhadas com as threads de atendimento.
+ */
+typedef struct FilaLigacoes {
+    Ligacao ligacoes[MAX_LIGACOES];
+    int prontas[MAX_LIGACOES]; // Índices das ligações com dados (fila circular)
+    int inicio, num;
+    int despertar[2];          // Pipe que acorda o poll quando uma ligação volta a esperar
+    bool fechada;
+    mtx_t lock;
+    cnd_t disponivel;
+} FilaLigacoes;
+
+/**
+ * \brief Thread de atendimento.
+ */
+typedef struct Atendedor {
+    ServidorAntenas* servidor;
+    FilaLigacoes* fila;
+    long long pedidos;
+} Atendedor;
+
+static void PedirTerminacao(int sinal) {
+    (void)sinal;
+    terminar = 1;
+}
+
+#pragma region Carregamento
+/**
+ * \brief Carrega as antenas pela mesma ordem que o programa principal.
+ */
+static ArmazemAntenas* CarregarAntenas(const char* prefixo) {
+    char nome[512];
+    snprintf(nome, sizeof(nome), "%s.zbin", prefixo);
+    ArmazemAntenas* a = CarregarArmazemComprimido(nome);
+    snprintf(nome, sizeof(nome), "%s.bin", prefixo);
+    if (a == NULL) a = CarregarArmazemDeBin(nome);
+    snprintf(nome, sizeof(nome), "%s.txt", prefixo);
+    if (a == NULL) a = CarregarArmazemDeTxt(nome);
+    if (a == NULL) a = CriarArmazem(GRID_TAM, GRID_TAM);
+    return a;
+}
+#pragma endregion
+
+#pragma region Atendimento
+/**
+ * \brief Escreve todo o buffer no socket.
+ */
+static bool EscreverTudo(int fd, const uint8_t* buf, size_t tam) {
+    while (tam > 0) {
+        ssize_t n = send(fd, buf, tam, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        tam -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * \brief Atende um lote de uma ligação: um recv sem bloquear e todos os pedidos completos.
+ *
+ * \return true se a ligação deve voltar ao poll, false se deve ser fechada.
+ */
+static bool AtenderLigacao(Atendedor* at, int leitor, Ligacao* lig, uint8_t* saida) {
+    if (lig->usados == TAM_ENTRADA) return false; // Pedido maior do que o buffer
+    ssize_t n;
+    do {
+        n = recv(lig->fd, lig->entrada + lig->usados, TAM_ENTRADA - lig->usados, MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (n <= 0) return false;
+    lig->usados += (size_t)n;
+
+    // Executa todos os pedidos completos e responde de uma só vez
+    RespostaServidor resposta;
+    const uint8_t* pos = lig->entrada;
+    const uint8_t* fim = lig->entrada + lig->usados;
+    size_t tamSaida = 0;
+    PedidoServidor pedido;
+    const uint8_t* prox;
+    while ((prox = DescodificarPedido(pos, fim, &pedido)) != NULL) {
+        bool valido = ExecutarPedido(at->servidor, leitor, &pedido, &resposta);
+        at->pedidos++;
+        tamSaida += CodificarResposta(saida + tamSaida, &resposta);
+        if (!valido) {
+            EscreverTudo(lig->fd, saida, tamSaida);
+            return false;
+        }
+        pos = prox;
+        if (tamSaida > TAM_SAIDA - PROTOCOLO_MAX_RESPOSTA) {
+            if (!EscreverTudo(lig->fd, saida, tamSaida)) return false;
+            tamSaida = 0;
+        }
+    }
+    if (tamSaida > 0 && !EscreverTudo(lig->fd, saida, tamSaida)) {
+        return false;
+    }
+    lig->usados = (size_t)(fim - pos);
+    memmove(lig->entrada, pos, lig->usados);
+    return true;
+}
+
+/**
+ * \brief Fecha uma ligação e liberta a sua posição (com o lock da fila).
+ */
+static void FecharLigacao(Ligacao* lig) {
+    close(lig->fd);
+    free(lig->entrada);
+    lig->entrada = NULL;
+    lig->usados = 0;
+    lig->estado = LIGACAO_LIVRE;
+}
+
+static int ThreadAtender(void* arg) {
+    Atendedor* at = (Atendedor*)arg;
+    FilaLigacoes* fila = at->fila;
+    int leitor = RegistarLeitorServidor(at->servidor);
+    uint8_t* saida = (uint8_t*)malloc(TAM_SAIDA);
+    if (leitor < 0 || saida == NULL) {
+        free(saida);
+        return 1;
+    }
+    while (true) {
+        mtx_lock(&fila->lock);
+        while (fila->num == 0 && !fila->fechada) cnd_wait(&fila->disponivel, &fila->lock);
+        if (fila->num == 0) {
+            mtx_unlock(&fila->lock);
+            break;
+        }
+        Ligacao* lig = &fila->ligacoes[fila->prontas[fila->inicio]];
+        fila->inicio = (fila->inicio + 1) % MAX_LIGACOES;
+        fila->num--;
+        lig->estado = LIGACAO_ATENDIDA;
+        mtx_unlock(&fila->lock);
+
+        bool manter = !terminar && AtenderLigacao(at, leitor, lig, saida);
+
+        // Devolve a ligação ao poll (ou fecha-a) e acorda a thread principal
+        mtx_lock(&fila->lock);
+        if (manter) lig->estado = LIGACAO_ESPERA;
+        else FecharLigacao(lig);
+        mtx_unlock(&fila->lock);
+        char sinal = 0;
+        (void)!write(fila->despertar[1], &sinal, 1);
+    }
+    RemoverLeitorServidor(at->servidor, leitor);
+    free(saida);
+    return 0;
+}
+#pragma endregion
+
+int main(int argc, char** argv) {
+    const char* caminho = "/tmp/antenas.sock";
+    const char* prefixo = "antenas";
+    int numThreads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) caminho = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--prefixo") == 0 && i + 1 < argc) prefixo = argv[++i];
+        else {
+            fprintf(stderr, "Utilizacao: %s [--socket caminho] [--threads N] [--prefixo antenas]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (numThreads <= 0) numThreads = NumeroProcessadores();
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+
+    ArmazemAntenas* armazem = CarregarAntenas(prefixo);
+    AtivarOrdemMorton(armazem);
+    GR* grafo = CriarGrafoSobreArmazem(armazem);
+    ServidorAntenas* servidor = CriarServidorAntenas(armazem, grafo, prefixo);
+    if (servidor == NULL) {
+        fprintf(stderr, "Sem memoria para iniciar o servidor\n");
+        return 1;
+    }
+    unsigned long long versaoInicial = armazem->versao;
+
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Caminho do socket demasiado longo: %s\n", caminho);
+        return 1;
+    }
+    strcpy(endereco.sun_path, caminho);
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminho);
+    if (escuta < 0 || bind(escuta, (struct sockaddr*)&endereco, sizeof(endereco)) < 0 || listen(escuta, 128) < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    // Sem SA_RESTART: o poll é interrompido pelo sinal
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = PedirTerminacao;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    FilaLigacoes fila;
+    memset(&fila, 0, sizeof(fila));
+    if (pipe(fila.despertar) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    // Sem bloquear: um pipe cheio já garante que o poll acorda
+    fcntl(fila.despertar[0], F_SETFL, O_NONBLOCK);
+    fcntl(fila.despertar[1], F_SETFL, O_NONBLOCK);
+    mtx_init(&fila.lock, mtx_plain);
+    cnd_init(&fila.disponivel);
+    Atendedor atendedores[MAX_THREADS];
+    thrd_t threads[MAX_THREADS];
+    // As threads de atendimento herdam os sinais bloqueados: só o poll é interrompido
+    sigset_t sinais, anteriores;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sinais, &anteriores);
+    for (int k = 0; k < numThreads; k++) {
+        atendedores[k] = (Atendedor){ servidor, &fila, 0 };
+        if (thrd_create(&threads[k], ThreadAtender, &atendedores[k]) != thrd_success) {
+            numThreads = k;
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+    fprintf(stderr, "%d antenas em memoria, %d threads, a escutar em %s\n", armazem->numAntenas, numThreads, caminho);
+
+    // Espera por novas ligações e por dados nas ligações que não estão a ser atendidas
+    struct pollfd eventos[MAX_LIGACOES + 2];
+    int indices[MAX_LIGACOES];
+    while (!terminar) {
+        int num = 0;
+        eventos[num++] = (struct pollfd){ escuta, POLLIN, 0 };
+        eventos[num++] = (struct pollfd){ fila.despertar[0], POLLIN, 0 };
+        mtx_lock(&fila.lock);
+        for (int k = 0; k < MAX_LIGACOES; k++) {
+            if (fila.ligacoes[k].estado != LIGACAO_ESPERA) continue;
+            indices[num - 2] = k;
+            eventos[num++] = (struct pollfd){ fila.ligacoes[k].fd, POLLIN, 0 };
+        }
+        mtx_unlock(&fila.lock);
+
+        if (poll(eventos, (nfds_t)num, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (eventos[1].revents != 0) {
+            char lixo[64];
+            while (read(fila.despertar[0], lixo, sizeof(lixo)) > 0) {}
+        }
+
+        // Fecho e erros também seguem para uma thread, que fecha a ligação
+        mtx_lock(&fila.lock);
+        for (int i = 2; i < num; i++) {
+            if (eventos[i].revents == 0) continue;
+            int k = indices[i - 2];
+            fila.ligacoes[k].estado = LIGACAO_PRONTA;
+            fila.prontas[(fila.inicio + fila.num) % MAX_LIGACOES] = k;
+            fila.num++;
+            cnd_signal(&fila.disponivel);
+        }
+        mtx_unlock(&fila.lock);
+
+        if (eventos[0].revents & POLLIN) {
+            int fd = accept(escuta, NULL, NULL);
+            if (fd < 0) continue;
+            mtx_lock(&fila.lock);
+            Ligacao* lig = NULL;
+            for (int k = 0; k < MAX_LIGACOES && lig == NULL; k++) {
+                if (fila.ligacoes[k].estado == LIGACAO_LIVRE) lig = &fila.ligacoes[k];
+            }
+            uint8_t* entrada = lig != NULL ? (uint8_t*)malloc(TAM_ENTRADA) : NULL;
+            if (entrada == NULL) {
+                close(fd); // Demasiadas ligações ou sem memória
+            }
+            else {
+                *lig = (Ligacao){ fd, LIGACAO_ESPERA, entrada, 0 };
+            }
+            mtx_unlock(&fila.lock);
+        }
+    }
+
+    // Fecha a fila e desbloqueia as threads que estão a enviar respostas
+    close(escuta);
+    unlink(caminho);
+    mtx_lock(&fila.lock);
+    fila.fechada = true;
+    for (int k = 0; k < MAX_LIGACOES; k++) {
+        if (fila.ligacoes[k].estado == LIGACAO_ATENDIDA) shutdown(fila.ligacoes[k].fd, SHUT_RDWR);
+    }
+    cnd_broadcast(&fila.disponivel);
+    mtx_unlock(&fila.lock);
+    long long pedidos = 0;
+    for (int k = 0; k < numThreads; k++) {
+        thrd_join(threads[k], NULL);
+        pedidos += atendedores[k].pedidos;
+    }
+    for (int k = 0; k < MAX_LIGACOES; k++) {
+        if (fila.ligacoes[k].estado != LIGACAO_LIVRE) FecharLigacao(&fila.ligacoes[k]);
+    }
+    close(fila.despertar[0]);
+    close(fila.despertar[1]);
+    fprintf(stderr, "%lld pedidos atendidos\n", pedidos);
+
+    if (armazem->versao != versaoInicial) {
+        SalvarArmazemComPrefixo(armazem, prefixo);
+        fprintf(stderr, "Antenas gravadas em %s.*\n", prefixo);
+    }
+    DestruirServidorAntenas(servidor);
+    mtx_destroy(&fila.lock);
+    cnd_destroy(&fila.disponivel);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*****************************************************************//**
+ * \file   carregamento.c
+ * \brief  Testes de regressão do carregamento paralelo contra o sequencial.
+ *
+ * Grava um armazém aleatório em TXT e BIN e confirma que os carregadores
+ * paralelos devolvem as mesmas antenas que CarregarAntenasDeTxt e
+ * CarregarAntenasDeBin, com vários números de threads (incluindo mais
+ * threads do que linhas) e com fins de linha CRLF.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o carregamento carregamento.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+#define FICHEIRO_TXT "teste_carregamento.txt"
+#define FICHEIRO_BIN "teste_carregamento.bin"
+
+static const int threads[] = { 1, 2, 3, 7, 16, GRID_TAM + 5 };
+
+/**
+ * \brief Passa uma lista para um grid (um símbolo por célula) e liberta-a.
+ *
+ * \return Número de antenas da lista ou -1 se houver posições repetidas ou fora do grid.
+ */
+static int ListaParaGrid(Antena* lista, char* grid) {
+    memset(grid, '.', (size_t)GRID_TAM * GRID_TAM);
+    int n = 0;
+    bool valida = true;
+    while (lista != NULL) {
+        Antena* p = lista->prox;
+        if (lista->x < 0 || lista->y < 0 || lista->x >= GRID_TAM || lista->y >= GRID_TAM ||
+            grid[(size_t)lista->y * GRID_TAM + lista->x] != '.') valida = false;
+        else grid[(size_t)lista->y * GRID_TAM + lista->x] = lista->freq;
+        n++;
+        free(lista);
+        lista = p;
+    }
+    return valida ? n : -1;
+}
+
+/**
+ * \brief Compara os carregadores paralelos com o sequencial para um ficheiro.
+ */
+static bool CompararCarregadores(const char* nome, bool binario) {
+    size_t celulas = (size_t)GRID_TAM * GRID_TAM;
+    char* esperado = (char*)malloc(celulas);
+    char* obtido = (char*)malloc(celulas);
+    CONFIRMAR(esperado != NULL && obtido != NULL, "sem memoria para os grids");
+    int n = ListaParaGrid(binario ? CarregarAntenasDeBin(nome) : CarregarAntenasDeTxt(nome), esperado);
+    bool ok = n > 0;
+    for (size_t k = 0; ok && k < sizeof(threads) / sizeof(threads[0]); k++) {
+        Antena* lista = binario ? CarregarAntenasDeBinParalelo(nome, threads[k]) : CarregarAntenasDeTxtParalelo(nome, threads[k]);
+        int m = ListaParaGrid(lista, obtido);
+        if (m != n || memcmp(esperado, obtido, celulas) != 0) {
+            fprintf(stderr, "  %s com %d threads: %d antenas, esperadas %d\n", nome, threads[k], m, n);
+            ok = false;
+        }
+    }
+    free(esperado);
+    free(obtido);
+    return ok;
+}
+
+static bool TxtIgualAoSequencial(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(5, GRID_TAM * GRID_TAM / 10, 62);
+    CONFIRMAR(a != NULL && SalvarArmazemEmTxt(a, FICHEIRO_TXT), "falhou a gravacao");
+    DestruirArmazem(a);
+    bool ok = CompararCarregadores(FICHEIRO_TXT, false);
+    remove(FICHEIRO_TXT);
+    CONFIRMAR(ok, "o carregamento paralelo do TXT difere do sequencial");
+    return true;
+}
+
+static bool BinIgualAoSequencial(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(6, GRID_TAM * GRID_TAM / 10, 62);
+    CONFIRMAR(a != NULL && SalvarArmazemEmBin(a, FICHEIRO_BIN), "falhou a gravacao");
+    DestruirArmazem(a);
+    bool ok = CompararCarregadores(FICHEIRO_BIN, true);
+    remove(FICHEIRO_BIN);
+    CONFIRMAR(ok, "o carregamento paralelo do BIN difere do sequencial");
+    return true;
+}
+
+static bool TxtComCrlf(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(7, GRID_TAM * GRID_TAM / 20, 10);
+    CONFIRMAR(a != NULL, "sem memoria para o armazem");
+    FILE* f = fopen(FICHEIRO_TXT, "wb");
+    CONFIRMAR(f != NULL, "nao foi possivel criar %s", FICHEIRO_TXT);
+    for (int y = 0; y < GRID_TAM; y++) {
+        for (int x = 0; x < GRID_TAM; x++) {
+            int s = ProcurarAntenaArmazem(a, x, y);
+            fputc(s >= 0 ? a->freq[s] : '.', f);
+        }
+        fputs("\r\n", f);
+    }
+    fclose(f);
+    DestruirArmazem(a);
+    bool ok = CompararCarregadores(FICHEIRO_TXT, false);
+    remove(FICHEIRO_TXT);
+    CONFIRMAR(ok, "o carregamento paralelo do TXT com CRLF difere do sequencial");
+    return true;
+}
+
+static bool ArmazemIgualAoLote(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(8, GRID_TAM * GRID_TAM / 10, 30);
+    CONFIRMAR(a != NULL && SalvarArmazemEmBin(a, FICHEIRO_BIN) && SalvarArmazemEmTxt(a, FICHEIRO_TXT), "falhou a gravacao");
+    ArmazemAntenas* doBin = CarregarArmazemDeBin(FICHEIRO_BIN);
+    ArmazemAntenas* doTxt = CarregarArmazemDeTxt(FICHEIRO_TXT);
+    bool ok = MesmasAntenas(a, doBin) && MesmasAntenas(a, doTxt);
+    DestruirArmazem(a);
+    DestruirArmazem(doBin);
+    DestruirArmazem(doTxt);
+    remove(FICHEIRO_BIN);
+    remove(FICHEIRO_TXT);
+    CONFIRMAR(ok, "o armazem carregado difere do gravado");
+    return true;
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(TxtIgualAoSequencial, falhas);
+    CORRER(BinIgualAoSequencial, falhas);
+    CORRER(TxtComCrlf, falhas);
+    CORRER(ArmazemIgualAoLote, falhas);
+    return falhas == 0 ? 0 : 1;
+}
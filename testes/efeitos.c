@@ -0,0 +1,294 @@
+/*****************************************************************//**
+ * \file   efeitos.c
+ * \brief  Testes diferenciais dos efeitos nefastos e das consultas derivadas.
+ *
+ * Compara com a força bruta (todos os pares da mesma frequência): o motor de
+ * bitboards e o gerador de efeitos, a cache de efeitos depois de inserções e
+ * remoções (nos dois modos), as causas de cada célula (com e sem índice de
+ * regiões e baldes de Morton), as k antenas mais próximas e as arestas do
+ * grafo por raio mantidas de forma incremental.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o efeitos efeitos.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+/**
+ * \brief Preenche um armazém com antenas aleatórias (algumas removidas, para haver slots livres).
+ */
+static ArmazemAntenas* ArmazemPequeno(unsigned semente, int largura, int altura, int n, const char* freqs) {
+    srand(semente);
+    ArmazemAntenas* a = CriarArmazem(largura, altura);
+    int numFreqs = (int)strlen(freqs);
+    for (int i = 0; a != NULL && i < n; i++) {
+        InserirAntenaArmazem(a, freqs[rand() % numFreqs], rand() % largura, rand() % altura);
+    }
+    for (int s = 0; a != NULL && s < a->numSlots; s += 5) {
+        if (a->freq[s] != '\0') RemoverAntenaArmazem(a, s);
+    }
+    return a;
+}
+
+/**
+ * \brief Conta, por célula, os pares da mesma frequência que geram efeito nela (por força bruta).
+ *
+ * \param harmonicos Com true marca todas as células da reta de cada par (contagem 1).
+ * \return Número de pares de antenas da mesma frequência.
+ */
+static long long EfeitosForcaBruta(const ArmazemAntenas* a, bool harmonicos, int* contagem) {
+    memset(contagem, 0, (size_t)a->largura * a->altura * sizeof(int));
+    long long pares = 0;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        for (int t = s + 1; t < a->numSlots; t++) {
+            if (a->freq[t] != a->freq[s]) continue;
+            pares++;
+            int dx = a->x[t] - a->x[s], dy = a->y[t] - a->y[s];
+            if (harmonicos) {
+                for (int y = 0; y < a->altura; y++) {
+                    for (int x = 0; x < a->largura; x++) {
+                        if ((long long)(x - a->x[s]) * dy == (long long)(y - a->y[s]) * dx) contagem[(size_t)y * a->largura + x] = 1;
+                    }
+                }
+                continue;
+            }
+            int ex[2] = { a->x[s] - dx, a->x[t] + dx };
+            int ey[2] = { a->y[s] - dy, a->y[t] + dy };
+            for (int e = 0; e < 2; e++) {
+                if (ex[e] >= 0 && ey[e] >= 0 && ex[e] < a->largura && ey[e] < a->altura) contagem[(size_t)ey[e] * a->largura + ex[e]]++;
+            }
+        }
+    }
+    return pares;
+}
+
+/**
+ * \brief Compara um conjunto de efeitos com a contagem da força bruta (célula a célula).
+ */
+static bool MesmoConjunto(const ConjuntoEfeitos* c, const ArmazemAntenas* a, const int* contagem, const char* origem) {
+    CONFIRMAR(c != NULL, "%s: sem conjunto", origem);
+    for (int y = 0; y < a->altura; y++) {
+        for (int x = 0; x < a->largura; x++) {
+            CONFIRMAR(TemEfeito(c, x, y) == (contagem[(size_t)y * a->largura + x] > 0), "%s: celula (%d, %d) errada", origem, x, y);
+        }
+    }
+    return true;
+}
+
+static bool BitboardIgualAoGerador(void) {
+    // Grid completo de 64 colunas e um grid menor (máscara parcial e linhas a menos)
+    const int dims[][2] = { { BITBOARD_TAM, BITBOARD_TAM }, { 45, 33 }, { 1, 64 } };
+    for (size_t k = 0; k < sizeof(dims) / sizeof(dims[0]); k++) {
+        int largura = dims[k][0], altura = dims[k][1];
+        ArmazemAntenas* a = ArmazemPequeno(20 + (unsigned)k, largura, altura, largura * altura / 6, "ABCDEFGHIJ");
+        int* contagem = (int*)malloc((size_t)largura * altura * sizeof(int));
+        ConjuntoEfeitos* bitboard = CriarConjuntoEfeitos(largura, altura);
+        ConjuntoEfeitos* gerados = CriarConjuntoEfeitos(largura, altura);
+        MotorBitboard* m = CriarMotorBitboard(a);
+        GeradorEfeitos* g = CriarGeradorEfeitosArmazem(a);
+        bool ok = a != NULL && contagem != NULL && bitboard != NULL && gerados != NULL && m != NULL && g != NULL;
+        if (ok) {
+            long long pares = EfeitosForcaBruta(a, false, contagem);
+            int xs[64], ys[64], n;
+            long long total = 0;
+            while ((n = ProximosEfeitos(g, xs, ys, 64)) > 0) {
+                for (int i = 0; i < n; i++) MarcarEfeito(gerados, xs[i], ys[i]);
+                total += n;
+            }
+            ok = EfeitosBitboard(m, bitboard) && MesmoConjunto(bitboard, a, contagem, "bitboard") &&
+                MesmoConjunto(gerados, a, contagem, "gerador");
+            if (ok && (total != 2 * pares || ContarEfeitosArmazem(a) != 2 * pares)) {
+                fprintf(stderr, "  %dx%d: %lld efeitos gerados, esperados %lld\n", largura, altura, total, 2 * pares);
+                ok = false;
+            }
+        }
+        DestruirGeradorEfeitos(g);
+        DestruirMotorBitboard(m);
+        DestruirConjuntoEfeitos(bitboard);
+        DestruirConjuntoEfeitos(gerados);
+        free(contagem);
+        DestruirArmazem(a);
+        CONFIRMAR(ok, "o grid %dx%d divergiu da forca bruta", largura, altura);
+    }
+    return true;
+}
+
+static bool CacheAcompanhaAlteracoes(void) {
+    // 64x64 passa pelo motor de bitboards (com GRID_TAM <= 64) e 90x70 pelo gerador
+    const int dims[][2] = { { BITBOARD_TAM, BITBOARD_TAM }, { 90, 70 } };
+    for (size_t k = 0; k < sizeof(dims) / sizeof(dims[0]); k++) {
+        int largura = dims[k][0], altura = dims[k][1];
+        ArmazemAntenas* a = ArmazemPequeno(30 + (unsigned)k, largura, altura, 40, "abc");
+        int* contagem = (int*)malloc((size_t)largura * altura * sizeof(int));
+        bool ok = a != NULL && contagem != NULL;
+        for (int it = 0; ok && it < 120; it++) {
+            int modo = it % 2 == 0 ? EFEITOS_PONTOS : EFEITOS_HARMONICOS;
+            const ConjuntoEfeitos* c = EfeitosEmCache(a, modo);
+            EfeitosForcaBruta(a, modo == EFEITOS_HARMONICOS, contagem);
+            ok = MesmoConjunto(c, a, contagem, modo == EFEITOS_HARMONICOS ? "cache (harmonicos)" : "cache (pontos)");
+            // Sem alterações a cache é devolvida tal como está
+            ok = ok && EfeitosEmCache(a, modo) == c;
+            int x = rand() % largura, y = rand() % altura;
+            int s = ProcurarAntenaArmazem(a, x, y);
+            if (s >= 0 && rand() % 3 == 0) RemoverAntenaArmazem(a, s);
+            else InserirAntenaArmazem(a, "abc"[rand() % 3], x, y);
+        }
+        DestruirArmazem(a);
+        free(contagem);
+        CONFIRMAR(ok, "a cache do grid %dx%d nao acompanhou as alteracoes", largura, altura);
+    }
+    return true;
+}
+
+/**
+ * \brief Compara CausasEfeito com a contagem da força bruta em todas as células.
+ */
+static bool ConfereCausas(const ArmazemAntenas* a, const int* contagem, int* proximas, int* distantes, int max) {
+    for (int cy = -2; cy < a->altura + 2; cy++) {
+        for (int cx = -2; cx < a->largura + 2; cx++) {
+            bool dentro = cx >= 0 && cy >= 0 && cx < a->largura && cy < a->altura;
+            int esperadas = dentro ? contagem[(size_t)cy * a->largura + cx] : 0;
+            int n = CausasEfeito(a, cx, cy, proximas, distantes, max);
+            // Fora do grid só o índice de regiões responde sem sondagens
+            if (!dentro && a->regioes == NULL) continue;
+            CONFIRMAR(n == esperadas, "celula (%d, %d): %d causas, esperadas %d", cx, cy, n, esperadas);
+            for (int i = 0; i < n && i < max; i++) {
+                int p = proximas[i], q = distantes[i];
+                CONFIRMAR(a->freq[p] != '\0' && a->freq[p] == a->freq[q] && p != q &&
+                    2 * a->x[p] - a->x[q] == cx && 2 * a->y[p] - a->y[q] == cy, "celula (%d, %d): par %d/%d errado", cx, cy, p, q);
+            }
+        }
+    }
+    return true;
+}
+
+static bool CausasContraForcaBruta(void) {
+    ArmazemAntenas* a = ArmazemPequeno(40, 96, 80, 700, "xyz");
+    int* contagem = (int*)malloc((size_t)96 * 80 * sizeof(int));
+    int proximas[64], distantes[64];
+    CONFIRMAR(a != NULL && contagem != NULL, "sem memoria para o armazem");
+    EfeitosForcaBruta(a, false, contagem);
+    // Sondagem direta, com baldes de Morton e com o índice de regiões
+    bool ok = ConfereCausas(a, contagem, proximas, distantes, 64);
+    ok = ok && AtivarOrdemMorton(a) && ConfereCausas(a, contagem, proximas, distantes, 64);
+    ok = ok && CriarIndiceRegioes(a) != NULL && ConfereCausas(a, contagem, proximas, distantes, 64);
+    // Vetores de saída pequenos: a contagem é a mesma e só max pares são escritos
+    ok = ok && ConfereCausas(a, contagem, proximas, distantes, 1);
+    DestruirArmazem(a);
+    free(contagem);
+    CONFIRMAR(ok, "as causas divergiram da forca bruta");
+    return true;
+}
+
+static long long Distancia2(const ArmazemAntenas* a, int s, int x, int y) {
+    long long dx = a->x[s] - x, dy = a->y[s] - y;
+    return dx * dx + dy * dy;
+}
+
+static int CompararDistancias(const void* p, const void* q) {
+    long long a = *(const long long*)p, b = *(const long long*)q;
+    return (a > b) - (a < b);
+}
+
+/**
+ * \brief Compara AntenasMaisProximas com a ordenação de todas as antenas da frequência.
+ */
+static bool ConfereVizinhos(const ArmazemAntenas* a, long long* todas, int* slots) {
+    for (int q = 0; q < 400; q++) {
+        char freq = "pqrs"[rand() % 4];
+        int x = rand() % (a->largura + 40) - 20, y = rand() % (a->altura + 40) - 20;
+        int k = 1 + rand() % (q % 10 == 0 ? 200 : 12);
+        int n = 0;
+        for (int s = 0; s < a->numSlots; s++) {
+            if (a->freq[s] == freq) todas[n++] = Distancia2(a, s, x, y);
+        }
+        qsort(todas, (size_t)n, sizeof(long long), CompararDistancias);
+        int esperadas = n < k ? n : k;
+        int encontradas = AntenasMaisProximas(a, freq, x, y, k, slots);
+        CONFIRMAR(encontradas == esperadas, "(%d, %d) freq %c k %d: %d antenas, esperadas %d", x, y, freq, k, encontradas, esperadas);
+        for (int i = 0; i < encontradas; i++) {
+            CONFIRMAR(a->freq[slots[i]] == freq && Distancia2(a, slots[i], x, y) == todas[i],
+                "(%d, %d) freq %c k %d: a antena %d nao e a %d.a mais proxima", x, y, freq, k, slots[i], i + 1);
+        }
+    }
+    return true;
+}
+
+static bool VizinhosContraForcaBruta(void) {
+    ArmazemAntenas* a = ArmazemPequeno(50, 300, 200, 2500, "pqrs");
+    long long* todas = a != NULL ? (long long*)malloc((size_t)a->numSlots * sizeof(long long)) : NULL;
+    int* slots = (int*)malloc(200 * sizeof(int));
+    CONFIRMAR(a != NULL && todas != NULL && slots != NULL, "sem memoria para o armazem");
+    srand(51);
+    bool ok = ConfereVizinhos(a, todas, slots);
+    ok = ok && AtivarOrdemMorton(a) && ConfereVizinhos(a, todas, slots);
+    DestruirArmazem(a);
+    free(todas);
+    free(slots);
+    CONFIRMAR(ok, "as antenas mais proximas divergiram da forca bruta");
+    return true;
+}
+
+/**
+ * \brief Confirma que as arestas de cada vértice são exatamente as antenas da mesma frequência a distância <= raio.
+ */
+static bool ConfereArestasRaio(const GR* g, int* grau) {
+    const ArmazemAntenas* a = g->armazem;
+    long long raio2 = (long long)g->raio * g->raio;
+    CONFIRMAR(g->numVertices == a->numAntenas, "%d vertices para %d antenas", g->numVertices, a->numAntenas);
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') {
+            CONFIRMAR(g->adjacentes[s] == NULL, "slot livre %d com arestas", s);
+            continue;
+        }
+        memset(grau, 0, (size_t)a->numSlots * sizeof(int));
+        for (const Aresta* e = g->adjacentes[s]; e != NULL; e = e->prox) {
+            int t = e->destino - 1;
+            CONFIRMAR(t >= 0 && t < a->numSlots && ++grau[t] == 1, "slot %d: aresta para %d invalida ou repetida", s, t);
+        }
+        for (int t = 0; t < a->numSlots; t++) {
+            bool vizinho = t != s && a->freq[t] == a->freq[s] && Distancia2(a, t, a->x[s], a->y[s]) <= raio2;
+            CONFIRMAR(vizinho == (grau[t] == 1), "slot %d: aresta para %d %s", s, t, vizinho ? "em falta" : "a mais");
+        }
+    }
+    return true;
+}
+
+static bool GrafoRaioIncremental(void) {
+    ArmazemAntenas* a = ArmazemPequeno(60, 120, 90, 500, "uvw");
+    GR* g = a != NULL ? CriarGrafoRaio(a, 9) : NULL;
+    int* grau = (int*)malloc((size_t)120 * 90 * sizeof(int));
+    CONFIRMAR(g != NULL && grau != NULL, "sem memoria para o grafo");
+    bool ok = ConfereArestasRaio(g, grau);
+    for (int it = 1; ok && it <= 1500; it++) {
+        int x = rand() % 120, y = rand() % 90;
+        int s = ProcurarAntenaArmazem(a, x, y);
+        if (s >= 0 && rand() % 2 == 0) ok = RemoverVerticeArmazem(g, IdVertice(a, s));
+        else ok = InserirVerticeArmazem(g, "uvw"[rand() % 3], x, y) != ARMAZEM_SEM_MEMORIA;
+        if (ok && it % 250 == 0) ok = ConfereArestasRaio(g, grau);
+    }
+    DestruirGrafo(g);
+    DestruirArmazem(a);
+    free(grau);
+    CONFIRMAR(ok, "as arestas do grafo por raio divergiram da forca bruta");
+    return true;
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(BitboardIgualAoGerador, falhas);
+    CORRER(CacheAcompanhaAlteracoes, falhas);
+    CORRER(CausasContraForcaBruta, falhas);
+    CORRER(VizinhosContraForcaBruta, falhas);
+    CORRER(GrafoRaioIncremental, falhas);
+    return falhas == 0 ? 0 : 1;
+}
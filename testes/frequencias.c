@@ -0,0 +1,147 @@
+/*****************************************************************//**
+ * \file   frequencias.c
+ * \brief  Testes de regressão das frequências internadas (ids densos).
+ *
+ * Aplica inserções e remoções aleatórias com rótulos de todo o intervalo de
+ * um byte (incluindo os acima de 127) num armazém de 64 x 64, com e sem a
+ * ordem de Morton, e confirma que os ids ficam densos e estáveis e que o
+ * conjunto de efeitos, o motor de bitboards, o índice de regiões e a cópia do
+ * armazém dão os mesmos efeitos que a força bruta.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o frequencias frequencias.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+#define LADO BITBOARD_TAM
+#define RONDAS 30
+
+/**
+ * \brief Rótulo aleatório entre numRotulos rótulos espalhados por 1..255.
+ */
+static char RotuloAleatorio(int numRotulos) {
+    return (char)(1 + (rand() % numRotulos) * 254 / (numRotulos - 1));
+}
+
+/**
+ * \brief Confirma que os ids do armazém são densos, estáveis e coincidem com os do modelo.
+ *
+ * \param idModelo Id + 1 atribuído a cada rótulo pela ordem de aparecimento (0 se nunca apareceu).
+ */
+static bool ConfereIds(const ArmazemAntenas* a, const int* idModelo, int numModelo) {
+    CONFIRMAR(NumeroFrequencias(a) == numModelo, "%d frequencias internadas, esperadas %d", NumeroFrequencias(a), numModelo);
+    for (int f = 1; f < 256; f++) {
+        int id = IdFrequencia(a, (char)f);
+        CONFIRMAR(id == idModelo[f] - 1, "rotulo %d com id %d, esperado %d", f, id, idModelo[f] - 1);
+        CONFIRMAR(id < 0 || (unsigned char)a->freqDoId[id] == f, "o id %d nao devolve o rotulo %d", id, f);
+    }
+    return true;
+}
+
+/**
+ * \brief Compara os efeitos do armazém por todos os caminhos com a força bruta.
+ */
+static bool ConfereEfeitos(const ArmazemAntenas* a, bool* efeito) {
+    memset(efeito, 0, LADO * LADO * sizeof(bool));
+    long long celulas = 0;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        for (int t = s + 1; t < a->numSlots; t++) {
+            if (a->freq[t] != a->freq[s]) continue;
+            int ex[2] = { 2 * a->x[s] - a->x[t], 2 * a->x[t] - a->x[s] };
+            int ey[2] = { 2 * a->y[s] - a->y[t], 2 * a->y[t] - a->y[s] };
+            for (int e = 0; e < 2; e++) {
+                if (ex[e] < 0 || ey[e] < 0 || ex[e] >= LADO || ey[e] >= LADO || efeito[ey[e] * LADO + ex[e]]) continue;
+                efeito[ey[e] * LADO + ex[e]] = true;
+                celulas++;
+            }
+        }
+    }
+    ConjuntoEfeitos* conjunto = CalcularConjuntoEfeitos(a, EFEITOS_PONTOS);
+    ConjuntoEfeitos* bitboard = CriarConjuntoEfeitos(LADO, LADO);
+    MotorBitboard* m = CriarMotorBitboard(a);
+    bool calculado = conjunto != NULL && bitboard != NULL && EfeitosBitboard(m, bitboard);
+    int divergentes = 0;
+    for (int y = 0; calculado && y < LADO; y++) {
+        for (int x = 0; x < LADO; x++) {
+            bool esperado = efeito[y * LADO + x];
+            divergentes += TemEfeito(conjunto, x, y) != esperado || TemEfeito(bitboard, x, y) != esperado ||
+                (a->regioes != NULL && CelulaComEfeito(a, x, y) != esperado);
+        }
+    }
+    long long regiao = a->regioes != NULL ? ContarEfeitosRegiao(a, 0, 0, LADO - 1, LADO - 1) : celulas;
+    DestruirConjuntoEfeitos(conjunto);
+    DestruirConjuntoEfeitos(bitboard);
+    DestruirMotorBitboard(m);
+    CONFIRMAR(calculado, "sem memoria para os efeitos");
+    CONFIRMAR(divergentes == 0, "%d celulas divergem da forca bruta", divergentes);
+    CONFIRMAR(regiao == celulas, "o indice de regioes conta %lld celulas, esperadas %lld", regiao, celulas);
+    return true;
+}
+
+/**
+ * \brief Inserções e remoções aleatórias, conferindo os ids e os efeitos do armazém e de uma cópia.
+ */
+static bool InsercoesERemocoes(bool morton) {
+    srand(morton ? 71 : 70);
+    ArmazemAntenas* a = CriarArmazem(LADO, LADO);
+    bool* efeito = (bool*)malloc(LADO * LADO * sizeof(bool));
+    CONFIRMAR(a != NULL && efeito != NULL && (!morton || AtivarOrdemMorton(a)) && CriarIndiceRegioes(a) != NULL,
+        "sem memoria para o armazem");
+    int idModelo[256] = { 0 };
+    int numModelo = 0;
+    bool ok = true;
+    for (int r = 0; ok && r < RONDAS; r++) {
+        // Mais rótulos em cada ronda, até cobrir todo o intervalo de um byte
+        int numRotulos = 2 + r * 253 / (RONDAS - 1);
+        for (int i = 0; ok && i < 150; i++) {
+            char f = RotuloAleatorio(numRotulos);
+            if (InserirAntenaArmazem(a, f, rand() % LADO, rand() % LADO) >= 0 && idModelo[(unsigned char)f] == 0) {
+                idModelo[(unsigned char)f] = ++numModelo;
+            }
+        }
+        // Remove cerca de metade (os ids das frequências esvaziadas não são reutilizados)
+        for (int s = 0; s < a->numSlots; s++) {
+            if (a->freq[s] != '\0' && rand() % 2 == 0) RemoverAntenaArmazem(a, s);
+        }
+        ok = ConfereIds(a, idModelo, numModelo) && ConfereEfeitos(a, efeito);
+
+        // A cópia tem os mesmos ids e efeitos e interna os rótulos novos da mesma forma
+        ArmazemAntenas* c = ok ? CopiarArmazem(a) : NULL;
+        ok = ok && c != NULL && MesmasAntenas(a, c) && ConfereIds(c, idModelo, numModelo) && ConfereEfeitos(c, efeito);
+        int novo = 255;
+        while (novo > 0 && idModelo[novo] != 0) novo--;
+        if (ok && novo > 0 && InserirAntenaArmazem(c, (char)novo, rand() % LADO, rand() % LADO) >= 0) {
+            ok = IdFrequencia(c, (char)novo) == numModelo && IdFrequencia(a, (char)novo) < 0;
+        }
+        DestruirArmazem(c);
+    }
+    DestruirArmazem(a);
+    free(efeito);
+    CONFIRMAR(ok, "o armazem divergiu do modelo");
+    return true;
+}
+
+static bool SemOrdemMorton(void) {
+    return InsercoesERemocoes(false);
+}
+
+static bool ComOrdemMorton(void) {
+    return InsercoesERemocoes(true);
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(SemOrdemMorton, falhas);
+    CORRER(ComOrdemMorton, falhas);
+    return falhas == 0 ? 0 : 1;
+}
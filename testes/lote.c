@@ -0,0 +1,151 @@
+/*****************************************************************//**
+ * \file   lote.c
+ * \brief  Testes de regressão da inserção em lote e das remoções no armazém.
+ *
+ * Aplica lotes aleatórios (com duplicados no lote e no armazém, entradas
+ * fora do grid e frequências vazias) intercalados com remoções, e compara o
+ * armazém, o estado de cada entrada, os baldes de Morton e o índice de
+ * regiões com um modelo simples (um símbolo por célula). Os lotes pequenos e
+ * grandes seguem caminhos diferentes (atualização entrada a entrada ou
+ * reconstrução dos índices) e são ambos exercitados.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o lote lote.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+#define RONDAS 40
+#define MAX_LOTE 5000
+
+/**
+ * \brief Confirma que o armazém e os seus índices têm exatamente as antenas do modelo.
+ */
+static bool ConfereModelo(const ArmazemAntenas* a, const char* modelo, int* slots) {
+    int n = 0;
+    for (int y = 0; y < GRID_TAM; y++) {
+        for (int x = 0; x < GRID_TAM; x++) {
+            char f = modelo[(size_t)y * GRID_TAM + x];
+            int s = ProcurarAntenaArmazem(a, x, y);
+            if (f == '\0') CONFIRMAR(s < 0, "antena a mais em (%d, %d)", x, y);
+            else CONFIRMAR(s >= 0 && a->freq[s] == f, "antena em falta ou errada em (%d, %d)", x, y);
+            n += f != '\0';
+        }
+    }
+    CONFIRMAR(a->numAntenas == n, "numAntenas = %d, esperadas %d", a->numAntenas, n);
+    CONFIRMAR(ContarAntenasRegiao(a, 0, 0, GRID_TAM - 1, GRID_TAM - 1) == n, "o indice de regioes nao conta todas as antenas");
+    CONFIRMAR(ConsultarRetangulo(a, 0, 0, GRID_TAM - 1, GRID_TAM - 1, slots, GRID_TAM * GRID_TAM) == n, "os baldes nao devolvem todas as antenas");
+    int x0 = rand() % GRID_TAM, y0 = rand() % GRID_TAM;
+    int x1 = x0 + rand() % (GRID_TAM - x0), y1 = y0 + rand() % (GRID_TAM - y0);
+    int dentro = 0;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) dentro += modelo[(size_t)y * GRID_TAM + x] != '\0';
+    }
+    CONFIRMAR(ConsultarRetangulo(a, x0, y0, x1, y1, slots, GRID_TAM * GRID_TAM) == dentro, "retangulo (%d,%d)-(%d,%d) difere do modelo", x0, y0, x1, y1);
+    CONFIRMAR(ContarAntenasRegiao(a, x0, y0, x1, y1) == dentro, "regiao (%d,%d)-(%d,%d) difere do modelo", x0, y0, x1, y1);
+    return true;
+}
+
+static bool LotesERemocoes(void) {
+    srand(9);
+    size_t celulas = (size_t)GRID_TAM * GRID_TAM;
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    char* modelo = (char*)calloc(celulas, 1);
+    int* slots = (int*)malloc(celulas * sizeof(int));
+    char* freq = (char*)malloc(MAX_LOTE);
+    int* x = (int*)malloc(MAX_LOTE * sizeof(int));
+    int* y = (int*)malloc(MAX_LOTE * sizeof(int));
+    signed char* estado = (signed char*)malloc(MAX_LOTE);
+    bool ok = a != NULL && modelo != NULL && slots != NULL && freq != NULL && x != NULL && y != NULL && estado != NULL &&
+        AtivarOrdemMorton(a) && CriarIndiceRegioes(a) != NULL;
+    for (int r = 0; ok && r < RONDAS; r++) {
+        // Lotes pequenos (<= 64 entradas) e grandes alternados
+        int n = r % 2 == 0 ? 1 + rand() % 64 : 65 + rand() % (MAX_LOTE - 65);
+        int aceites = 0;
+        for (int i = 0; i < n; i++) {
+            freq[i] = rand() % 50 == 0 ? '\0' : (char)('a' + rand() % 26);
+            if (i > 0 && rand() % 10 == 0) { // Repete uma entrada anterior do lote
+                int j = rand() % i;
+                x[i] = x[j];
+                y[i] = y[j];
+            }
+            else {
+                x[i] = rand() % (GRID_TAM + 6) - 3;
+                y[i] = rand() % (GRID_TAM + 6) - 3;
+            }
+        }
+        int inseridas = InserirAntenasEmLote(a, freq, x, y, n, estado);
+        // Estado esperado: fica a primeira ocorrência de cada célula livre
+        for (int i = 0; ok && i < n; i++) {
+            int esperado;
+            if (x[i] < 0 || y[i] < 0 || x[i] >= GRID_TAM || y[i] >= GRID_TAM || freq[i] == '\0') esperado = ARMAZEM_FORA_GRID;
+            else if (modelo[(size_t)y[i] * GRID_TAM + x[i]] != '\0') esperado = ARMAZEM_DUPLICADA;
+            else {
+                modelo[(size_t)y[i] * GRID_TAM + x[i]] = freq[i];
+                esperado = 0;
+                aceites++;
+            }
+            if (estado[i] != esperado) {
+                fprintf(stderr, "  ronda %d, entrada %d: estado %d, esperado %d\n", r, i, estado[i], esperado);
+                ok = false;
+            }
+        }
+        if (ok && inseridas != aceites) {
+            fprintf(stderr, "  ronda %d: %d inseridas, esperadas %d\n", r, inseridas, aceites);
+            ok = false;
+        }
+        ok = ok && ConfereModelo(a, modelo, slots);
+
+        // Remove cerca de um terço das antenas (algumas tentativas caem em células vazias)
+        for (int k = 0; ok && k < a->numAntenas / 3 + 10; k++) {
+            int rx = rand() % GRID_TAM, ry = rand() % GRID_TAM;
+            int s = ProcurarAntenaArmazem(a, rx, ry);
+            if (s >= 0) {
+                ok = RemoverAntenaArmazem(a, s);
+                modelo[(size_t)ry * GRID_TAM + rx] = '\0';
+            }
+        }
+        ok = ok && ConfereModelo(a, modelo, slots);
+    }
+    DestruirArmazem(a);
+    free(modelo);
+    free(slots);
+    free(freq);
+    free(x);
+    free(y);
+    free(estado);
+    CONFIRMAR(ok, "o armazem divergiu do modelo");
+    return true;
+}
+
+static bool LotesDegenerados(void) {
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    CONFIRMAR(a != NULL, "sem memoria para o armazem");
+    char freq[1] = { 'A' };
+    int x[1] = { 0 }, y[1] = { 0 };
+    int vazio = InserirAntenasEmLote(a, freq, x, y, 0, NULL);
+    int negativo = InserirAntenasEmLote(a, freq, x, y, -1, NULL);
+    int um = InserirAntenasEmLote(a, freq, x, y, 1, NULL);
+    int repetido = InserirAntenasEmLote(a, freq, x, y, 1, NULL);
+    int total = a->numAntenas;
+    DestruirArmazem(a);
+    CONFIRMAR(vazio == 0, "lote vazio devolveu %d", vazio);
+    CONFIRMAR(negativo < 0, "lote com n negativo foi aceite");
+    CONFIRMAR(um == 1 && repetido == 0 && total == 1, "reinsercao: %d, %d, %d antenas", um, repetido, total);
+    return true;
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(LotesERemocoes, falhas);
+    CORRER(LotesDegenerados, falhas);
+    return falhas == 0 ? 0 : 1;
+}
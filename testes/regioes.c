@@ -0,0 +1,115 @@
+/*****************************************************************//**
+ * \file   regioes.c
+ * \brief  Testes de regressão do índice de regiões contra a força bruta.
+ *
+ * Num armazém com dimensões que não são múltiplas de REGIAO_TILE, aplica
+ * inserções e remoções (individuais e em lote) e compara as contagens de
+ * antenas e de efeitos de retângulos aleatórios (incluindo retângulos que
+ * saem do grid, que cobrem tiles completos e que ficam dentro de um só tile)
+ * e CelulaComEfeito com o grid calculado por força bruta.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o regioes regioes.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+#define LARGURA (4 * REGIAO_TILE + 45)
+#define ALTURA (3 * REGIAO_TILE + 25)
+#define CONSULTAS 300
+
+/**
+ * \brief Marca as células com efeito (pares da mesma frequência, 2a - b e 2b - a) por força bruta.
+ */
+static void EfeitosForcaBruta(const ArmazemAntenas* a, bool* efeito) {
+    memset(efeito, 0, (size_t)LARGURA * ALTURA * sizeof(bool));
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        for (int t = s + 1; t < a->numSlots; t++) {
+            if (a->freq[t] != a->freq[s]) continue;
+            int ex[2] = { 2 * a->x[s] - a->x[t], 2 * a->x[t] - a->x[s] };
+            int ey[2] = { 2 * a->y[s] - a->y[t], 2 * a->y[t] - a->y[s] };
+            for (int e = 0; e < 2; e++) {
+                if (ex[e] >= 0 && ey[e] >= 0 && ex[e] < LARGURA && ey[e] < ALTURA) efeito[(size_t)ey[e] * LARGURA + ex[e]] = true;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Compara consultas aleatórias do índice com a força bruta.
+ */
+static bool ConfereConsultas(const ArmazemAntenas* a, const bool* efeito) {
+    for (int y = 0; y < ALTURA; y++) {
+        for (int x = 0; x < LARGURA; x++) {
+            CONFIRMAR(CelulaComEfeito(a, x, y) == efeito[(size_t)y * LARGURA + x], "CelulaComEfeito(%d, %d) errada", x, y);
+        }
+    }
+    for (int q = 0; q < CONSULTAS; q++) {
+        // Retângulos grandes (com tiles completos), pequenos e a sair do grid
+        int x0 = rand() % (LARGURA + 20) - 10, y0 = rand() % (ALTURA + 20) - 10;
+        int x1 = x0 + rand() % (q % 2 ? LARGURA : REGIAO_TILE + 6);
+        int y1 = y0 + rand() % (q % 3 ? ALTURA : REGIAO_TILE + 6);
+        long long antenas = 0, efeitos = 0;
+        for (int y = y0 < 0 ? 0 : y0; y <= y1 && y < ALTURA; y++) {
+            for (int x = x0 < 0 ? 0 : x0; x <= x1 && x < LARGURA; x++) {
+                antenas += ProcurarAntenaArmazem(a, x, y) >= 0;
+                efeitos += efeito[(size_t)y * LARGURA + x];
+            }
+        }
+        long long ca = ContarAntenasRegiao(a, x0, y0, x1, y1);
+        long long ce = ContarEfeitosRegiao(a, x0, y0, x1, y1);
+        CONFIRMAR(ca == antenas && ce == efeitos, "(%d,%d)-(%d,%d): antenas %lld/%lld, efeitos %lld/%lld",
+            x0, y0, x1, y1, ca, antenas, ce, efeitos);
+    }
+    return true;
+}
+
+static bool ContagensContraForcaBruta(void) {
+    srand(11);
+    ArmazemAntenas* a = CriarArmazem(LARGURA, ALTURA);
+    bool* efeito = (bool*)malloc((size_t)LARGURA * ALTURA * sizeof(bool));
+    CONFIRMAR(a != NULL && efeito != NULL && AtivarOrdemMorton(a) && CriarIndiceRegioes(a) != NULL, "sem memoria para o armazem");
+    bool ok = true;
+    for (int it = 1; ok && it <= 800; it++) {
+        int x = rand() % LARGURA, y = rand() % ALTURA;
+        int s = ProcurarAntenaArmazem(a, x, y);
+        if (s >= 0 && rand() % 3 == 0) RemoverAntenaArmazem(a, s);
+        else InserirAntenaArmazem(a, "abcd"[rand() % 4], x, y);
+        if (it % 100 == 0) {
+            EfeitosForcaBruta(a, efeito);
+            ok = ConfereConsultas(a, efeito);
+        }
+    }
+    // Um lote grande reconstrói o índice em vez de o atualizar antena a antena
+    char freq[500];
+    int xs[500], ys[500];
+    for (int i = 0; i < 500; i++) {
+        freq[i] = "abcdef"[rand() % 6];
+        xs[i] = rand() % LARGURA;
+        ys[i] = rand() % ALTURA;
+    }
+    ok = ok && InserirAntenasEmLote(a, freq, xs, ys, 500, NULL) > 64;
+    if (ok) {
+        EfeitosForcaBruta(a, efeito);
+        ok = ConfereConsultas(a, efeito);
+    }
+    DestruirArmazem(a);
+    free(efeito);
+    CONFIRMAR(ok, "o indice de regioes divergiu da forca bruta");
+    return true;
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(ContagensContraForcaBruta, falhas);
+    return falhas == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/*****************************************************************//**
+ * \file   snapshots.c
+ * \brief  Testes de regressão dos snapshots comprimidos (ida e volta).
+ *
+ * Grava armazéns e listas aleatórios em snapshots comprimidos e confirma que
+ * a leitura completa, a leitura bloco a bloco e a conversão para lista
+ * devolvem exatamente as mesmas antenas, e que snapshots truncados ou com
+ * cabeçalho ou índice incoerentes são rejeitados.
+ *
+ * Compilação (Linux, a partir da pasta testes):
+ *
+ *   gcc -std=c11 -O2 -DGRID_TAM=512 -o snapshots snapshots.c \
+ *       ../armazem.c ../baldes.c ../bitboard.c ../carregamento.c \
+ *       ../compressao.c ../efeitos.c ../estatisticas.c ../fragmentos.c \
+ *       ../funcoes.c ../protocolo.c ../rastreio.c ../regioes.c ../tiles.c \
+ *       ../versoes.c -pthread -lm
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "testes.h"
+
+#define FICHEIRO "teste_snapshot.zbin"
+
+static bool ArmazemIdaEVolta(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(1, GRID_TAM * GRID_TAM / 8, 40);
+    CONFIRMAR(a != NULL && a->numAntenas > 0, "sem memoria para o armazem");
+    CONFIRMAR(SalvarArmazemComprimido(a, FICHEIRO), "falhou a gravacao");
+    ArmazemAntenas* b = CarregarArmazemComprimido(FICHEIRO);
+    bool iguais = MesmasAntenas(a, b);
+    int lidas = b != NULL ? b->numAntenas : -1;
+    DestruirArmazem(b);
+    int esperadas = a->numAntenas;
+    DestruirArmazem(a);
+    remove(FICHEIRO);
+    CONFIRMAR(iguais, "%d antenas gravadas, %d lidas ou conteudo diferente", esperadas, lidas);
+    return true;
+}
+
+static bool ArmazemVazio(void) {
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    CONFIRMAR(a != NULL && SalvarArmazemComprimido(a, FICHEIRO), "falhou a gravacao");
+    ArmazemAntenas* b = CarregarArmazemComprimido(FICHEIRO);
+    bool iguais = MesmasAntenas(a, b);
+    DestruirArmazem(a);
+    DestruirArmazem(b);
+    remove(FICHEIRO);
+    CONFIRMAR(iguais, "o snapshot vazio nao devolveu um armazem vazio");
+    return true;
+}
+
+static bool BlocosIndividuais(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(2, 5 * SNAPSHOT_REGISTOS_POR_BLOCO + 17, 12);
+    CONFIRMAR(a != NULL && SalvarArmazemComprimido(a, FICHEIRO), "falhou a gravacao");
+    char freq[SNAPSHOT_REGISTOS_POR_BLOCO];
+    int x[SNAPSHOT_REGISTOS_POR_BLOCO], y[SNAPSHOT_REGISTOS_POR_BLOCO];
+    int total = 0, erradas = 0, n;
+    for (int bloco = 0; (n = LerBlocoComprimido(FICHEIRO, bloco, freq, x, y)) >= 0; bloco++) {
+        total += n;
+        for (int i = 0; i < n; i++) {
+            int s = ProcurarAntenaArmazem(a, x[i], y[i]);
+            erradas += s < 0 || a->freq[s] != freq[i];
+        }
+    }
+    int esperadas = a->numAntenas;
+    DestruirArmazem(a);
+    remove(FICHEIRO);
+    CONFIRMAR(total == esperadas && erradas == 0, "%d antenas nos blocos (%d erradas), esperadas %d", total, erradas, esperadas);
+    return true;
+}
+
+static bool ListaIdaEVolta(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(3, 3000, 62);
+    CONFIRMAR(a != NULL, "sem memoria para o armazem");
+    Antena* lista = NULL;
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] != '\0') lista = InserirAntena(lista, a->freq[s], a->x[s], a->y[s]);
+    }
+    bool gravado = SalvarAntenasComprimidas(lista, FICHEIRO);
+    Antena* lida = CarregarAntenasComprimidas(FICHEIRO);
+    int numLidas = 0, erradas = 0;
+    for (Antena* p = lida; p != NULL; p = p->prox) {
+        int s = ProcurarAntenaArmazem(a, p->x, p->y);
+        erradas += s < 0 || a->freq[s] != p->freq;
+        numLidas++;
+    }
+    int esperadas = a->numAntenas;
+    for (Antena* l = lista; l != NULL; ) { Antena* p = l->prox; free(l); l = p; }
+    for (Antena* l = lida; l != NULL; ) { Antena* p = l->prox; free(l); l = p; }
+    DestruirArmazem(a);
+    remove(FICHEIRO);
+    CONFIRMAR(gravado, "falhou a gravacao da lista");
+    CONFIRMAR(numLidas == esperadas && erradas == 0, "%d antenas lidas (%d erradas), esperadas %d", numLidas, erradas, esperadas);
+    return true;
+}
+
+static bool SnapshotTruncado(void) {
+    ArmazemAntenas* a = ArmazemAleatorio(4, 4000, 20);
+    CONFIRMAR(a != NULL && SalvarArmazemComprimido(a, FICHEIRO), "falhou a gravacao");
+    DestruirArmazem(a);
+    FILE* f = fopen(FICHEIRO, "rb");
+    CONFIRMAR(f != NULL, "snapshot nao encontrado");
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = (uint8_t*)malloc((size_t)tam);
+    size_t lidos = buf != NULL ? fread(buf, 1, (size_t)tam, f) : 0;
+    fclose(f);
+    f = fopen(FICHEIRO, "wb");
+    if (f != NULL) {
+        fwrite(buf, 1, lidos / 2, f);
+        fclose(f);
+    }
+    free(buf);
+    ArmazemAntenas* b = CarregarArmazemComprimido(FICHEIRO);
+    DestruirArmazem(b);
+    remove(FICHEIRO);
+    CONFIRMAR(b == NULL, "o snapshot truncado foi aceite");
+    return true;
+}
+
+/**
+ * \brief Indica se um snapshot é rejeitado por todos os leitores.
+ */
+static bool Rejeitado(void) {
+    char freq[SNAPSHOT_REGISTOS_POR_BLOCO];
+    int x[SNAPSHOT_REGISTOS_POR_BLOCO], y[SNAPSHOT_REGISTOS_POR_BLOCO];
+    LoteAntenas* lote = CarregarLoteComprimido(FICHEIRO);
+    ArmazemAntenas* a = CarregarArmazemComprimido(FICHEIRO);
+    bool rejeitado = lote == NULL && a == NULL && LerBlocoComprimido(FICHEIRO, 0, freq, x, y) < 0;
+    DestruirLote(lote);
+    DestruirArmazem(a);
+    return rejeitado;
+}
+
+static bool CabecalhoIncoerente(void) {
+    // Magia "ANTZ", registos, registos por bloco, blocos (sem índice nem dados)
+    const uint32_t cabecalhos[][4] = {
+        { 0x5A544E41u, 5000, 256, 0 },           // Registos sem blocos
+        { 0x5A544E41u, 0x80000000u, 256, 8388608 }, // Registos que não cabem num int
+        { 0x5A544E41u, 10, 1000, 1 },            // Mais registos por bloco do que o permitido
+        { 0x5A544E41u, 10, 0, 1 },               // Blocos vazios
+        { 0x5A544E41u, 300, 256, 1 },            // Blocos a menos para os registos
+    };
+    for (size_t k = 0; k < sizeof(cabecalhos) / sizeof(cabecalhos[0]); k++) {
+        FILE* f = fopen(FICHEIRO, "wb");
+        CONFIRMAR(f != NULL, "nao foi possivel criar %s", FICHEIRO);
+        fwrite(cabecalhos[k], sizeof(uint32_t), 4, f);
+        fclose(f);
+        bool rejeitado = Rejeitado();
+        remove(FICHEIRO);
+        CONFIRMAR(rejeitado, "o cabecalho %zu foi aceite", k);
+    }
+
+    // Índice com o primeiro bloco a acabar depois do início do segundo
+    ArmazemAntenas* a = ArmazemAleatorio(5, 4 * SNAPSHOT_REGISTOS_POR_BLOCO, 20);
+    CONFIRMAR(a != NULL && SalvarArmazemComprimido(a, FICHEIRO), "falhou a gravacao");
+    DestruirArmazem(a);
+    FILE* f = fopen(FICHEIRO, "r+b");
+    CONFIRMAR(f != NULL, "snapshot nao encontrado");
+    uint64_t indice[2];
+    fseek(f, 4 * sizeof(uint32_t), SEEK_SET);
+    bool lido = fread(indice, sizeof(uint64_t), 2, f) == 2;
+    indice[0] = indice[1] + 1;
+    fseek(f, 4 * sizeof(uint32_t), SEEK_SET);
+    fwrite(indice, sizeof(uint64_t), 1, f);
+    fclose(f);
+    bool rejeitado = CarregarLoteComprimido(FICHEIRO) == NULL;
+    remove(FICHEIRO);
+    CONFIRMAR(lido && rejeitado, "o indice incoerente foi aceite");
+    return true;
+}
+
+int main(void) {
+    int falhas = 0;
+    CORRER(ArmazemIdaEVolta, falhas);
+    CORRER(ArmazemVazio, falhas);
+    CORRER(BlocosIndividuais, falhas);
+    CORRER(ListaIdaEVolta, falhas);
+    CORRER(SnapshotTruncado, falhas);
+    CORRER(CabecalhoIncoerente, falhas);
+    return falhas == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/*****************************************************************//**
+ * \file   testes.h
+ * \brief  Verificações partilhadas pelos testes de regressão.
+ *
+ * Cada teste da pasta testes é um programa independente: corre os seus
+ * casos, indica no stderr o resultado de cada um (e a primeira verificação
+ * falhada) e termina com 0 se todos passarem ou 1 caso contrário. Os
+ * ficheiros temporários são criados na pasta atual.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#pragma once
+
+#include "../dados.h"
+#include "../funcoes.h"
+
+// Termina o caso atual (uma função bool sem argumentos) se a condição falhar
+#define CONFIRMAR(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "  %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+        return false; \
+    } \
+} while (0)
+
+// Corre um caso e soma as falhas
+#define CORRER(caso, falhas) do { \
+    bool ok_ = caso(); \
+    fprintf(stderr, "%-36s %s\n", #caso, ok_ ? "ok" : "FALHOU"); \
+    (falhas) += !ok_; \
+} while (0)
+
+/**
+ * \brief Preenche um armazém GRID_TAM x GRID_TAM com antenas aleatórias e remove algumas.
+ *
+ * As remoções deixam slots livres, para os testes cobrirem as colunas com buracos.
+ *
+ * \param semente Semente do gerador (rand).
+ * \param n Número de tentativas de inserção.
+ * \param numFreqs Número de frequências distintas (a partir de 'A').
+ * \return Ponteiro para o armazém ou NULL se faltar memória.
+ */
+static inline ArmazemAntenas* ArmazemAleatorio(unsigned semente, int n, int numFreqs) {
+    srand(semente);
+    ArmazemAntenas* a = CriarArmazem(GRID_TAM, GRID_TAM);
+    for (int i = 0; a != NULL && i < n; i++) {
+        InserirAntenaArmazem(a, (char)('A' + rand() % numFreqs), rand() % GRID_TAM, rand() % GRID_TAM);
+    }
+    for (int s = 0; a != NULL && s < a->numSlots; s += 7) {
+        if (a->freq[s] != '\0') RemoverAntenaArmazem(a, s);
+    }
+    return a;
+}
+
+/**
+ * \brief Compara o conteúdo de dois armazéns (mesmas antenas, independentemente dos slots).
+ */
+static inline bool MesmasAntenas(const ArmazemAntenas* a, const ArmazemAntenas* b) {
+    if (a == NULL || b == NULL || a->numAntenas != b->numAntenas) {
+        return false;
+    }
+    for (int s = 0; s < a->numSlots; s++) {
+        if (a->freq[s] == '\0') continue;
+        int t = ProcurarAntenaArmazem(b, a->x[s], a->y[s]);
+        if (t < 0 || b->freq[t] != a->freq[s]) return false;
+    }
+    return true;
+}
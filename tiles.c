@@ -0,0 +1,822 @@
+/*****************************************************************//**
+ * \file   tiles.c
+ * \brief  Armazém em disco dividido em tiles, para grids maiores que a memória.
+ *
+ * O grid é dividido em tiles de lado x lado células, guardados em dois
+ * ficheiros:
+ *
+ *   <nome>.tiles    cabeçalho, tabela dos tiles e, para cada tile, as suas
+ *                   antenas (coordenadas locais) ordenadas por (y, x);
+ *   <nome>.efeitos  um bitmap de lado x lado bits por tile, em posições fixas
+ *                   (ficheiro esparso: os tiles sem efeitos não ocupam disco).
+ *
+ * Os tiles são mapeados em memória à medida que são precisos e mantidos numa
+ * cache LRU de TILES_CACHE mapeamentos, pelo que a memória usada não depende
+ * do tamanho do grid. A criação lê o ficheiro BIN duas vezes (contagem por
+ * tile e colocação), sem carregar as antenas em memória.
+ *
+ * O cálculo dos efeitos é feito por blocos de tiles: para cada par de tiles
+ * com frequências em comum, os efeitos que caem no primeiro tile são marcados
+ * logo no seu bitmap e os restantes são adiados para o tile de destino. Os
+ * efeitos adiados são agrupados por tile e aplicados de uma só vez, mapeando
+ * cada tile de destino uma única vez por grupo.
+ *
+ * Em Windows o ficheiro de efeitos não é esparso e é preenchido com zeros na
+ * criação.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include "dados.h"
+#include "funcoes.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#define TILES_MAGIA 0x53454C54u  // "TLES"
+#define TILES_VERSAO 1
+#define TILES_ALINHAMENTO 65536  // Início das antenas no ficheiro (múltiplo de qualquer página)
+#define TAM_REGISTO_BIN 9        // freq (1 byte) + x (4 bytes) + y (4 bytes)
+#define LOTE_BIN 65536           // Registos BIN lidos de cada vez
+
+#define TILE_ANTENAS 0
+#define TILE_EFEITOS 1
+
+/**
+ * \brief Cabeçalho do ficheiro de tiles.
+ */
+typedef struct CabecalhoTiles {
+    uint32_t magia;
+    uint32_t versao;
+    int32_t largura, altura;
+    int32_t lado;
+    int32_t tilesX, tilesY;
+    uint32_t reservado;
+    uint64_t numAntenas;
+} CabecalhoTiles;
+
+/**
+ * \brief Entrada da tabela dos tiles.
+ */
+typedef struct EntradaTile {
+    uint64_t inicio;      // Primeira antena do tile (índice de registo)
+    uint32_t numAntenas;
+    uint32_t numEfeitos;  // Células com efeito no bitmap do tile
+} EntradaTile;
+
+/**
+ * \brief Antena no ficheiro de tiles (coordenadas locais ao tile).
+ */
+typedef struct RegistoTile {
+    uint16_t x, y;
+    char freq;
+    uint8_t reservado;
+} RegistoTile;
+
+/**
+ * \brief Tile mapeado na cache.
+ */
+typedef struct TileMapeado {
+    int tile;                 // -1 se a entrada está livre
+    int tipo;                 // TILE_ANTENAS ou TILE_EFEITOS
+    void* base;               // Início do mapeamento (alinhado à página)
+    size_t tamBase;
+    void* dados;              // Início dos dados do tile dentro do mapeamento
+    unsigned long long uso;   // Último acesso (relógio da cache)
+} TileMapeado;
+
+/**
+ * \brief Armazém em disco.
+ */
+struct ArmazemTiles {
+    FILE* antenas;
+    FILE* efeitos;
+    CabecalhoTiles cab;
+    EntradaTile* tabela;
+    uint64_t offsetRegistos;  // Posição da primeira antena no ficheiro
+    size_t bytesBitmap;       // Bytes do bitmap de um tile
+    TileMapeado cache[TILES_CACHE];
+    unsigned long long relogio;
+};
+
+/**
+ * \brief Antenas de um tile copiadas e agrupadas por frequência (coordenadas globais).
+ */
+typedef struct GrupoTile {
+    int n, capacidade;
+    int* x;
+    int* y;
+    int* inicioFreq;          // Antenas do id de frequência f em [inicioFreq[f], inicioFreq[f + 1])
+    int* cursor;              // Posição de escrita de cada id (numFreqs + 1 posições, como inicioFreq)
+} GrupoTile;
+
+/**
+ * \brief Efeito à espera de ser aplicado ao seu tile.
+ */
+typedef struct EfeitoAdiado {
+    int tile;
+    uint32_t celula;          // y * lado + x (locais ao tile)
+} EfeitoAdiado;
+
+#pragma region Mapeamento
+/**
+ * \brief Granularidade dos deslocamentos de um mapeamento.
+ */
+static size_t GranularidadeMapeamento(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwAllocationGranularity;
+#else
+    long n = sysconf(_SC_PAGESIZE);
+    return n > 0 ? (size_t)n : 4096;
+#endif
+}
+
+/**
+ * \brief Mapeia [offset, offset + tam) de um ficheiro.
+ *
+ * \param base Devolve o início do mapeamento (a desmapear com Desmapear)
+ * \param tamBase Devolve o tamanho do mapeamento
+ * \return Ponteiro para o byte offset ou NULL em caso de erro.
+ */
+static void* MapearIntervalo(FILE* f, uint64_t offset, size_t tam, bool escrita, void** base, size_t* tamBase) {
+    size_t granularidade = GranularidadeMapeamento();
+    uint64_t inicio = offset - offset % granularidade;
+    size_t total = (size_t)(offset - inicio) + tam;
+#ifdef _WIN32
+    HANDLE h = (HANDLE)_get_osfhandle(_fileno(f));
+    HANDLE m = CreateFileMappingA(h, NULL, escrita ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (m == NULL) {
+        return NULL;
+    }
+    void* p = MapViewOfFile(m, escrita ? FILE_MAP_WRITE : FILE_MAP_READ, (DWORD)(inicio >> 32), (DWORD)inicio, total);
+    CloseHandle(m); // A vista mantém o mapeamento
+    if (p == NULL) {
+        return NULL;
+    }
+#else
+    void* p = mmap(NULL, total, escrita ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fileno(f), (off_t)inicio);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+#endif
+    *base = p;
+    *tamBase = total;
+    return (char*)p + (offset - inicio);
+}
+
+static void Desmapear(void* base, size_t tamBase) {
+#ifdef _WIN32
+    (void)tamBase;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, tamBase);
+#endif
+}
+
+/**
+ * \brief Muda o tamanho de um ficheiro (as partes novas ficam a zeros).
+ */
+static bool DefinirTamanho(FILE* f, uint64_t tam) {
+    fflush(f);
+#ifdef _WIN32
+    return _chsize_s(_fileno(f), (long long)tam) == 0;
+#else
+    return ftruncate(fileno(f), (off_t)tam) == 0;
+#endif
+}
+#pragma endregion
+
+#pragma region Cache
+/**
+ * \brief Tile que contém uma célula.
+ */
+static int TileDe(const ArmazemTiles* t, int x, int y) {
+    return (y / t->cab.lado) * t->cab.tilesX + x / t->cab.lado;
+}
+
+static int NumeroTiles(const ArmazemTiles* t) {
+    return t->cab.tilesX * t->cab.tilesY;
+}
+
+/**
+ * \brief Posição das antenas no ficheiro de tiles.
+ */
+static uint64_t OffsetRegistos(int numTiles) {
+    uint64_t tam = sizeof(CabecalhoTiles) + (uint64_t)numTiles * sizeof(EntradaTile);
+    return (tam + TILES_ALINHAMENTO - 1) / TILES_ALINHAMENTO * TILES_ALINHAMENTO;
+}
+
+static void LibertarEntrada(TileMapeado* e) {
+    if (e->tile >= 0) {
+        Desmapear(e->base, e->tamBase);
+    }
+    e->tile = -1;
+}
+
+/**
+ * \brief Desmapeia todos os tiles de um tipo (ou todos, com tipo -1).
+ */
+static void LimparCache(ArmazemTiles* t, int tipo) {
+    for (int i = 0; i < TILES_CACHE; i++) {
+        if (tipo < 0 || t->cache[i].tipo == tipo) LibertarEntrada(&t->cache[i]);
+    }
+}
+
+/**
+ * \brief Devolve os dados de um tile, mapeando-o se não estiver na cache.
+ *
+ * Pode desmapear o tile usado há mais tempo: ponteiros obtidos antes deixam
+ * de ser válidos. Os tiles de antenas sem antenas não podem ser mapeados.
+ *
+ * \return Antenas (RegistoTile*) ou bitmap (uint64_t*) do tile, ou NULL em caso de erro.
+ */
+static void* ObterTile(ArmazemTiles* t, int tipo, int tile) {
+    TileMapeado* livre = NULL;
+    for (int i = 0; i < TILES_CACHE; i++) {
+        TileMapeado* e = &t->cache[i];
+        if (e->tile == tile && e->tipo == tipo) {
+            e->uso = ++t->relogio;
+            return e->dados;
+        }
+        if (livre == NULL || (livre->tile >= 0 && (e->tile < 0 || e->uso < livre->uso))) livre = e;
+    }
+    ESTAT_SOMAR(tilesMapeados, 1);
+    LibertarEntrada(livre);
+    void* dados;
+    if (tipo == TILE_ANTENAS) {
+        const EntradaTile* et = &t->tabela[tile];
+        if (et->numAntenas == 0) {
+            return NULL;
+        }
+        dados = MapearIntervalo(t->antenas, t->offsetRegistos + et->inicio * sizeof(RegistoTile),
+            et->numAntenas * sizeof(RegistoTile), false, &livre->base, &livre->tamBase);
+    }
+    else {
+        dados = MapearIntervalo(t->efeitos, (uint64_t)tile * t->bytesBitmap, t->bytesBitmap, true, &livre->base, &livre->tamBase);
+    }
+    if (dados == NULL) {
+        return NULL;
+    }
+    livre->tile = tile;
+    livre->tipo = tipo;
+    livre->dados = dados;
+    livre->uso = ++t->relogio;
+    return dados;
+}
+#pragma endregion
+
+#pragma region Criação
+/**
+ * \brief Ordena as antenas de um tile por (y, x) mantendo a ordem das repetidas (merge sort).
+ */
+static void OrdenarRegistos(RegistoTile* r, RegistoTile* aux, uint32_t n) {
+    for (uint32_t largura = 1; largura < n; largura *= 2) {
+        for (uint32_t i = 0; i < n; i += 2 * largura) {
+            uint32_t meio = i + largura < n ? i + largura : n;
+            uint32_t fim = i + 2 * largura < n ? i + 2 * largura : n;
+            uint32_t a = i, b = meio, k = i;
+            while (a < meio && b < fim) {
+                bool segundo = r[b].y < r[a].y || (r[b].y == r[a].y && r[b].x < r[a].x);
+                aux[k++] = segundo ? r[b++] : r[a++];
+            }
+            while (a < meio) aux[k++] = r[a++];
+            while (b < fim) aux[k++] = r[b++];
+        }
+        memcpy(r, aux, (size_t)n * sizeof(RegistoTile));
+    }
+}
+
+/**
+ * \brief Lê um lote de registos BIN válidos (frequência definida e dentro do grid).
+ *
+ * \return Número de registos lidos; 0 no fim do ficheiro.
+ */
+static int LerLoteBin(FILE* f, char* buf, const CabecalhoTiles* cab, char* freq, int* x, int* y) {
+    int n = 0;
+    size_t lidos;
+    while (n == 0 && (lidos = fread(buf, TAM_REGISTO_BIN, LOTE_BIN, f)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            const char* p = buf + i * TAM_REGISTO_BIN;
+            int xi, yi;
+            memcpy(&xi, p + 1, sizeof(int));
+            memcpy(&yi, p + 1 + sizeof(int), sizeof(int));
+            if (p[0] == '\0' || xi < 0 || yi < 0 || xi >= cab->largura || yi >= cab->altura) continue;
+            freq[n] = p[0];
+            x[n] = xi;
+            y[n] = yi;
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ * \brief Grava o cabeçalho e a tabela dos tiles.
+ */
+static bool EscreverTabela(ArmazemTiles* t) {
+    int numTiles = NumeroTiles(t);
+    bool ok = fseek(t->antenas, 0, SEEK_SET) == 0
+        && fwrite(&t->cab, sizeof(CabecalhoTiles), 1, t->antenas) == 1
+        && fwrite(t->tabela, sizeof(EntradaTile), (size_t)numTiles, t->antenas) == (size_t)numTiles;
+    return fflush(t->antenas) == 0 && ok;
+}
+
+/**
+ * \brief Distribui as antenas do ficheiro BIN pelos tiles (segunda passagem).
+ *
+ * As antenas são escritas num mapeamento de toda a zona dos registos; o
+ * sistema operativo escreve as páginas em disco quando precisa de memória.
+ * Depois cada tile é ordenado e as antenas repetidas são descartadas
+ * (fica a primeira do ficheiro BIN, como em InserirAntena).
+ */
+static bool DistribuirAntenas(ArmazemTiles* t, FILE* bin, uint64_t total) {
+    int numTiles = NumeroTiles(t);
+    if (total == 0) {
+        return true;
+    }
+    void* base;
+    size_t tamBase;
+    RegistoTile* registos = (RegistoTile*)MapearIntervalo(t->antenas, t->offsetRegistos, (size_t)total * sizeof(RegistoTile), true, &base, &tamBase);
+    uint64_t* cursor = (uint64_t*)malloc((size_t)numTiles * sizeof(uint64_t));
+    char* buf = (char*)malloc((size_t)LOTE_BIN * TAM_REGISTO_BIN);
+    char* freq = (char*)malloc(LOTE_BIN);
+    int* x = (int*)malloc(LOTE_BIN * sizeof(int));
+    int* y = (int*)malloc(LOTE_BIN * sizeof(int));
+    bool ok = registos != NULL && cursor != NULL && buf != NULL && freq != NULL && x != NULL && y != NULL;
+    if (ok) {
+        for (int k = 0; k < numTiles; k++) cursor[k] = t->tabela[k].inicio;
+        rewind(bin);
+        int n;
+        while ((n = LerLoteBin(bin, buf, &t->cab, freq, x, y)) > 0) {
+            for (int i = 0; i < n; i++) {
+                RegistoTile* r = &registos[cursor[TileDe(t, x[i], y[i])]++];
+                r->x = (uint16_t)(x[i] % t->cab.lado);
+                r->y = (uint16_t)(y[i] % t->cab.lado);
+                r->freq = freq[i];
+                r->reservado = 0;
+            }
+        }
+    }
+    // Ordena cada tile e remove as repetidas
+    RegistoTile* aux = NULL;
+    uint32_t capacidadeAux = 0;
+    t->cab.numAntenas = 0;
+    for (int k = 0; ok && k < numTiles; k++) {
+        EntradaTile* et = &t->tabela[k];
+        uint32_t n = et->numAntenas;
+        if (n == 0) continue;
+        if (n > capacidadeAux) {
+            free(aux);
+            aux = (RegistoTile*)malloc((size_t)n * sizeof(RegistoTile));
+            capacidadeAux = n;
+            ok = aux != NULL;
+            if (!ok) break;
+        }
+        RegistoTile* r = registos + et->inicio;
+        OrdenarRegistos(r, aux, n);
+        uint32_t m = 1;
+        for (uint32_t i = 1; i < n; i++) {
+            if (r[i].x != r[m - 1].x || r[i].y != r[m - 1].y) r[m++] = r[i];
+        }
+        et->numAntenas = m;
+        t->cab.numAntenas += m;
+    }
+    if (registos != NULL) Desmapear(base, tamBase);
+    free(aux);
+    free(cursor);
+    free(buf);
+    free(freq);
+    free(x);
+    free(y);
+    return ok;
+}
+
+/**
+ * \brief Cria o armazém em disco a partir de um ficheiro BIN (freq, x, y).
+ *
+ * As antenas fora do grid são ignoradas. Os ficheiros <nomeBase>.tiles e
+ * <nomeBase>.efeitos são substituídos; os efeitos ficam vazios até
+ * CalcularEfeitosTiles.
+ *
+ * \param lado Lado dos tiles (potência de 2 entre 256 e 32768; 0 = TILES_LADO)
+ * \return Armazém aberto ou NULL em caso de erro.
+ */
+ArmazemTiles* CriarArmazemTiles(const char* nomeBase, const char* ficheiroBin, int largura, int altura, int lado) {
+    if (lado == 0) lado = TILES_LADO;
+    if (largura <= 0 || altura <= 0 || lado < 256 || lado > 32768 || (lado & (lado - 1)) != 0) {
+        return NULL;
+    }
+    char nome[512];
+    if (snprintf(nome, sizeof(nome), "%s.tiles", nomeBase) >= (int)sizeof(nome)) {
+        return NULL;
+    }
+    FILE* bin = fopen(ficheiroBin, "rb");
+    if (bin == NULL) {
+        return NULL;
+    }
+    ArmazemTiles* t = (ArmazemTiles*)calloc(1, sizeof(ArmazemTiles));
+    if (t == NULL) {
+        fclose(bin);
+        return NULL;
+    }
+    for (int i = 0; i < TILES_CACHE; i++) t->cache[i].tile = -1;
+    t->cab.magia = TILES_MAGIA;
+    t->cab.versao = TILES_VERSAO;
+    t->cab.largura = largura;
+    t->cab.altura = altura;
+    t->cab.lado = lado;
+    t->cab.tilesX = (largura + lado - 1) / lado;
+    t->cab.tilesY = (altura + lado - 1) / lado;
+    int numTiles = NumeroTiles(t);
+    t->tabela = (EntradaTile*)calloc((size_t)numTiles, sizeof(EntradaTile));
+    char* buf = (char*)malloc((size_t)LOTE_BIN * TAM_REGISTO_BIN);
+    char* freq = (char*)malloc(LOTE_BIN);
+    int* x = (int*)malloc(LOTE_BIN * sizeof(int));
+    int* y = (int*)malloc(LOTE_BIN * sizeof(int));
+    bool ok = t->tabela != NULL && buf != NULL && freq != NULL && x != NULL && y != NULL;
+
+    // Primeira passagem: antenas por tile
+    int n;
+    while (ok && (n = LerLoteBin(bin, buf, &t->cab, freq, x, y)) > 0) {
+        for (int i = 0; i < n; i++) t->tabela[TileDe(t, x[i], y[i])].numAntenas++;
+    }
+    free(buf);
+    free(freq);
+    free(x);
+    free(y);
+    uint64_t total = 0;
+    for (int k = 0; ok && k < numTiles; k++) {
+        t->tabela[k].inicio = total;
+        total += t->tabela[k].numAntenas;
+    }
+
+    // Segunda passagem: antenas nas posições dos seus tiles
+    t->offsetRegistos = OffsetRegistos(numTiles);
+    t->antenas = ok ? fopen(nome, "w+b") : NULL;
+    ok = t->antenas != NULL
+        && DefinirTamanho(t->antenas, t->offsetRegistos + total * sizeof(RegistoTile))
+        && DistribuirAntenas(t, bin, total)
+        && EscreverTabela(t);
+    fclose(bin);
+    if (t->antenas != NULL) fclose(t->antenas);
+    free(t->tabela);
+    free(t);
+    if (!ok) {
+        remove(nome);
+        return NULL;
+    }
+
+    // Efeitos vazios: o ficheiro é truncado
+    snprintf(nome, sizeof(nome), "%s.efeitos", nomeBase);
+    FILE* efeitos = fopen(nome, "wb");
+    if (efeitos == NULL) {
+        return NULL;
+    }
+    fclose(efeitos);
+    return AbrirArmazemTiles(nomeBase);
+}
+
+/**
+ * \brief Abre um armazém em disco criado por CriarArmazemTiles.
+ *
+ * \return Armazém ou NULL se os ficheiros não existirem ou forem inválidos.
+ */
+ArmazemTiles* AbrirArmazemTiles(const char* nomeBase) {
+    char nome[512];
+    if (snprintf(nome, sizeof(nome), "%s.tiles", nomeBase) >= (int)sizeof(nome)) {
+        return NULL;
+    }
+    ArmazemTiles* t = (ArmazemTiles*)calloc(1, sizeof(ArmazemTiles));
+    if (t == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < TILES_CACHE; i++) t->cache[i].tile = -1;
+    t->antenas = fopen(nome, "r+b");
+    bool ok = t->antenas != NULL
+        && fread(&t->cab, sizeof(CabecalhoTiles), 1, t->antenas) == 1
+        && t->cab.magia == TILES_MAGIA && t->cab.versao == TILES_VERSAO
+        && t->cab.lado >= 256 && t->cab.lado <= 32768
+        && t->cab.tilesX > 0 && t->cab.tilesY > 0;
+    int numTiles = ok ? NumeroTiles(t) : 0;
+    if (ok) {
+        t->tabela = (EntradaTile*)malloc((size_t)numTiles * sizeof(EntradaTile));
+        ok = t->tabela != NULL && fread(t->tabela, sizeof(EntradaTile), (size_t)numTiles, t->antenas) == (size_t)numTiles;
+    }
+    if (ok) {
+        t->offsetRegistos = OffsetRegistos(numTiles);
+        t->bytesBitmap = (size_t)t->cab.lado * t->cab.lado / 8;
+        snprintf(nome, sizeof(nome), "%s.efeitos", nomeBase);
+        t->efeitos = fopen(nome, "r+b");
+        if (t->efeitos == NULL) t->efeitos = fopen(nome, "w+b");
+        ok = t->efeitos != NULL && DefinirTamanho(t->efeitos, (uint64_t)numTiles * t->bytesBitmap);
+    }
+    if (!ok) {
+        if (t->antenas != NULL) fclose(t->antenas);
+        if (t->efeitos != NULL) fclose(t->efeitos);
+        free(t->tabela);
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+/**
+ * \brief Fecha o armazém em disco, gravando a tabela dos tiles.
+ */
+bool FecharArmazemTiles(ArmazemTiles* t) {
+    if (t == NULL) {
+        return false;
+    }
+    LimparCache(t, -1);
+    bool ok = EscreverTabela(t);
+    ok = fclose(t->antenas) == 0 && ok;
+    ok = fclose(t->efeitos) == 0 && ok;
+    free(t->tabela);
+    free(t);
+    return ok;
+}
+#pragma endregion
+
+#pragma region Consultas
+long long NumeroAntenasTiles(const ArmazemTiles* t) {
+    return t != NULL ? (long long)t->cab.numAntenas : 0;
+}
+
+/**
+ * \brief Número de células com efeito (último CalcularEfeitosTiles).
+ */
+long long ContarEfeitosTiles(const ArmazemTiles* t) {
+    if (t == NULL) {
+        return 0;
+    }
+    long long total = 0;
+    for (int k = 0; k < NumeroTiles(t); k++) total += t->tabela[k].numEfeitos;
+    return total;
+}
+
+/**
+ * \brief Procura a antena de uma célula (pesquisa binária no tile).
+ *
+ * \return Frequência da antena ou '\0' se não existir.
+ */
+char ProcurarAntenaTiles(ArmazemTiles* t, int x, int y) {
+    if (t == NULL || x < 0 || y < 0 || x >= t->cab.largura || y >= t->cab.altura) {
+        return '\0';
+    }
+    int tile = TileDe(t, x, y);
+    if (t->tabela[tile].numAntenas == 0) {
+        return '\0';
+    }
+    const RegistoTile* r = (const RegistoTile*)ObterTile(t, TILE_ANTENAS, tile);
+    if (r == NULL) {
+        return '\0';
+    }
+    uint32_t chave = (uint32_t)(y % t->cab.lado) << 16 | (uint32_t)(x % t->cab.lado);
+    uint32_t lo = 0, hi = t->tabela[tile].numAntenas;
+    while (lo < hi) {
+        uint32_t meio = lo + (hi - lo) / 2;
+        uint32_t c = (uint32_t)r[meio].y << 16 | r[meio].x;
+        if (c == chave) return r[meio].freq;
+        if (c < chave) lo = meio + 1;
+        else hi = meio;
+    }
+    return '\0';
+}
+
+/**
+ * \brief Indica se uma célula tem efeito nefasto (último CalcularEfeitosTiles).
+ */
+bool CelulaComEfeitoTiles(ArmazemTiles* t, int x, int y) {
+    if (t == NULL || x < 0 || y < 0 || x >= t->cab.largura || y >= t->cab.altura) {
+        return false;
+    }
+    int tile = TileDe(t, x, y);
+    if (t->tabela[tile].numEfeitos == 0) {
+        return false; // Não mapeia tiles sem efeitos
+    }
+    const uint64_t* bits = (const uint64_t*)ObterTile(t, TILE_EFEITOS, tile);
+    if (bits == NULL) {
+        return false;
+    }
+    uint32_t c = (uint32_t)(y % t->cab.lado) * (uint32_t)t->cab.lado + (uint32_t)(x % t->cab.lado);
+    return (bits[c >> 6] >> (c & 63)) & 1;
+}
+#pragma endregion
+
+#pragma region Efeitos
+/**
+ * \brief Copia as antenas de um tile, agrupadas pelo id da frequência.
+ */
+static bool CarregarGrupo(ArmazemTiles* t, int tile, const TabelaFrequencias* ids, GrupoTile* g) {
+    uint32_t n = t->tabela[tile].numAntenas;
+    const RegistoTile* r = (const RegistoTile*)ObterTile(t, TILE_ANTENAS, tile);
+    if (r == NULL) {
+        return false;
+    }
+    if ((int)n > g->capacidade) {
+        int* nx = (int*)realloc(g->x, (size_t)n * sizeof(int));
+        if (nx == NULL) return false;
+        g->x = nx;
+        int* ny = (int*)realloc(g->y, (size_t)n * sizeof(int));
+        if (ny == NULL) return false;
+        g->y = ny;
+        g->capacidade = (int)n;
+    }
+    int x0 = (tile % t->cab.tilesX) * t->cab.lado;
+    int y0 = (tile / t->cab.tilesX) * t->cab.lado;
+    memset(g->inicioFreq, 0, ((size_t)ids->numFreqs + 1) * sizeof(int));
+    for (uint32_t i = 0; i < n; i++) g->inicioFreq[ids->idDaFreq[(unsigned char)r[i].freq]]++; // Id + 1
+    for (int f = 0; f < ids->numFreqs; f++) g->inicioFreq[f + 1] += g->inicioFreq[f];
+    memcpy(g->cursor, g->inicioFreq, ((size_t)ids->numFreqs + 1) * sizeof(int));
+    for (uint32_t i = 0; i < n; i++) {
+        int k = g->cursor[ids->idDaFreq[(unsigned char)r[i].freq] - 1]++;
+        g->x[k] = x0 + r[i].x;
+        g->y[k] = y0 + r[i].y;
+    }
+    g->n = (int)n;
+    return true;
+}
+
+/**
+ * \brief Marca um bit num bitmap de tile.
+ *
+ * \return true se a célula ainda não tinha efeito.
+ */
+static bool MarcarBit(uint64_t* bits, uint32_t c) {
+    uint64_t m = 1ull << (c & 63);
+    if (bits[c >> 6] & m) {
+        return false;
+    }
+    bits[c >> 6] |= m;
+    return true;
+}
+
+/**
+ * \brief Aplica os efeitos adiados, agrupados por tile de destino.
+ */
+static bool AplicarAdiados(ArmazemTiles* t, EfeitoAdiado* adiados, EfeitoAdiado* aux, int n, int* contagem) {
+    int numTiles = NumeroTiles(t);
+    memset(contagem, 0, ((size_t)numTiles + 1) * sizeof(int));
+    for (int i = 0; i < n; i++) contagem[adiados[i].tile + 1]++;
+    for (int k = 0; k < numTiles; k++) contagem[k + 1] += contagem[k];
+    for (int i = 0; i < n; i++) aux[contagem[adiados[i].tile]++] = adiados[i];
+    for (int i = 0; i < n; ) {
+        int tile = aux[i].tile;
+        uint64_t* bits = (uint64_t*)ObterTile(t, TILE_EFEITOS, tile);
+        if (bits == NULL) {
+            return false;
+        }
+        for (; i < n && aux[i].tile == tile; i++) {
+            if (MarcarBit(bits, aux[i].celula)) t->tabela[tile].numEfeitos++;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Máscara das frequências presentes num tile (um bit por id, internando as novas).
+ */
+static bool MascaraFrequencias(ArmazemTiles* t, int tile, TabelaFrequencias* ids, uint64_t* mascara) {
+    const RegistoTile* r = (const RegistoTile*)ObterTile(t, TILE_ANTENAS, tile);
+    if (r == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < t->tabela[tile].numAntenas; i++) {
+        int f = InternarFrequenciaTabela(ids, r[i].freq);
+        mascara[f >> 6] |= 1ull << (f & 63);
+    }
+    return true;
+}
+
+/**
+ * \brief Calcula os efeitos nefastos (EFEITOS_PONTOS) de todas as antenas, por blocos de tiles.
+ *
+ * Os pares são percorridos tile a tile: para o tile atual i e cada tile j >= i
+ * com frequências em comum, os efeitos que caem em i são marcados no seu
+ * bitmap e os outros são adiados (até TILES_ADIADOS) e aplicados agrupados
+ * pelo tile de destino.
+ *
+ * \return Número de células com efeito ou -1 em caso de erro.
+ */
+long long CalcularEfeitosTiles(ArmazemTiles* t) {
+    if (t == NULL) {
+        return -1;
+    }
+    ESTAT_SOMAR(operacoes, 1);
+    ESTAT_INICIO(inicio);
+    int numTiles = NumeroTiles(t);
+    // Recria o ficheiro de efeitos vazio (esparso)
+    LimparCache(t, TILE_EFEITOS);
+    if (!DefinirTamanho(t->efeitos, 0) || !DefinirTamanho(t->efeitos, (uint64_t)numTiles * t->bytesBitmap)) {
+        return -1;
+    }
+    for (int k = 0; k < numTiles; k++) t->tabela[k].numEfeitos = 0;
+
+    int numOcupados = 0;
+    for (int k = 0; k < numTiles; k++) numOcupados += t->tabela[k].numAntenas > 0;
+    int* ocupados = (int*)malloc(((size_t)numOcupados + 1) * sizeof(int));
+    uint64_t* mascaras = (uint64_t*)calloc(((size_t)numOcupados + 1) * 4, sizeof(uint64_t)); // 4 palavras chegam para FREQ_IDS
+    int* contagem = (int*)malloc(((size_t)numTiles + 1) * sizeof(int));
+    EfeitoAdiado* adiados = (EfeitoAdiado*)malloc(TILES_ADIADOS * sizeof(EfeitoAdiado));
+    EfeitoAdiado* aux = (EfeitoAdiado*)malloc(TILES_ADIADOS * sizeof(EfeitoAdiado));
+    GrupoTile a = { 0 }, b = { 0 };
+    TabelaFrequencias ids = { { 0 }, 0 };
+    bool ok = ocupados != NULL && mascaras != NULL && contagem != NULL && adiados != NULL && aux != NULL;
+    for (int k = 0, i = 0; ok && k < numTiles; k++) {
+        if (t->tabela[k].numAntenas == 0) continue;
+        ocupados[i] = k;
+        ok = MascaraFrequencias(t, k, &ids, &mascaras[4 * i]);
+        i++;
+    }
+    // Um balde por frequência presente nos tiles
+    size_t tamBaldes = ((size_t)ids.numFreqs + 1) * sizeof(int);
+    a.inicioFreq = (int*)malloc(tamBaldes);
+    a.cursor = (int*)malloc(tamBaldes);
+    b.inicioFreq = (int*)malloc(tamBaldes);
+    b.cursor = (int*)malloc(tamBaldes);
+    ok = ok && a.inicioFreq != NULL && a.cursor != NULL && b.inicioFreq != NULL && b.cursor != NULL;
+    int palavras = (ids.numFreqs + 63) / 64; // Palavras das máscaras em uso
+
+    int numAdiados = 0;
+    long long lado = t->cab.lado;
+    for (int i = 0; ok && i < numOcupados; i++) {
+        int tileA = ocupados[i];
+        ok = CarregarGrupo(t, tileA, &ids, &a);
+        for (int j = i; ok && j < numOcupados; j++) {
+            const uint64_t* ma = &mascaras[4 * i];
+            const uint64_t* mb = &mascaras[4 * j];
+            uint64_t comum = 0;
+            for (int w = 0; w < palavras; w++) comum |= ma[w] & mb[w];
+            if (comum == 0) continue;
+            const GrupoTile* g = &a;
+            if (j != i) {
+                ok = CarregarGrupo(t, ocupados[j], &ids, &b);
+                g = &b;
+            }
+            uint64_t* bitsA = ok ? (uint64_t*)ObterTile(t, TILE_EFEITOS, tileA) : NULL;
+            ok = bitsA != NULL;
+            for (int f = 0; ok && f < ids.numFreqs; f++) {
+                if (!((ma[f >> 6] & mb[f >> 6]) >> (f & 63) & 1)) continue;
+                for (int p = a.inicioFreq[f]; ok && p < a.inicioFreq[f + 1]; p++) {
+                    int q0 = j == i ? p + 1 : g->inicioFreq[f];
+                    for (int q = q0; ok && q < g->inicioFreq[f + 1]; q++) {
+                        // Os dois efeitos do par: 2a - b e 2b - a
+                        long long ex[2] = { 2LL * a.x[p] - g->x[q], 2LL * g->x[q] - a.x[p] };
+                        long long ey[2] = { 2LL * a.y[p] - g->y[q], 2LL * g->y[q] - a.y[p] };
+                        for (int e = 0; e < 2; e++) {
+                            if (ex[e] < 0 || ey[e] < 0 || ex[e] >= t->cab.largura || ey[e] >= t->cab.altura) continue;
+                            int tile = TileDe(t, (int)ex[e], (int)ey[e]);
+                            uint32_t celula = (uint32_t)((ey[e] % lado) * lado + ex[e] % lado);
+                            if (tile == tileA) {
+                                if (MarcarBit(bitsA, celula)) t->tabela[tileA].numEfeitos++;
+                                continue;
+                            }
+                            adiados[numAdiados++] = (EfeitoAdiado){ tile, celula };
+                            if (numAdiados == TILES_ADIADOS) {
+                                ESTAT_SOMAR(efeitosAdiados, numAdiados);
+                                ok = AplicarAdiados(t, adiados, aux, numAdiados, contagem);
+                                numAdiados = 0;
+                                // A aplicação pode ter desmapeado o bitmap do tile atual
+                                bitsA = ok ? (uint64_t*)ObterTile(t, TILE_EFEITOS, tileA) : NULL;
+                                ok = bitsA != NULL;
+                                if (!ok) break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (ok && numAdiados > 0) {
+        ESTAT_SOMAR(efeitosAdiados, numAdiados);
+        ok = AplicarAdiados(t, adiados, aux, numAdiados, contagem);
+    }
+    free(ocupados);
+    free(mascaras);
+    free(contagem);
+    free(adiados);
+    free(aux);
+    free(a.x);
+    free(a.y);
+    free(b.x);
+    free(b.y);
+    free(a.inicioFreq);
+    free(a.cursor);
+    free(b.inicioFreq);
+    free(b.cursor);
+    ok = ok && EscreverTabela(t);
+    ESTAT_FIM(nsEfeitos, inicio);
+    return ok ? ContarEfeitosTiles(t) : -1;
+}
+#pragma endregion
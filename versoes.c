@@ -0,0 +1,253 @@
+/*****************************************************************//**
+ * \file   versoes.c
+ * \brief  Versões imutáveis do armazém para leitores concorrentes (estilo RCU).
+ *
+ * O escritor continua a alterar o armazém e o grafo com as funções de sempre
+ * e, quando quer tornar as alterações visíveis, publica uma versão: uma cópia
+ * das colunas e das adjacências que nunca mais é alterada. A versão atual é
+ * trocada com uma única operação atómica, pelo que os leitores veem sempre
+ * uma versão completa, sem locks.
+ *
+ * As versões substituídas são recolhidas por épocas: cada leitor anuncia a
+ * época global quando começa uma leitura e uma versão retirada na época r só
+ * é libertada quando todos os leitores ativos anunciaram uma época > r (isto
+ * é, começaram depois da troca e já não a podem ter).
+ *
+ * Todas as operações atómicas são sequencialmente consistentes. As
+ * estatísticas (ESTATISTICAS) não são atómicas e não devem ser ativadas em
+ * programas com leitores concorrentes.
+ *
+ * \author matos
+ * \date   March 2025
+ *********************************************************************/
+
+#include "dados.h"
+#include "funcoes.h"
+#include <stdatomic.h>
+#include <threads.h>
+
+/**
+ * \brief Publicador de versões partilhado pelo escritor e pelos leitores.
+ */
+struct PublicadorVersoes {
+    _Atomic(VersaoArmazem*) atual;
+    atomic_ullong epocaGlobal;                       // Começa em 1 (0 indica leitor inativo)
+    atomic_ullong epocaLeitor[VERSOES_MAX_LEITORES]; // Época anunciada por cada leitor durante uma leitura
+    atomic_bool ocupado[VERSOES_MAX_LEITORES];       // Posições de leitor atribuídas
+    mtx_t escrita;                                   // Serializa as publicações e a recolha
+    VersaoArmazem* retiradas;                        // Versões substituídas ainda não libertadas
+    unsigned long long numVersoes;
+};
+
+#pragma region Versões
+/**
+ * \brief Cria uma versão com cópias do armazém e (opcionalmente) do grafo.
+ */
+static VersaoArmazem* CriarVersao(const ArmazemAntenas* a, const GR* g) {
+    VersaoArmazem* v = (VersaoArmazem*)calloc(1, sizeof(VersaoArmazem));
+    if (v == NULL) {
+        return NULL;
+    }
+    v->armazem = CopiarArmazem(a);
+    if (v->armazem == NULL) {
+        free(v);
+        return NULL;
+    }
+    if (g != NULL) {
+        v->grafo = CopiarGrafoArmazem(g, v->armazem);
+        if (v->grafo == NULL) {
+            DestruirArmazem(v->armazem);
+            free(v);
+            return NULL;
+        }
+    }
+    return v;
+}
+
+static void DestruirVersao(VersaoArmazem* v) {
+    DestruirGrafo(v->grafo);
+    DestruirArmazem(v->armazem);
+    free(v);
+}
+
+/**
+ * \brief Liberta as versões retiradas que já não podem ter leitores (com o lock de escrita).
+ *
+ * \return Número de versões libertadas.
+ */
+static int RecolherRetiradas(PublicadorVersoes* p) {
+    unsigned long long minima = ~0ull;
+    for (int i = 0; i < VERSOES_MAX_LEITORES; i++) {
+        unsigned long long e = atomic_load(&p->epocaLeitor[i]);
+        if (e != 0 && e < minima) minima = e;
+    }
+    int libertadas = 0;
+    VersaoArmazem** ant = &p->retiradas;
+    while (*ant != NULL) {
+        VersaoArmazem* v = *ant;
+        if (v->epocaRetirada < minima) {
+            *ant = v->proxRetirada;
+            DestruirVersao(v);
+            libertadas++;
+        }
+        else {
+            ant = &v->proxRetirada;
+        }
+    }
+    return libertadas;
+}
+
+/**
+ * \brief Cria um publicador sem versão atual.
+ *
+ * \return Ponteiro para o publicador ou NULL se faltar memória.
+ */
+PublicadorVersoes* CriarPublicadorVersoes() {
+    PublicadorVersoes* p = (PublicadorVersoes*)malloc(sizeof(PublicadorVersoes));
+    if (p == NULL) {
+        return NULL;
+    }
+    if (mtx_init(&p->escrita, mtx_plain) != thrd_success) {
+        free(p);
+        return NULL;
+    }
+    atomic_init(&p->atual, NULL);
+    atomic_init(&p->epocaGlobal, 1);
+    for (int i = 0; i < VERSOES_MAX_LEITORES; i++) {
+        atomic_init(&p->epocaLeitor[i], 0);
+        atomic_init(&p->ocupado[i], false);
+    }
+    p->retiradas = NULL;
+    p->numVersoes = 0;
+    return p;
+}
+
+/**
+ * \brief Publica o estado atual do armazém (e do grafo) como nova versão.
+ *
+ * A cópia é feita antes de tomar o lock, pelo que o armazém e o grafo não
+ * podem estar a ser alterados durante a chamada (o escritor publica entre
+ * alterações). Várias alterações podem ser publicadas de uma só vez.
+ *
+ * \param p Ponteiro para o publicador.
+ * \param a Armazém a publicar.
+ * \param g Grafo sobre o armazém (NULL para publicar só o armazém).
+ * \return true se a versão foi publicada, false se faltar memória.
+ */
+bool PublicarVersao(PublicadorVersoes* p, const ArmazemAntenas* a, const GR* g) {
+    if (p == NULL || a == NULL || (g != NULL && g->armazem != a)) {
+        return false;
+    }
+    VersaoArmazem* v = CriarVersao(a, g);
+    if (v == NULL) {
+        return false;
+    }
+    mtx_lock(&p->escrita);
+    v->numero = ++p->numVersoes;
+    VersaoArmazem* antiga = atomic_exchange(&p->atual, v);
+    if (antiga != NULL) {
+        // Leitores que ainda vejam a versão antiga anunciaram uma época <= epocaRetirada
+        antiga->epocaRetirada = atomic_fetch_add(&p->epocaGlobal, 1);
+        antiga->proxRetirada = p->retiradas;
+        p->retiradas = antiga;
+    }
+    RecolherRetiradas(p);
+    mtx_unlock(&p->escrita);
+    return true;
+}
+
+/**
+ * \brief Atribui uma posição de leitor à thread que a pede.
+ *
+ * \return Posição do leitor (0 .. VERSOES_MAX_LEITORES - 1) ou -1 se estiverem todas ocupadas.
+ */
+int RegistarLeitor(PublicadorVersoes* p) {
+    for (int i = 0; i < VERSOES_MAX_LEITORES; i++) {
+        bool esperado = false;
+        if (atomic_compare_exchange_strong(&p->ocupado[i], &esperado, true)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief Liberta a posição de um leitor (que não pode estar a meio de uma leitura).
+ */
+void RemoverLeitor(PublicadorVersoes* p, int leitor) {
+    if (leitor < 0 || leitor >= VERSOES_MAX_LEITORES) {
+        return;
+    }
+    atomic_store(&p->epocaLeitor[leitor], 0);
+    atomic_store(&p->ocupado[leitor], false);
+}
+
+/**
+ * \brief Começa uma leitura e devolve a versão atual.
+ *
+ * A versão não é alterada nem libertada até TerminarLeitura. As leituras de
+ * um mesmo leitor não podem ser encaixadas umas nas outras.
+ *
+ * \param p Ponteiro para o publicador.
+ * \param leitor Posição obtida com RegistarLeitor.
+ * \return Versão atual ou NULL se ainda não foi publicada nenhuma.
+ */
+const VersaoArmazem* IniciarLeitura(PublicadorVersoes* p, int leitor) {
+    if (leitor < 0 || leitor >= VERSOES_MAX_LEITORES) {
+        return NULL;
+    }
+    atomic_store(&p->epocaLeitor[leitor], atomic_load(&p->epocaGlobal));
+    return atomic_load(&p->atual);
+}
+
+/**
+ * \brief Termina a leitura: a versão obtida deixa de poder ser usada.
+ */
+void TerminarLeitura(PublicadorVersoes* p, int leitor) {
+    if (leitor < 0 || leitor >= VERSOES_MAX_LEITORES) {
+        return;
+    }
+    atomic_store(&p->epocaLeitor[leitor], 0);
+}
+
+/**
+ * \brief Liberta as versões retiradas que já não têm leitores.
+ *
+ * As publicações já fazem esta recolha; esta função serve para libertar
+ * memória quando o escritor fica parado enquanto as leituras terminam.
+ *
+ * \return Número de versões libertadas.
+ */
+int RecolherVersoes(PublicadorVersoes* p) {
+    if (p == NULL) {
+        return 0;
+    }
+    mtx_lock(&p->escrita);
+    int libertadas = RecolherRetiradas(p);
+    mtx_unlock(&p->escrita);
+    return libertadas;
+}
+
+/**
+ * \brief Destrói o publicador e todas as versões (não pode haver leituras a decorrer).
+ *
+ * \return true se o publicador foi destruído, false se era NULL.
+ */
+bool DestruirPublicadorVersoes(PublicadorVersoes* p) {
+    if (p == NULL) {
+        return false;
+    }
+    VersaoArmazem* v = atomic_load(&p->atual);
+    if (v != NULL) {
+        DestruirVersao(v);
+    }
+    while (p->retiradas != NULL) {
+        VersaoArmazem* prox = p->retiradas->proxRetirada;
+        DestruirVersao(p->retiradas);
+        p->retiradas = prox;
+    }
+    mtx_destroy(&p->escrita);
+    free(p);
+    return true;
+}
+#pragma endregion